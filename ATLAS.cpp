@@ -0,0 +1,165 @@
+#include "ATLAS.h"
+#include "CRITICAL_ORBIT.h"
+#include "JULIA_RENDERER.h"
+#include "TYPED_FIELD_2D.h"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+// iterateRoots, but a point whose orbit comes back to where it was a
+// power of two iterations ago has settled onto an attracting cycle and
+// is counted as inside right away, instead of after all maxIterations.
+// A cycle that runs through zero gets captured the way iterateRoots
+// would, so the cycle is followed once around to make sure it doesn't.
+///////////////////////////////////////////////////////////////////////
+static bool probeInside(const VEC3F& center, const vector<VEC3F>& roots, int maxIterations, float escapeRadius)
+{
+  const int totalRoots = roots.size();
+  VEC3F iterate = center;
+  VEC3F reference = center;
+  int nextReference = 1;
+
+  float magnitude = iterate.magnitude();
+  for (int totalIterations = 0; totalIterations < maxIterations; totalIterations++)
+  {
+    if (magnitude >= escapeRadius)
+      return false;
+
+    VEC3F g = VEC3F(1.0, 0.0, 0.0);
+    for (int x = 0; x < totalRoots; x++)
+      g = complexMultiply(g, iterate - roots[x]);
+    iterate = g;
+
+    magnitude = iterate.magnitude();
+    if (magnitude > escapeRadius || magnitude < 1e-7)
+      return false;
+
+    const VEC3F difference = iterate - reference;
+    if (difference[0] * difference[0] + difference[1] * difference[1] < 1e-10)
+    {
+      // once around the cycle, looking for zero
+      const int period = totalIterations + 1 - (nextReference >> 1);
+      VEC3F cycle = iterate;
+      for (int step = 0; step < period; step++)
+      {
+        VEC3F h = VEC3F(1.0, 0.0, 0.0);
+        for (int x = 0; x < totalRoots; x++)
+          h = complexMultiply(h, cycle - roots[x]);
+        cycle = h;
+        if (cycle.magnitude() < 1e-3)
+          return iterateRoots(center, roots, maxIterations, escapeRadius) == maxIterations;
+      }
+      return true;
+    }
+
+    if (totalIterations + 1 == nextReference)
+    {
+      reference = iterate;
+      nextReference <<= 1;
+    }
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// the fraction of a probeRes x probeRes grid over renderImage's window
+// that doesn't escape, times the window's area
+///////////////////////////////////////////////////////////////////////
+static float probeArea(const vector<VEC3F>& roots, const ATLAS_SETTINGS& settings)
+{
+  const float windowSize = 4.0;
+  const float dx = windowSize / settings.probeRes;
+
+  int inside = 0;
+  for (int y = 0; y < settings.probeRes; y++)
+    for (int x = 0; x < settings.probeRes; x++)
+    {
+      const VEC3F center(-2.0 + (x + 0.5) * dx, -2.0 + (y + 0.5) * dx, 0.0);
+      if (probeInside(center, roots, settings.maxIterations, settings.escapeRadius))
+        inside++;
+    }
+  return inside * dx * dx;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Cantor dust pixels are cheap and the rest aren't, so rows are handed out
+// one at a time instead of in fixed bands.
+//
+// Conjugating both roots reflects the shape across the x axis without
+// changing its area or connectivity, so with the pinned root on that
+// axis and the atlas centered on it, only the bottom half and the axis
+// are computed and the top half is copied across. Row y sits at
+// yMin + y * dy, so row yRes - y is its reflection.
+///////////////////////////////////////////////////////////////////////
+void buildAtlas(const ATLAS_SETTINGS& settings, FIELD_2D& area, FIELD_2D& connectivity)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  if (area.xRes() != xRes || area.yRes() != yRes)
+    area.resizeAndWipe(xRes, yRes);
+  if (connectivity.xRes() != xRes || connectivity.yRes() != yRes)
+    connectivity.resizeAndWipe(xRes, yRes);
+
+  const float dx = settings.size / xRes;
+  const float dy = settings.size / yRes;
+
+  const bool mirrored = (settings.pinnedRoot[1] == 0.0) && (settings.yMin == -0.5f * settings.size) && (yRes % 2 == 0);
+  const int totalRows = mirrored ? yRes / 2 + 1 : yRes;
+
+  atomic<int> nextRow(0);
+  auto work = [&]()
+  {
+    vector<VEC3F> roots(2);
+    roots[0] = settings.pinnedRoot;
+    for (int y = nextRow++; y < totalRows; y = nextRow++)
+      for (int x = 0; x < xRes; x++)
+      {
+        roots[1] = VEC3F(settings.xMin + x * dx, settings.yMin + y * dy, 0.0);
+        const SHAPE_PREDICTION prediction = predictShape(roots, settings.maxIterations, settings.escapeRadius);
+        connectivity(x, y) = prediction;
+        area(x, y) = (prediction == SHAPE_CANTOR_DUST) ? 0.0f : probeArea(roots, settings);
+      }
+  };
+
+  int totalThreads = settings.totalThreads;
+  if (totalThreads <= 0)
+    totalThreads = thread::hardware_concurrency();
+  if (totalThreads <= 0)
+    totalThreads = 1;
+
+  vector<thread> threads;
+  for (int x = 1; x < totalThreads; x++)
+    threads.push_back(thread(work));
+  work();
+  for (unsigned int x = 0; x < threads.size(); x++)
+    threads[x].join();
+
+  for (int y = totalRows; y < yRes; y++)
+    for (int x = 0; x < xRes; x++)
+    {
+      area(x, y) = area(x, yRes - y);
+      connectivity(x, y) = connectivity(x, yRes - y);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool writeAtlas(const string& name, const FIELD_2D& area, const FIELD_2D& connectivity)
+{
+  bool success = area.write(name + ".area.fld");
+  success = connectivity.write(name + ".connectivity.fld") && success;
+
+  FIELD_2D scaled(area);
+  const float maxArea = scaled.max();
+  if (maxArea > 0.0)
+    scaled *= 1.0 / maxArea;
+  success = scaled.writePNG(name + ".area.png") && success;
+
+  BIT_FIELD_2D exists;
+  exists.fromField(area, 0.0);
+  success = exists.writePNG(name + ".exists.png") && success;
+  return success;
+}
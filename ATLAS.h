@@ -0,0 +1,51 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+///////////////////////////////////////////////////////////////////////
+// A map of root space: one pixel per position of a free root, with the
+// other root pinned, saying what renderImage would find there. It is
+// meant for picking sweep ranges without running the sweeps.
+//
+// Every atlas pixel is classified by its critical orbits first (see
+// CRITICAL_ORBIT.h). Cantor dust stops there with no area. The rest,
+// captured ones included, are probed by iterating a coarse grid of
+// points over renderImage's X[-2, 2] Y[-2, 2] window, and the fraction
+// that didn't escape gives the shape's area; the probe is cheap next to
+// a wrong zero where a capture left interior behind. Rows are handed
+// out to one thread per core, and when the atlas is symmetric about the
+// real axis only half of it is computed.
+///////////////////////////////////////////////////////////////////////
+
+#include "FIELD_2D.h"
+#include "VEC3F.h"
+
+struct ATLAS_SETTINGS {
+  ATLAS_SETTINGS() :
+    xRes(512), yRes(512), xMin(-2.0), yMin(-2.0), size(4.0), pinnedRoot(0.0, 0.0, 0.0),
+    probeRes(16), maxIterations(100), escapeRadius(200.0), totalThreads(0)
+  {
+  };
+
+  int xRes; // atlas resolution
+  int yRes;
+  float xMin; // the free root's lower left corner...
+  float yMin;
+  float size; // ...and side length; atlas pixel (x,y) puts it at (xMin + x * size / xRes, yMin + y * size / yRes)
+  VEC3F pinnedRoot; // the other root, like -pinned's origin
+  int probeRes; // probe grid for the area, probeRes x probeRes
+  int maxIterations; // the same limits renderImage gets from RENDER_SETTINGS
+  float escapeRadius;
+  int totalThreads; // 0 is one per core
+};
+
+// "area" gets the estimated shape area, in units of the root plane,
+// with 0 where there is no shape; "connectivity" gets the
+// SHAPE_PREDICTION of each atlas pixel
+void buildAtlas(const ATLAS_SETTINGS& settings, FIELD_2D& area, FIELD_2D& connectivity);
+
+// write "name".area.fld and "name".connectivity.fld, and PNGs of the
+// area, scaled to its maximum, and of where shapes exist. False if any
+// of them couldn't be written.
+bool writeAtlas(const std::string& name, const FIELD_2D& area, const FIELD_2D& connectivity);
+
+#endif
@@ -0,0 +1,253 @@
+#include "BATCH_RENDERER.h"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+// the smallest squared magnitude whose sqrt isn't below "value", so
+// that sqrt(s) < value exactly when s is below this. sqrt is rounded
+// correctly and never goes down as s goes up, so one threshold covers
+// every s.
+///////////////////////////////////////////////////////////////////////
+static float squaredThreshold(double value)
+{
+  const float infinity = numeric_limits<float>::infinity();
+  float s = (float)(value * value);
+  while (s > 0.0f && sqrt(nextafterf(s, 0.0f)) >= value)
+    s = nextafterf(s, 0.0f);
+  while (sqrt(s) < value)
+    s = nextafterf(s, infinity);
+  return s;
+}
+
+///////////////////////////////////////////////////////////////////////
+// iterateRoots in every lane at once. Lane l starts at (startX[l],
+// startY[l]) and multiplies out the roots at rootX[r * LANES + l];
+// counts[l] gets what iterateRoots would have returned.
+///////////////////////////////////////////////////////////////////////
+template <int LANES>
+static void iterateLanes(const float* startX, const float* startY, const float* rootX, const float* rootY,
+                         int degree, int maxIterations, float escapeSq, float captureSq, int* counts)
+{
+  float iterateX[LANES];
+  float iterateY[LANES];
+  int running[LANES];
+
+  int anyRunning = 0;
+  for (int l = 0; l < LANES; l++)
+  {
+    iterateX[l] = startX[l];
+    iterateY[l] = startY[l];
+    counts[l] = 0;
+    running[l] = (startX[l] * startX[l] + startY[l] * startY[l]) < escapeSq;
+    anyRunning |= running[l];
+  }
+
+  for (int totalIterations = 0; totalIterations < maxIterations && anyRunning; totalIterations++)
+  {
+    float gX[LANES];
+    float gY[LANES];
+    for (int l = 0; l < LANES; l++)
+    {
+      gX[l] = 1.0f;
+      gY[l] = 0.0f;
+    }
+
+    // complexMultiply(g, iterate - root), for each root
+    for (int r = 0; r < degree; r++)
+    {
+      const float* laneRootX = rootX + r * LANES;
+      const float* laneRootY = rootY + r * LANES;
+      for (int l = 0; l < LANES; l++)
+      {
+        const float diffX = iterateX[l] - laneRootX[l];
+        const float diffY = iterateY[l] - laneRootY[l];
+        const float x = gX[l] * diffX - gY[l] * diffY;
+        const float y = gX[l] * diffY + gY[l] * diffX;
+        gX[l] = x;
+        gY[l] = y;
+      }
+    }
+
+    // lanes that have stopped keep their iterate and their count
+    anyRunning = 0;
+    for (int l = 0; l < LANES; l++)
+    {
+      const float magnitudeSq = gX[l] * gX[l] + gY[l] * gY[l];
+      const int wasRunning = running[l];
+      iterateX[l] = wasRunning ? gX[l] : iterateX[l];
+      iterateY[l] = wasRunning ? gY[l] : iterateY[l];
+      counts[l] += wasRunning;
+      running[l] = wasRunning & (magnitudeSq < escapeSq) & !(magnitudeSq < captureSq);
+      anyRunning |= running[l];
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// one batch of at most LANES root sets; the spare lanes repeat the
+// last root set and are thrown away
+///////////////////////////////////////////////////////////////////////
+template <int LANES>
+static void renderLanes(const RENDER_SETTINGS& settings, const vector<vector<VEC3F> >& rootSets, int first,
+                        vector<FIELD_2D>& masks, vector<long long>* iterations,
+                        vector<vector<unsigned int> >* histograms)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  const int maxIterations = settings.maxIterations;
+  const int used = min(LANES, (int)rootSets.size() - first);
+  const int degree = rootSets[first].size();
+
+  vector<float> rootX(degree * LANES);
+  vector<float> rootY(degree * LANES);
+  for (int l = 0; l < LANES; l++)
+  {
+    const vector<VEC3F>& roots = rootSets[first + min(l, used - 1)];
+    for (int r = 0; r < degree; r++)
+    {
+      rootX[r * LANES + l] = roots[r][0];
+      rootY[r * LANES + l] = roots[r][1];
+    }
+  }
+
+  const float escapeSq = squaredThreshold(settings.escapeRadius);
+  const float captureSq = squaredThreshold(1e-7);
+
+  // the same window and pixel centers as renderImage
+  const float xLength = 4.0;
+  const float yLength = 4.0;
+  const float dx = xLength / xRes;
+  const float dy = yLength / yRes;
+  const float xHalf = xLength * 0.5;
+  const float yHalf = yLength * 0.5;
+
+  long long laneIterations[LANES] = {0};
+  float startX[LANES];
+  float startY[LANES];
+  int counts[LANES];
+  for (int y = 0; y < yRes; y++)
+    for (int x = 0; x < xRes; x++)
+    {
+      const float centerX = -xHalf + 0.0f + x * dx;
+      const float centerY = -yHalf + 0.0f + y * dy;
+      for (int l = 0; l < LANES; l++)
+      {
+        startX[l] = centerX;
+        startY[l] = centerY;
+      }
+      iterateLanes<LANES>(startX, startY, &rootX[0], &rootY[0], degree, maxIterations, escapeSq, captureSq, counts);
+
+      for (int l = 0; l < used; l++)
+      {
+        masks[first + l](x, y) = (counts[l] == maxIterations) ? 1.0 : 0.0;
+        laneIterations[l] += counts[l];
+        if (histograms)
+          (*histograms)[first + l][counts[l]]++;
+      }
+    }
+
+  if (iterations)
+    for (int l = 0; l < used; l++)
+      (*iterations)[first + l] = laneIterations[l];
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void renderBatch(const RENDER_SETTINGS& settings, const vector<vector<VEC3F> >& rootSets,
+                 vector<FIELD_2D>& masks, int lanes, vector<long long>* iterations,
+                 vector<vector<unsigned int> >* histograms)
+{
+  const int total = rootSets.size();
+  masks.resize(total);
+  for (int x = 0; x < total; x++)
+    if (masks[x].xRes() != settings.xRes || masks[x].yRes() != settings.yRes)
+      masks[x] = FIELD_2D(settings.xRes, settings.yRes);
+  if (iterations)
+    iterations->assign(total, 0);
+  if (histograms)
+  {
+    histograms->resize(total);
+    for (int x = 0; x < total; x++)
+      (*histograms)[x].assign(settings.maxIterations + 1, 0);
+  }
+
+  for (int first = 0; first < total; first += lanes)
+  {
+    if (lanes == BATCH_WIDE_LANES)
+      renderLanes<BATCH_WIDE_LANES>(settings, rootSets, first, masks, iterations, histograms);
+    else
+      renderLanes<BATCH_LANES>(settings, rootSets, first, masks, iterations, histograms);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// the spare lanes at the end of a row repeat its last pixel
+///////////////////////////////////////////////////////////////////////
+template <int LANES>
+static void pixelLanes(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, FIELD_2D& mask,
+                       long long* iterations)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  const int maxIterations = settings.maxIterations;
+  const int degree = roots.size();
+  if (mask.xRes() != xRes || mask.yRes() != yRes)
+    mask = FIELD_2D(xRes, yRes);
+
+  vector<float> rootX(degree * LANES);
+  vector<float> rootY(degree * LANES);
+  for (int r = 0; r < degree; r++)
+    for (int l = 0; l < LANES; l++)
+    {
+      rootX[r * LANES + l] = roots[r][0];
+      rootY[r * LANES + l] = roots[r][1];
+    }
+
+  const float escapeSq = squaredThreshold(settings.escapeRadius);
+  const float captureSq = squaredThreshold(1e-7);
+
+  const float xLength = 4.0;
+  const float yLength = 4.0;
+  const float dx = xLength / xRes;
+  const float dy = yLength / yRes;
+  const float xHalf = xLength * 0.5;
+  const float yHalf = yLength * 0.5;
+
+  long long totalIterations = 0;
+  float startX[LANES];
+  float startY[LANES];
+  int counts[LANES];
+  for (int y = 0; y < yRes; y++)
+    for (int x0 = 0; x0 < xRes; x0 += LANES)
+    {
+      const int used = min(LANES, xRes - x0);
+      for (int l = 0; l < LANES; l++)
+      {
+        startX[l] = -xHalf + 0.0f + (x0 + min(l, used - 1)) * dx;
+        startY[l] = -yHalf + 0.0f + y * dy;
+      }
+      iterateLanes<LANES>(startX, startY, &rootX[0], &rootY[0], degree, maxIterations, escapeSq, captureSq, counts);
+
+      for (int l = 0; l < used; l++)
+      {
+        mask(x0 + l, y) = (counts[l] == maxIterations) ? 1.0 : 0.0;
+        totalIterations += counts[l];
+      }
+    }
+
+  if (iterations)
+    *iterations = totalIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void renderPixelLanes(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, FIELD_2D& mask, int lanes,
+                      long long* iterations)
+{
+  if (lanes == BATCH_WIDE_LANES)
+    pixelLanes<BATCH_WIDE_LANES>(settings, roots, mask, iterations);
+  else
+    pixelLanes<BATCH_LANES>(settings, roots, mask, iterations);
+}
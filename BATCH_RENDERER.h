@@ -0,0 +1,52 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// renderImage's first pass, the mask over the standard X[-2, 2]
+// Y[-2, 2] window, with the iteration spread over vector lanes.
+//
+// renderBatch puts a different root set in each lane and has every
+// lane iterate the same pixel, so one pass over the image produces a
+// mask per root set. A sweep has plenty of root sets of the same
+// degree waiting, all on the same pixel grid. renderPixelLanes is the
+// other way around: one root set, with neighbouring pixels in the
+// lanes.
+//
+// Lanes are plain arrays and loops that the compiler vectorizes, with
+// the same float operations in the same order as iterateRoots, so the
+// masks are exactly the ones renderImage would get, as long as neither
+// has its multiplies and adds fused, VEC3F::magnitude's dot product
+// included; the Makefile builds every file with -ffp-contract=off, and
+// checkBatch (see GOLDEN.h) checks. A lane that has
+// stopped keeps its iterate until every lane has; the magnitude tests
+// compare squared magnitudes against the squares that iterateRoots'
+// sqrt would put on the other side of its thresholds, which saves the
+// sqrt without moving any pixel.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "FIELD_2D.h"
+#include "VEC3F.h"
+#include "JULIA_RENDERER.h"
+
+// root sets per batch; renderBatch takes either
+static const int BATCH_LANES = 8;
+static const int BATCH_WIDE_LANES = 16;
+
+// masks[i](x, y) is 1 where renderImage would have found pixel (x, y)
+// didn't escape for rootSets[i], all of which have the same degree.
+// "lanes" is BATCH_LANES or BATCH_WIDE_LANES; more root sets than that
+// are done a batch at a time. If given, iterations[i] is the total
+// iteration count for rootSets[i], and histograms[i] counts its pixels
+// by iteration count, the way renderImage's metrics do.
+void renderBatch(const RENDER_SETTINGS& settings, const std::vector<std::vector<VEC3F> >& rootSets,
+                 std::vector<FIELD_2D>& masks, int lanes = BATCH_LANES,
+                 std::vector<long long>* iterations = NULL,
+                 std::vector<std::vector<unsigned int> >* histograms = NULL);
+
+// the same mask for a single root set, "lanes" pixels of a row at a
+// time
+void renderPixelLanes(const RENDER_SETTINGS& settings, const std::vector<VEC3F>& roots, FIELD_2D& mask,
+                      int lanes = BATCH_LANES, long long* iterations = NULL);
+
+#endif
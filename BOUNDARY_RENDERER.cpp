@@ -0,0 +1,414 @@
+#include "BOUNDARY_RENDERER.h"
+#include "POLYNOMIAL.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+// the fixed point the polynomial pulls away from hardest, which is
+// always on the Julia set
+///////////////////////////////////////////////////////////////////////
+static COMPLEX repellingFixedPoint(const vector<COMPLEX>& coefficients)
+{
+  // the fixed points are the roots of p(z) - z
+  vector<COMPLEX> shifted = coefficients;
+  shifted[1] -= 1.0;
+
+  vector<COMPLEX> fixedPoints;
+  solveMonic(shifted, fixedPoints);
+
+  COMPLEX best = fixedPoints[0];
+  double bestSlope = -1.0;
+  for (unsigned int x = 0; x < fixedPoints.size(); x++)
+  {
+    const double slope = abs(evaluateDerivative(coefficients, fixedPoints[x]));
+    if (slope > bestSlope)
+    {
+      bestSlope = slope;
+      best = fixedPoints[x];
+    }
+  }
+  return best;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Preimages of points off the window still lead back into it, so they
+// are followed too, but on a coarser grid over the whole Julia set so
+// that a set much bigger than the window doesn't cost more than the
+// window does. Every monic polynomial escapes past 1 + the sum of its
+// lower coefficients, so that is how far the coarse grid goes.
+///////////////////////////////////////////////////////////////////////
+void renderBoundary(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin,
+                    FIELD_2D& boundary, int densityCap, BOUNDARY_STATS* stats)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  if (boundary.xRes() != xRes || boundary.yRes() != yRes)
+    boundary.resizeAndWipe(xRes, yRes);
+  else
+    boundary.clear();
+
+  const int degree = roots.size();
+  if (degree < 2)
+    return;
+
+  vector<COMPLEX> coefficients;
+  expandRoots(roots, coefficients);
+
+  // the same window and pixel centers as renderImage
+  const double dx = 4.0 / xRes;
+  const double dy = 4.0 / yRes;
+  const double xMin = -2.0 + origin[0];
+  const double yMin = -2.0 + origin[1];
+  vector<unsigned char> hits(xRes * yRes, 0);
+
+  double radius = 1.0;
+  for (int i = 0; i < degree; i++)
+    radius += abs(coefficients[i]);
+  const int coarseRes = min(1024, max(1, (int)ceil(2.0 * radius / (8.0 * min(dx, dy)))));
+  const double coarseDx = 2.0 * radius / coarseRes;
+  vector<unsigned char> coarseHits(coarseRes * coarseRes, 0);
+
+  vector<COMPLEX> shifted = coefficients;
+  vector<COMPLEX> preimages;
+  vector<COMPLEX> stack;
+  stack.push_back(repellingFixedPoint(coefficients));
+
+  long long points = 0;
+  int boundaryPixels = 0;
+  while (!stack.empty())
+  {
+    const COMPLEX z = stack.back();
+    stack.pop_back();
+    points++;
+
+    const int x = (int)floor((z.real() - xMin) / dx + 0.5);
+    const int y = (int)floor((z.imag() - yMin) / dy + 0.5);
+    if (x >= 0 && x < xRes && y >= 0 && y < yRes)
+    {
+      unsigned char& count = hits[x + y * xRes];
+      if (count >= densityCap)
+        continue;
+      if (count == 0)
+      {
+        boundary(x, y) = 1.0;
+        boundaryPixels++;
+      }
+      count++;
+    }
+    else
+    {
+      const int coarseX = (int)floor((z.real() + radius) / coarseDx);
+      const int coarseY = (int)floor((z.imag() + radius) / coarseDx);
+      if (coarseX < 0 || coarseX >= coarseRes || coarseY < 0 || coarseY >= coarseRes)
+        continue;
+      unsigned char& count = coarseHits[coarseX + coarseY * coarseRes];
+      if (count >= densityCap)
+        continue;
+      count++;
+    }
+
+    // the preimages are the roots of p(w) - z
+    shifted[0] = coefficients[0] - z;
+    solveMonic(shifted, preimages);
+    stack.insert(stack.end(), preimages.begin(), preimages.end());
+  }
+
+  if (stats)
+  {
+    stats->points += points;
+    stats->boundaryPixels += boundaryPixels;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// one pixel, exactly the way renderImage does it
+///////////////////////////////////////////////////////////////////////
+static inline bool pixelInside(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin,
+                               int x, int y)
+{
+  const float dx = 4.0f / settings.xRes;
+  const float dy = 4.0f / settings.yRes;
+  VEC3F center;
+  center[0] = -2.0f + origin[0] + x * dx;
+  center[1] = -2.0f + origin[1] + y * dy;
+  return iterateRoots(center, roots, settings.maxIterations, settings.escapeRadius) == settings.maxIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// a row of pixels in a region, [left, right]
+///////////////////////////////////////////////////////////////////////
+struct SPAN {
+  SPAN(int y, int left, int right) : y(y), left(left), right(right) {};
+  int y;
+  int left;
+  int right;
+};
+
+// how many of zero's preimages get checked for cores
+static const unsigned int zeroPreimages = 256;
+
+// open pixels haven't been reached by the fill yet, boundary ones are
+// on the outline, pending ones belong to the region it is working on,
+// and filled ones are done
+enum PIXEL_STATE { PIXEL_OPEN, PIXEL_BOUNDARY, PIXEL_PENDING, PIXEL_FILLED };
+
+///////////////////////////////////////////////////////////////////////
+// the mask as it gets filled in, and which of its pixels have already
+// been iterated, so that none are iterated twice
+///////////////////////////////////////////////////////////////////////
+struct FILL {
+  FILL(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin, FIELD_2D& mask) :
+    settings(settings), roots(roots), origin(origin), mask(mask),
+    state(settings.xRes * settings.yRes, PIXEL_OPEN), known(settings.xRes * settings.yRes, 0), iteratedPixels(0)
+  {
+  };
+
+  int inside(int x, int y)
+  {
+    const int index = x + y * settings.xRes;
+    if (!known[index])
+    {
+      mask(x, y) = pixelInside(settings, roots, origin, x, y) ? 1.0 : 0.0;
+      known[index] = 1;
+      iteratedPixels++;
+    }
+    return (mask(x, y) > 0.5) ? 1 : 0;
+  };
+
+  // give a pixel that hasn't been iterated "value"
+  void guess(int x, int y, int value)
+  {
+    const int index = x + y * settings.xRes;
+    if (known[index])
+      return;
+    mask(x, y) = value;
+    known[index] = 1;
+  };
+
+  const RENDER_SETTINGS& settings;
+  const vector<VEC3F>& roots;
+  const VEC3F& origin;
+  FIELD_2D& mask;
+  vector<unsigned char> state;
+  vector<unsigned char> known;
+  int iteratedPixels;
+};
+
+///////////////////////////////////////////////////////////////////////
+// Mariani-Silver over [x0, x1] x [y0, y1], for a region whose border
+// didn't agree: a box whose edge and outline pixels agree gets that
+// value inside, and any other box is split in four, down to ones small enough to
+// iterate outright. Only the pending region is filled in, but the edges
+// are iterated wherever they fall, and keep their values for later.
+///////////////////////////////////////////////////////////////////////
+static void subdivide(FILL& fill, int x0, int y0, int x1, int y1)
+{
+  const int xRes = fill.settings.xRes;
+  if (x1 - x0 < 4 || y1 - y0 < 4)
+  {
+    for (int y = y0; y <= y1; y++)
+      for (int x = x0; x <= x1; x++)
+        if (fill.state[x + y * xRes] == PIXEL_PENDING)
+          fill.inside(x, y);
+    return;
+  }
+
+  const int value = fill.inside(x0, y0);
+  bool uniform = true;
+  for (int x = x0; x <= x1 && uniform; x++)
+    uniform = (fill.inside(x, y0) == value) && (fill.inside(x, y1) == value);
+  for (int y = y0; y <= y1 && uniform; y++)
+    uniform = (fill.inside(x0, y) == value) && (fill.inside(x1, y) == value);
+
+  // the outline inside the box has to agree too
+  for (int y = y0 + 1; y < y1 && uniform; y++)
+    for (int x = x0 + 1; x < x1 && uniform; x++)
+      if (fill.state[x + y * xRes] == PIXEL_BOUNDARY)
+        uniform = (fill.inside(x, y) == value);
+
+  if (uniform)
+  {
+    for (int y = y0 + 1; y < y1; y++)
+      for (int x = x0 + 1; x < x1; x++)
+        if (fill.state[x + y * xRes] == PIXEL_PENDING)
+          fill.guess(x, y, value);
+    return;
+  }
+
+  const int xMiddle = (x0 + x1) / 2;
+  const int yMiddle = (y0 + y1) / 2;
+  subdivide(fill, x0, y0, xMiddle, yMiddle);
+  subdivide(fill, xMiddle, y0, x1, yMiddle);
+  subdivide(fill, x0, yMiddle, xMiddle, y1);
+  subdivide(fill, xMiddle, yMiddle, x1, y1);
+}
+
+///////////////////////////////////////////////////////////////////////
+// Each region is found with a 4-connected scanline fill, which can't
+// slip through the diagonal steps of an 8-connected outline. Its
+// border, the pixels next to the outline or the edge of the image, is
+// iterated Mariani-Silver style: if the border agrees, the inside gets
+// the same value. If not, either the outline had a gap there or the
+// region holds a white edge that isn't the Julia set, like the band of
+// slow escapes renderImage paints white, and the region is subdivided.
+///////////////////////////////////////////////////////////////////////
+bool fillBoundary(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin,
+                  const FIELD_2D& boundary, FIELD_2D& mask, BOUNDARY_STATS* stats)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  if (mask.xRes() != xRes || mask.yRes() != yRes)
+    mask.resizeAndWipe(xRes, yRes);
+
+  FILL fill(settings, roots, origin, mask);
+  vector<unsigned char>& state = fill.state;
+
+  // the outline, and the pixels touching it: escapes right next to the
+  // Julia set are slow enough for renderImage to paint some of them
+  // white, and the outline can miss a pixel where it is thin
+  for (int y = 0; y < yRes; y++)
+    for (int x = 0; x < xRes; x++)
+      if (boundary(x, y) > 0.5)
+        for (int j = max(y - 1, 0); j <= min(y + 1, yRes - 1); j++)
+          for (int i = max(x - 1, 0); i <= min(x + 1, xRes - 1); i++)
+            if (state[i + j * xRes] != PIXEL_BOUNDARY)
+            {
+              state[i + j * xRes] = PIXEL_BOUNDARY;
+              fill.inside(i, j);
+            }
+
+  // renderImage also paints black whatever lands on zero, which can be
+  // a whole core in the middle of a white region that the outline
+  // knows nothing about. Every such core holds a point that lands on
+  // zero exactly, so the pixels around the first few generations of
+  // zero's preimages get iterated like the outline.
+  vector<COMPLEX> coefficients;
+  expandRoots(roots, coefficients);
+  vector<COMPLEX> shifted = coefficients;
+  vector<COMPLEX> preimages;
+  vector<COMPLEX> landings(1, COMPLEX(0.0, 0.0));
+  const float dx = 4.0f / xRes;
+  const float dy = 4.0f / yRes;
+  for (unsigned int z = 0; z < landings.size(); z++)
+  {
+    const int landingX = (int)floor((landings[z].real() + 2.0 - origin[0]) / dx);
+    const int landingY = (int)floor((landings[z].imag() + 2.0 - origin[1]) / dy);
+    for (int y = landingY; y <= landingY + 1; y++)
+      for (int x = landingX; x <= landingX + 1; x++)
+        if (x >= 0 && x < xRes && y >= 0 && y < yRes)
+        {
+          state[x + y * xRes] = PIXEL_BOUNDARY;
+          fill.inside(x, y);
+        }
+
+    if (landings.size() >= zeroPreimages || coefficients.size() < 3)
+      continue;
+    shifted[0] = coefficients[0] - landings[z];
+    solveMonic(shifted, preimages);
+    landings.insert(landings.end(), preimages.begin(), preimages.end());
+  }
+
+  int regions = 0;
+  vector<SPAN> spans;
+  vector<SPAN> seeds;
+  for (int seedY = 0; seedY < yRes; seedY++)
+    for (int seedX = 0; seedX < xRes; seedX++)
+    {
+      if (state[seedX + seedY * xRes] != PIXEL_OPEN)
+        continue;
+
+      // gather the region as spans
+      regions++;
+      spans.clear();
+      seeds.clear();
+      seeds.push_back(SPAN(seedY, seedX, seedX));
+      int xMin = seedX;
+      int xMax = seedX;
+      int yMin = seedY;
+      int yMax = seedY;
+      while (!seeds.empty())
+      {
+        const SPAN seed = seeds.back();
+        seeds.pop_back();
+        unsigned char* row = &state[seed.y * xRes];
+        if (row[seed.left] != PIXEL_OPEN)
+          continue;
+
+        int left = seed.left;
+        int right = seed.left;
+        while (left > 0 && row[left - 1] == PIXEL_OPEN)
+          left--;
+        while (right < xRes - 1 && row[right + 1] == PIXEL_OPEN)
+          right++;
+        for (int x = left; x <= right; x++)
+          row[x] = PIXEL_PENDING;
+        spans.push_back(SPAN(seed.y, left, right));
+        xMin = min(xMin, left);
+        xMax = max(xMax, right);
+        yMin = min(yMin, seed.y);
+        yMax = max(yMax, seed.y);
+
+        // one seed per open run in the rows above and below
+        for (int y = seed.y - 1; y <= seed.y + 1; y += 2)
+        {
+          if (y < 0 || y >= yRes)
+            continue;
+          const unsigned char* next = &state[y * xRes];
+          for (int x = left; x <= right; x++)
+            if (next[x] == PIXEL_OPEN && (x == left || next[x - 1] != PIXEL_OPEN))
+              seeds.push_back(SPAN(y, x, x));
+        }
+      }
+
+      // check the border
+      int inside = -1;
+      bool uniform = true;
+      for (unsigned int s = 0; s < spans.size() && uniform; s++)
+      {
+        const SPAN& span = spans[s];
+        const int y = span.y;
+        for (int x = span.left; x <= span.right && uniform; x++)
+        {
+          const bool border = (x == 0 || x == xRes - 1 || y == 0 || y == yRes - 1 ||
+                               state[x - 1 + y * xRes] == PIXEL_BOUNDARY || state[x + 1 + y * xRes] == PIXEL_BOUNDARY ||
+                               state[x + (y - 1) * xRes] == PIXEL_BOUNDARY || state[x + (y + 1) * xRes] == PIXEL_BOUNDARY);
+          if (!border)
+            continue;
+          const int value = fill.inside(x, y);
+          if (inside < 0)
+            inside = value;
+          uniform = (value == inside);
+        }
+      }
+
+      // a region with no border at all is the whole image
+      if (inside < 0)
+        inside = fill.inside(seedX, seedY);
+
+      if (uniform)
+      {
+        for (unsigned int s = 0; s < spans.size(); s++)
+          for (int x = spans[s].left; x <= spans[s].right; x++)
+            fill.guess(x, spans[s].y, inside);
+      }
+      else
+        subdivide(fill, xMin, yMin, xMax, yMax);
+
+      for (unsigned int s = 0; s < spans.size(); s++)
+        for (int x = spans[s].left; x <= spans[s].right; x++)
+          state[x + spans[s].y * xRes] = PIXEL_FILLED;
+    }
+
+  bool shape = false;
+  for (int x = 0; x < mask.totalCells() && !shape; x++)
+    shape = (mask[x] > 0.5);
+
+  if (stats)
+  {
+    stats->regions += regions;
+    stats->iteratedPixels += fill.iteratedPixels;
+  }
+  return shape;
+}
@@ -0,0 +1,50 @@
+#ifndef BOUNDARY_RENDERER_H
+#define BOUNDARY_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// A second way to get renderImage's mask, from the outline in.
+//
+// renderBoundary draws the Julia set of the polynomial with modified
+// inverse iteration: it starts on a repelling fixed point, which is on
+// the set, and walks the tree of preimages, which stay on the set and
+// spread out over it. Each pixel only has its preimages followed the
+// first "densityCap" times it is hit, so the walk costs time in
+// proportion to the pixels on the outline instead of the whole image.
+//
+// fillBoundary then splits the pixels off the outline into connected
+// regions with a scanline fill. The outline and the pixels touching it
+// are iterated the way renderImage would, and so is each region's
+// border; a region whose border agrees is filled with that value
+// without iterating its inside. A region whose border doesn't, where
+// the outline has a gap or renderImage's white doesn't stop at the
+// Julia set, is subdivided Mariani-Silver style instead, so a sparse
+// outline costs time rather than correctness.
+//
+// The window and pixel centers are the same as renderImage's, shifted
+// by "origin" the way centering shifts them.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "FIELD_2D.h"
+#include "VEC3F.h"
+#include "JULIA_RENDERER.h"
+
+struct BOUNDARY_STATS {
+  BOUNDARY_STATS() : points(0), boundaryPixels(0), regions(0), iteratedPixels(0) {};
+
+  long long points; // preimages visited
+  int boundaryPixels; // pixels the outline went through
+  int regions; // connected regions the fill found
+  int iteratedPixels; // pixels that had to be iterated individually
+};
+
+// boundary(x, y) is 1 where the Julia set passes through pixel (x, y)
+void renderBoundary(const RENDER_SETTINGS& settings, const std::vector<VEC3F>& roots, const VEC3F& origin,
+                    FIELD_2D& boundary, int densityCap = 4, BOUNDARY_STATS* stats = NULL);
+
+// mask(x, y) is 1 where renderImage would have found a pixel that
+// didn't escape; returns true if there are any
+bool fillBoundary(const RENDER_SETTINGS& settings, const std::vector<VEC3F>& roots, const VEC3F& origin,
+                  const FIELD_2D& boundary, FIELD_2D& mask, BOUNDARY_STATS* stats = NULL);
+
+#endif
@@ -0,0 +1,255 @@
+#include "CRITICAL_ORBIT.h"
+#include "POLYNOMIAL.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+const char* predictionName(SHAPE_PREDICTION prediction)
+{
+  switch (prediction)
+  {
+    case SHAPE_CONNECTED: return "connected";
+    case SHAPE_DISCONNECTED: return "disconnected";
+    case SHAPE_CANTOR_DUST: return "cantor dust";
+    case SHAPE_CAPTURED: return "captured";
+    default: return "unknown";
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// in double, and left there for the orbits, since the orbits that
+// start from them are sensitive
+///////////////////////////////////////////////////////////////////////
+void criticalPoints(const vector<VEC3F>& roots, vector<COMPLEX>& critical)
+{
+  critical.clear();
+  const int degree = roots.size();
+  if (degree < 2)
+    return;
+
+  vector<COMPLEX> coefficients;
+  expandRoots(roots, coefficients);
+
+  // the derivative, divided by the degree so that it stays monic
+  vector<COMPLEX> derivative(degree);
+  for (int i = 0; i < degree; i++)
+    derivative[i] = coefficients[i + 1] * (double)(i + 1) / (double)degree;
+
+  solveMonic(derivative, critical);
+}
+
+///////////////////////////////////////////////////////////////////////
+// the same loop and exits as iterateRoots, but in double: how many
+// iterations the orbit of "start" takes to escape or land on zero, and
+// maxIterations if it does neither
+///////////////////////////////////////////////////////////////////////
+enum ORBIT { ORBIT_BOUNDED, ORBIT_ESCAPED, ORBIT_CAPTURED };
+
+static int orbitLength(const COMPLEX& start, const vector<COMPLEX>& roots, int maxIterations, double escapeRadius,
+                       ORBIT& orbit)
+{
+  COMPLEX iterate = start;
+  orbit = ORBIT_ESCAPED;
+  if (abs(iterate) >= escapeRadius)
+    return 0;
+
+  for (int totalIterations = 0; totalIterations < maxIterations; totalIterations++)
+  {
+    COMPLEX g(1.0, 0.0);
+    for (unsigned int x = 0; x < roots.size(); x++)
+      g *= iterate - roots[x];
+    iterate = g;
+
+    const double magnitude = abs(iterate);
+    if (magnitude > escapeRadius)
+      return totalIterations + 1;
+    if (magnitude < 1e-7)
+    {
+      orbit = ORBIT_CAPTURED;
+      return totalIterations + 1;
+    }
+  }
+  orbit = ORBIT_BOUNDED;
+  return maxIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// A critical orbit that takes more than an eighth of the budget to
+// escape or land on zero counts as bounded: the pixels around it stop
+// slowly too, and plenty of them won't manage it within maxIterations.
+// A root that only just attracts its critical point, like the one at
+// zero for roots (0, 0) and (0.86, 0), pulls it in over 90 iterations
+// and leaves thousands of white pixels.
+///////////////////////////////////////////////////////////////////////
+static const int lateStopDivisor = 8;
+
+static ORBIT criticalOrbit(const COMPLEX& start, const vector<COMPLEX>& roots, int maxIterations, double escapeRadius)
+{
+  ORBIT orbit;
+  const int length = orbitLength(start, roots, maxIterations, escapeRadius, orbit);
+  if (orbit != ORBIT_BOUNDED && length > 0 && length - 1 >= maxIterations / lateStopDivisor)
+    return ORBIT_BOUNDED;
+  return orbit;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+SHAPE_PREDICTION predictShape(const vector<VEC3F>& roots, int maxIterations, float escapeRadius,
+                              int* bounded, int* critical)
+{
+  vector<COMPLEX> points;
+  criticalPoints(roots, points);
+
+  vector<COMPLEX> complexRoots;
+  for (unsigned int x = 0; x < roots.size(); x++)
+    complexRoots.push_back(COMPLEX(roots[x][0], roots[x][1]));
+
+  int totalBounded = 0;
+  int totalCaptured = 0;
+  for (unsigned int x = 0; x < points.size(); x++)
+  {
+    const ORBIT orbit = criticalOrbit(points[x], complexRoots, maxIterations, escapeRadius);
+    if (orbit != ORBIT_ESCAPED)
+      totalBounded++;
+    if (orbit == ORBIT_CAPTURED)
+      totalCaptured++;
+  }
+
+  if (bounded)
+    *bounded = totalBounded;
+  if (critical)
+    *critical = points.size();
+
+  // a line has no critical points to go on; let the renderer decide
+  if (points.empty())
+    return SHAPE_CONNECTED;
+  if (totalBounded == 0)
+    return SHAPE_CANTOR_DUST;
+  if (totalCaptured == totalBounded)
+    return SHAPE_CAPTURED;
+  if (totalBounded == (int)points.size())
+    return SHAPE_CONNECTED;
+  return SHAPE_DISCONNECTED;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+int slowestCriticalOrbit(const vector<VEC3F>& roots, int maxIterations, float escapeRadius)
+{
+  vector<COMPLEX> points;
+  criticalPoints(roots, points);
+
+  vector<COMPLEX> complexRoots;
+  for (unsigned int x = 0; x < roots.size(); x++)
+    complexRoots.push_back(COMPLEX(roots[x][0], roots[x][1]));
+
+  int slowest = 0;
+  for (unsigned int x = 0; x < points.size(); x++)
+  {
+    ORBIT orbit;
+    const int length = orbitLength(points[x], complexRoots, maxIterations, escapeRadius, orbit);
+    if (orbit != ORBIT_BOUNDED && length > slowest)
+      slowest = length;
+  }
+  return slowest;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+PREDICTION_AUDIT::PREDICTION_AUDIT(const string& filename, float sprinkleFraction) :
+  _file(filename.c_str()), _sprinkleFraction(sprinkleFraction), _classifySeconds(0), _renderSeconds(0)
+{
+  for (int x = 0; x < TOTAL_SHAPE_PREDICTIONS; x++)
+    for (int y = 0; y < TOTAL_RENDER_OUTCOMES; y++)
+      _counts[x][y] = 0;
+}
+
+PREDICTION_AUDIT::~PREDICTION_AUDIT()
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void PREDICTION_AUDIT::add(const vector<VEC3F>& roots, SHAPE_PREDICTION prediction, long long whitePixels, long long totalPixels)
+{
+  RENDER_OUTCOME rendered = RENDERED_NOTHING;
+  if (whitePixels >= _sprinkleFraction * totalPixels && whitePixels > 0)
+    rendered = RENDERED_SHAPE;
+  else if (whitePixels > 0)
+    rendered = RENDERED_SPRINKLES;
+  _counts[prediction][rendered]++;
+  if (!_file.is_open())
+    return;
+
+  const char* renderedNames[] = {"nothing", "sprinkles", "shape"};
+  for (unsigned int x = 0; x < roots.size(); x++)
+    _file << "topRoots" << x << roots[x] << ", ";
+  _file << "predicted " << predictionName(prediction) << ", rendered " << renderedNames[rendered]
+        << " (" << whitePixels << " white pixels)";
+
+  // the two ways to be wrong
+  if (rendered == RENDERED_SHAPE && hopeless(prediction))
+    _file << " missed";
+  else if (rendered != RENDERED_SHAPE && !hopeless(prediction))
+    _file << " wasted";
+  _file << endl;
+}
+
+void PREDICTION_AUDIT::addTime(double classifySeconds, double renderSeconds)
+{
+  _classifySeconds += classifySeconds;
+  _renderSeconds += renderSeconds;
+}
+
+///////////////////////////////////////////////////////////////////////
+// "missed" shapes are the ones skipping would have lost; "wasted"
+// renders are the ones it couldn't save
+///////////////////////////////////////////////////////////////////////
+void PREDICTION_AUDIT::close()
+{
+  if (!_file.is_open())
+    return;
+
+  long long total = 0;
+  long long shapes = 0;
+  for (int x = 0; x < TOTAL_SHAPE_PREDICTIONS; x++)
+  {
+    for (int y = 0; y < TOTAL_RENDER_OUTCOMES; y++)
+      total += _counts[x][y];
+    shapes += _counts[x][RENDERED_SHAPE];
+  }
+
+  _file << endl << "prediction      shape  sprinkles    nothing" << endl;
+  for (int x = 0; x < TOTAL_SHAPE_PREDICTIONS; x++)
+  {
+    char line[256];
+    snprintf(line, sizeof(line), "%-14s %6lld %10lld %10lld", predictionName((SHAPE_PREDICTION)x),
+             _counts[x][RENDERED_SHAPE], _counts[x][RENDERED_SPRINKLES], _counts[x][RENDERED_NOTHING]);
+    _file << line << endl;
+  }
+
+  long long skippable = 0;
+  long long missed = 0;
+  long long wasted = 0;
+  for (int x = 0; x < TOTAL_SHAPE_PREDICTIONS; x++)
+  {
+    if (hopeless((SHAPE_PREDICTION)x))
+    {
+      for (int y = 0; y < TOTAL_RENDER_OUTCOMES; y++)
+        skippable += _counts[x][y];
+      missed += _counts[x][RENDERED_SHAPE];
+    }
+    else
+      wasted += _counts[x][RENDERED_SPRINKLES] + _counts[x][RENDERED_NOTHING];
+  }
+  _file << endl;
+  _file << "configurations: " << total << ", with a shape: " << shapes << endl;
+  _file << "skippable as hopeless: " << skippable << ", missed shapes among them: " << missed << endl;
+  _file << "rendered without a shape anyway: " << wasted << endl;
+  _file << "classify seconds: " << _classifySeconds << ", render seconds: " << _renderSeconds << endl;
+  _file.close();
+}
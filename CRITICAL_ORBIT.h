@@ -0,0 +1,90 @@
+#ifndef CRITICAL_ORBIT_H
+#define CRITICAL_ORBIT_H
+
+///////////////////////////////////////////////////////////////////////
+// Predicts whether renderImage will find a shape before it renders
+// anything.
+//
+// The Julia set of the polynomial whose roots are given is connected if
+// the orbits of all its critical points (the roots of its derivative)
+// stay bounded, and is Cantor dust, with no interior for renderImage to
+// find, if all of them escape. Anything in between is disconnected but
+// can still have pieces with interior. Iterating the few critical
+// points costs a few hundred complex multiplies, against a pass over
+// every pixel for renderImage.
+//
+// renderImage also paints black anything that lands on zero, so a
+// critical orbit that does that is no more use than one that escapes:
+// if every bounded critical orbit is captured by zero, the attracting
+// cycles all run through it and there is no interior left to be white.
+// Orbits that take a long time to escape or to be captured count as
+// bounded, since the pixels around them take as long and many run out
+// of iterations first.
+//
+// The prediction only looks at the dynamics, not at the viewing
+// window, so a connected set can still miss the window or be all
+// boundary; PREDICTION_AUDIT measures how often it is right.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "VEC3F.h"
+#include "POLYNOMIAL.h"
+
+enum SHAPE_PREDICTION { SHAPE_CONNECTED, SHAPE_DISCONNECTED, SHAPE_CANTOR_DUST, SHAPE_CAPTURED,
+                        TOTAL_SHAPE_PREDICTIONS };
+
+// is there no hope of renderImage finding a shape?
+inline bool hopeless(SHAPE_PREDICTION prediction) { return prediction == SHAPE_CANTOR_DUST || prediction == SHAPE_CAPTURED; }
+
+// "connected", "disconnected", "cantor dust" or "captured"
+const char* predictionName(SHAPE_PREDICTION prediction);
+
+// the roots of the derivative of the monic polynomial with "roots",
+// repeated ones included, in double
+void criticalPoints(const std::vector<VEC3F>& roots, std::vector<COMPLEX>& critical);
+
+// iterate the critical points with the same limits as renderImage;
+// "bounded" and "critical", if given, get how many of the critical
+// points stayed bounded, captured or not, out of how many there are
+SHAPE_PREDICTION predictShape(const std::vector<VEC3F>& roots, int maxIterations, float escapeRadius,
+                              int* bounded = NULL, int* critical = NULL);
+
+// how many iterations the slowest of the critical orbits that escape
+// or land on zero takes to do it, with the same limits as renderImage;
+// 0 if none of them do. The pixels around a critical point follow its
+// orbit, so they stop at about the same time.
+int slowestCriticalOrbit(const std::vector<VEC3F>& roots, int maxIterations, float escapeRadius);
+
+// a running comparison of predictions against what renderImage found,
+// one line per configuration and a summary table at the end. A render
+// with only a few white pixels, where the pixel grid happened to land
+// on the Julia set itself, counts as sprinkles rather than a shape.
+enum RENDER_OUTCOME { RENDERED_NOTHING, RENDERED_SPRINKLES, RENDERED_SHAPE, TOTAL_RENDER_OUTCOMES };
+
+class PREDICTION_AUDIT {
+public:
+  // fewer than "sprinkleFraction" of the pixels white is sprinkles
+  PREDICTION_AUDIT(const std::string& filename, float sprinkleFraction = 1e-4);
+  ~PREDICTION_AUDIT();
+
+  bool isOpen() const { return _file.is_open(); };
+
+  void add(const std::vector<VEC3F>& roots, SHAPE_PREDICTION prediction, long long whitePixels, long long totalPixels);
+
+  // how long the predictions and the renders they are checked against took
+  void addTime(double classifySeconds, double renderSeconds);
+
+  // write the summary and close the file
+  void close();
+
+private:
+  std::ofstream _file;
+  float _sprinkleFraction;
+  long long _counts[TOTAL_SHAPE_PREDICTIONS][TOTAL_RENDER_OUTCOMES];
+  double _classifySeconds;
+  double _renderSeconds;
+};
+
+#endif
@@ -1,7 +1,210 @@
 #include "FIELD_2D.h"
+#include "FIELD_2D_FILE.h"
 #include <jpeglib.h>
 #include <png.h>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// storage starts on a cache line, which is also a full AVX-512 register,
+// so the loops below vectorize without peeling off a misaligned head
+static const size_t cellAlignment = 64;
+static const int cellsPerLine = cellAlignment / sizeof(float);
+
+// fields at least this big are padded out to whole huge pages, and
+// start on one, so the kernel can back them with huge pages and the
+// sweeps over them don't thrash the TLB
+static const size_t hugePageBytes = 2 * 1024 * 1024;
+
+// fields with at least this many cells are split across threads
+static const int parallelCells = 1 << 20;
+
+// reductions keep this many partial results so they vectorize
+static const int reductionLanes = 16;
+
+// pairwise sums bottom out at blocks this big
+static const int pairwiseBlock = 256;
+
+#if defined(__GNUC__)
+#define RESTRICT __restrict__
+#define ASSUME_ALIGNED(pointer) ((decltype(pointer))__builtin_assume_aligned(pointer, cellAlignment))
+#else
+#define RESTRICT
+#define ASSUME_ALIGNED(pointer) (pointer)
+#endif
+
+///////////////////////////////////////////////////////////////////////
+// aligned storage for at least "totalCells" cells; "capacity" is set to
+// how many were actually allocated
+///////////////////////////////////////////////////////////////////////
+static float* allocateCells(int totalCells, int& capacity)
+{
+  capacity = 0;
+  if (totalCells <= 0)
+    return NULL;
+
+  size_t bytes = totalCells * sizeof(float);
+  size_t alignment = cellAlignment;
+  if (bytes >= hugePageBytes)
+  {
+    bytes = ((bytes + hugePageBytes - 1) / hugePageBytes) * hugePageBytes;
+    alignment = hugePageBytes;
+  }
+
+  void* cells = NULL;
+#ifdef _WIN32
+  cells = _aligned_malloc(bytes, alignment);
+#else
+  if (posix_memalign(&cells, alignment, bytes) != 0)
+    cells = NULL;
+#endif
+  if (cells == NULL)
+  {
+    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
+    cout << " FIELD_2D could not allocate " << totalCells << " cells! " << endl;
+    exit(0);
+  }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // only a hint; fine if transparent huge pages are turned off
+  if (alignment == hugePageBytes)
+    madvise(cells, bytes, MADV_HUGEPAGE);
+#endif
+
+  capacity = bytes / sizeof(float);
+  return (float*)cells;
+}
+
+static void freeCells(float* cells)
+{
+#ifdef _WIN32
+  _aligned_free(cells);
+#else
+  free(cells);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////
+// how many threads an operation over "totalCells" gets
+///////////////////////////////////////////////////////////////////////
+static int totalBlocks(int totalCells)
+{
+  if (totalCells < parallelCells)
+    return 1;
+
+  int totalThreads = std::thread::hardware_concurrency();
+  return (totalThreads > 1) ? totalThreads : 1;
+}
+
+///////////////////////////////////////////////////////////////////////
+// call function(block, begin, end) over [0, totalCells) split into
+// "blocks" pieces that each start on a cache line, one thread apiece
+///////////////////////////////////////////////////////////////////////
+template <class FUNCTION>
+static void forEachBlock(int totalCells, int blocks, const FUNCTION& function)
+{
+  if (blocks <= 1)
+  {
+    function(0, 0, totalCells);
+    return;
+  }
+
+  int blockSize = (totalCells + blocks - 1) / blocks;
+  blockSize = ((blockSize + cellsPerLine - 1) / cellsPerLine) * cellsPerLine;
+
+  std::vector<std::thread> threads;
+  for (int block = 1; block < blocks && block * blockSize < totalCells; block++)
+  {
+    const int begin = block * blockSize;
+    const int end = std::min(totalCells, begin + blockSize);
+    threads.push_back(std::thread([&function, block, begin, end]() { function(block, begin, end); }));
+  }
+  function(0, 0, std::min(totalCells, blockSize));
+
+  for (unsigned int x = 0; x < threads.size(); x++)
+    threads[x].join();
+}
+
+///////////////////////////////////////////////////////////////////////
+// pairwise sum of "size" floats, so the rounding error grows with the
+// log of the size instead of the size. The blocks at the bottom are
+// summed into independent lanes so they vectorize.
+///////////////////////////////////////////////////////////////////////
+static double pairwiseSum(const float* data, int size)
+{
+  if (size > pairwiseBlock)
+  {
+    int half = ((size / 2 + cellsPerLine - 1) / cellsPerLine) * cellsPerLine;
+    return pairwiseSum(data, half) + pairwiseSum(data + half, size - half);
+  }
+
+  float lanes[reductionLanes] = {0};
+  int x = 0;
+  for (; x + reductionLanes <= size; x += reductionLanes)
+    for (int y = 0; y < reductionLanes; y++)
+      lanes[y] += data[x + y];
+
+  double total = 0;
+  for (; x < size; x++)
+    total += data[x];
+  for (int y = 0; y < reductionLanes; y++)
+    total += lanes[y];
+  return total;
+}
+
+///////////////////////////////////////////////////////////////////////
+// min and max of "size" floats, size > 0
+///////////////////////////////////////////////////////////////////////
+static void minMax(const float* data, int size, float& minFound, float& maxFound)
+{
+  float minLanes[reductionLanes];
+  float maxLanes[reductionLanes];
+  for (int y = 0; y < reductionLanes; y++)
+    minLanes[y] = maxLanes[y] = data[0];
+
+  int x = 0;
+  for (; x + reductionLanes <= size; x += reductionLanes)
+    for (int y = 0; y < reductionLanes; y++)
+    {
+      minLanes[y] = (data[x + y] < minLanes[y]) ? data[x + y] : minLanes[y];
+      maxLanes[y] = (data[x + y] > maxLanes[y]) ? data[x + y] : maxLanes[y];
+    }
+
+  minFound = maxFound = data[0];
+  for (; x < size; x++)
+  {
+    minFound = (data[x] < minFound) ? data[x] : minFound;
+    maxFound = (data[x] > maxFound) ? data[x] : maxFound;
+  }
+  for (int y = 0; y < reductionLanes; y++)
+  {
+    minFound = (minLanes[y] < minFound) ? minLanes[y] : minFound;
+    maxFound = (maxLanes[y] > maxFound) ? maxLanes[y] : maxFound;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// min and max over every thread's share of the field
+///////////////////////////////////////////////////////////////////////
+static void minMaxField(const float* data, int totalCells, float& minFound, float& maxFound)
+{
+  const int blocks = totalBlocks(totalCells);
+  std::vector<float> minFounds(blocks, data[0]);
+  std::vector<float> maxFounds(blocks, data[0]);
+  forEachBlock(totalCells, blocks, [&](int block, int begin, int end) {
+    minMax(data + begin, end - begin, minFounds[block], maxFounds[block]);
+  });
+
+  minFound = *std::min_element(minFounds.begin(), minFounds.end());
+  maxFound = *std::max_element(maxFounds.begin(), maxFounds.end());
+}
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
@@ -9,24 +212,28 @@ FIELD_2D::FIELD_2D(const int& rows, const int& cols) :
   _xRes(rows), _yRes(cols)
 {
   _totalCells = _xRes * _yRes;
-  _data = new float[_totalCells];
-
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = 0.0;
+  _data = allocateCells(_totalCells, _capacity);
+  clear();
 }
 
 FIELD_2D::FIELD_2D(const FIELD_2D& m) :
   _xRes(m.xRes()), _yRes(m.yRes())
 {
   _totalCells = _xRes * _yRes;
-  _data = new float[_totalCells];
+  _data = allocateCells(_totalCells, _capacity);
+  if (_totalCells > 0)
+    memcpy(_data, m._data, _totalCells * sizeof(float));
+}
 
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = m[x];
+FIELD_2D::FIELD_2D(FIELD_2D&& m) :
+  _xRes(m._xRes), _yRes(m._yRes), _totalCells(m._totalCells), _capacity(m._capacity), _data(m._data)
+{
+  m._xRes = m._yRes = m._totalCells = m._capacity = 0;
+  m._data = NULL;
 }
 
 FIELD_2D::FIELD_2D() :
-  _xRes(0), _yRes(0), _totalCells(0), _data(NULL)
+  _xRes(0), _yRes(0), _totalCells(0), _capacity(0), _data(NULL)
 {
 }
 
@@ -34,86 +241,109 @@ FIELD_2D::FIELD_2D() :
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D::~FIELD_2D()
 {
-  delete[] _data;
+  freeCells(_data);
 }
   
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 void FIELD_2D::clear()
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = 0.0;
+  if (_totalCells > 0)
+    memset(_data, 0, _totalCells * sizeof(float));
 }
 
 ///////////////////////////////////////////////////////////////////////
+// native floats in the versioned format, see FIELD_2D_FILE.h
 ///////////////////////////////////////////////////////////////////////
-void FIELD_2D::write(string filename) const
+bool FIELD_2D::write(string filename, bool compress) const
 {
-  FILE* file;
-  file = fopen(filename.c_str(), "wb");
-  if (file == NULL)
+  FIELD_2D_WRITER writer;
+  if (!writer.open(filename, _xRes, _yRes, compress) ||
+      !writer.writeRows(_data, _yRes) ||
+      !writer.close())
   {
-    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
-    cout << " FIELD_2D write failed! " << endl;
-    cout << " Could not open file " << filename.c_str() << endl;
-    exit(0);
+    cout << " FIELD_2D write of " << filename.c_str() << " failed: " << writer.error() << endl;
+    return false;
   }
+  return true;
+}
 
-  // write dimensions
-  fwrite((void*)&_xRes, sizeof(int), 1, file);
-  fwrite((void*)&_yRes, sizeof(int), 1, file);
-
-  // always write out as a double
-  if (sizeof(float) != sizeof(double))
+///////////////////////////////////////////////////////////////////////
+// reads the versioned format, or the old dimensions-then-doubles one,
+// straight into the cells; a file with more cells than fit in an int
+// has to be mapped with MAPPED_FIELD_2D instead
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D::read(string filename)
+{
+  string error;
+  bool success = false;
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL)
+    error = "couldn't open the file";
+  else
   {
-    double* dataDouble = new double[_totalCells];
-    for (int x = 0; x < _totalCells; x++)
-      dataDouble[x] = _data[x];
-
-    fwrite((void*)dataDouble, sizeof(double), _totalCells, file);
-    delete[] dataDouble;
+    FIELD_FILE_HEADER header;
+    bool versioned;
+    if (readFieldHeader(file, header, versioned, error))
+    {
+      if (versioned && header.yRes > 0 && header.xRes > INT_MAX / header.yRes)
+        error = "too many cells for a FIELD_2D";
+      else if (versioned)
+      {
+        resize(header.xRes, header.yRes);
+        success = readFieldCells(file, header, _data, _totalCells, error);
+      }
+      else
+        success = readLegacy(file, error);
+    }
     fclose(file);
   }
-  else
-    fwrite((void*)_data, sizeof(float), _totalCells, file);
-  fclose(file);
+
+  if (!success)
+    cout << " FIELD_2D read of " << filename.c_str() << " failed: " << error << endl;
+  return success;
 }
 
 ///////////////////////////////////////////////////////////////////////
+// the dimensions, then doubles, converted a chunk at a time
 ///////////////////////////////////////////////////////////////////////
-void FIELD_2D::read(string filename)
+bool FIELD_2D::readLegacy(FILE* file, string& error)
 {
-  FILE* file;
-  file = fopen(filename.c_str(), "rb");
-  if (file == NULL)
+  int xRes = 0;
+  int yRes = 0;
+  if (fread((void*)&xRes, sizeof(int), 1, file) != 1 ||
+      fread((void*)&yRes, sizeof(int), 1, file) != 1 ||
+      xRes < 0 || yRes < 0 || (yRes > 0 && xRes > INT_MAX / yRes))
   {
-    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
-    cout << " FIELD_2D read failed! " << endl;
-    cout << " Could not open file " << filename.c_str() << endl;
-    exit(0);
+    error = "bad field dimensions";
+    return false;
   }
 
-  // read dimensions
-  fread((void*)&_xRes, sizeof(int), 1, file);
-  fread((void*)&_yRes, sizeof(int), 1, file);
-  _totalCells = _xRes * _yRes;
-  if (_data) delete[] _data;
-  _data = new float[_totalCells];
-
-  // always read in as a double
-  if (sizeof(float) != sizeof(double))
+  // check the size first, so garbage doesn't turn into a huge allocation
+  const long start = ftell(file);
+  fseek(file, 0, SEEK_END);
+  const long long available = ftell(file) - start;
+  fseek(file, start, SEEK_SET);
+  if (available < (long long)xRes * yRes * (long long)sizeof(double))
   {
-    double* dataDouble = new double[_totalCells];
-    fread((void*)dataDouble, sizeof(double), _totalCells, file);
-
-    for (int x = 0; x < _totalCells; x++)
-      _data[x] = dataDouble[x];
+    error = "truncated field cells";
+    return false;
+  }
 
-    delete[] dataDouble;
+  resize(xRes, yRes);
+  std::vector<double> chunk(1 << 16);
+  for (int x = 0; x < _totalCells; x += chunk.size())
+  {
+    const int size = std::min((int)chunk.size(), _totalCells - x);
+    if (fread(&chunk[0], sizeof(double), size, file) != (size_t)size)
+    {
+      error = "truncated field cells";
+      return false;
+    }
+    for (int y = 0; y < size; y++)
+      _data[x + y] = chunk[y];
   }
-  else
-    fread((void*)_data, sizeof(float), _totalCells, file);
-  fclose(file);
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -156,21 +386,37 @@ void FIELD_2D::writeMatlab(string filename, string variableName) const
 }
 
 ///////////////////////////////////////////////////////////////////////
-// code based on example code from
-// http://zarb.org/~gc/html/libpng.html  
+// average one decoded 8 bit gray or RGB row into a row of cells
 ///////////////////////////////////////////////////////////////////////
-void FIELD_2D::readPNG(string filename)
+static void pngRowToCells(const png_byte* row, int channels, int width, float* cells)
 {
-  cout << " Reading in PNG file " << filename.c_str() << endl;
+  if (channels == 1)
+  {
+    for (int x = 0; x < width; x++)
+      cells[x] = row[x] / 255.0;
+    return;
+  }
 
-  int width, height;
-  png_structp png_ptr;
-  png_infop info_ptr;
-  png_byte color_type;
-  png_byte bit_depth;
+  for (int x = 0; x < width; x++)
+  {
+    float r = (float)row[3 * x] / 255.0;
+    float g = (float)row[3 * x + 1] / 255.0;
+    float b = (float)row[3 * x + 2] / 255.0;
+    cells[x] = (r + g + b) / 3.0;
+  }
+}
 
-  int number_of_passes;
-  png_bytep* row_pointers;
+///////////////////////////////////////////////////////////////////////
+// code based on example code from
+// http://zarb.org/~gc/html/libpng.html  
+//
+// libpng hands the image over a row at a time into one reused row, and
+// palettes, alpha, 16 bit and 1, 2 and 4 bit gray are all brought down
+// to 8 bit gray or RGB on the way in. Interlaced files fill each row in
+// over several passes, so those still need the whole image at once.
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D::readPNG(string filename)
+{
   png_byte header[8];    // 8 is the maximum size that can be checked
 
   // open file and test for it being a png 
@@ -178,166 +424,120 @@ void FIELD_2D::readPNG(string filename)
   if (fp == NULL)
   {
     printf("[read_png_file] File %s could not be opened for reading\n", filename.c_str());
-    exit(0);
+    return false;
   }
-  fread(header, 1, 8, fp);
-  if (png_sig_cmp(header, 0, 8))
+  if (fread(header, 1, 8, fp) != 8 || png_sig_cmp(header, 0, 8))
+  {
     printf("[read_png_file] File %s is not recognized as a PNG file\n", filename.c_str());
+    fclose(fp);
+    return false;
+  }
 
   // initialize stuff
-  png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-
-  if (!png_ptr)
+  png_structp png_ptr = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  png_infop info_ptr = png_ptr ? png_create_info_struct(png_ptr) : NULL;
+  if (!png_ptr || !info_ptr)
+  {
     printf("[read_png_file] png_create_read_struct failed\n");
+    png_destroy_read_struct(&png_ptr, NULL, NULL);
+    fclose(fp);
+    return false;
+  }
 
-  info_ptr = png_create_info_struct(png_ptr);
-  if (!info_ptr)
-    printf("[read_png_file] png_create_info_struct failed\n");
+  // declared before the setjmp so a longjmp out of libpng doesn't skip
+  // their destructors
+  vector<png_byte> rows;
+  vector<png_bytep> rowPointers;
 
   if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[read_png_file] Error during init_io\n");
+  {
+    printf("[read_png_file] Error while reading %s\n", filename.c_str());
+    png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+    fclose(fp);
+    return false;
+  }
 
   png_init_io(png_ptr, fp);
   png_set_sig_bytes(png_ptr, 8);
   png_read_info(png_ptr, info_ptr);
 
-  width = png_get_image_width(png_ptr, info_ptr);
-  height = png_get_image_height(png_ptr, info_ptr);
-  color_type = png_get_color_type(png_ptr, info_ptr);
-  bit_depth = png_get_bit_depth(png_ptr, info_ptr);
-
-  number_of_passes = png_set_interlace_handling(png_ptr);
+  const int width = png_get_image_width(png_ptr, info_ptr);
+  const int height = png_get_image_height(png_ptr, info_ptr);
+  const png_byte color_type = png_get_color_type(png_ptr, info_ptr);
+  const png_byte bit_depth = png_get_bit_depth(png_ptr, info_ptr);
+
+  if (color_type == PNG_COLOR_TYPE_PALETTE)
+    png_set_palette_to_rgb(png_ptr);
+  // 1, 2 and 4 bit masks, like BIT_FIELD_2D writes, come in as bytes
+  if (color_type == PNG_COLOR_TYPE_GRAY && bit_depth < 8)
+    png_set_expand_gray_1_2_4_to_8(png_ptr);
+  if (bit_depth == 16)
+    png_set_strip_16(png_ptr);
+  if (color_type & PNG_COLOR_MASK_ALPHA)
+    png_set_strip_alpha(png_ptr);
+
+  const int number_of_passes = png_set_interlace_handling(png_ptr);
   png_read_update_info(png_ptr, info_ptr);
 
-  // read file
-  if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[read_png_file] Error during read_image\n");
-
-  row_pointers = (png_bytep*) malloc(sizeof(png_bytep) * height);
-  for (int y = 0; y < height; y++)
-    row_pointers[y] = (png_byte*) malloc(png_get_rowbytes(png_ptr,info_ptr));
-
-  png_read_image(png_ptr, row_pointers);
-  fclose(fp);
+  const int channels = png_get_channels(png_ptr, info_ptr);
+  const size_t rowBytes = png_get_rowbytes(png_ptr, info_ptr);
 
   // push the data into the member variables
-  _xRes = width;
-  _yRes = height;
-  _totalCells = _xRes * _yRes;
+  resize(width, height);
 
-  if (_data) delete[] _data;
-  _data = new float[_totalCells];
-
-  if (color_type == PNG_COLOR_TYPE_GRAY)
+  if (number_of_passes == 1)
   {
-    cout << " PNG color type is gray" << endl;
-    for (int y = 0; y < _yRes; y++)
-      for (int x = 0; x < _xRes; x++)
-        (*this)(x,y) = row_pointers[height - 1 - y][x] / 255.0;
-  }
-  else if (color_type == PNG_COLOR_TYPE_RGB)
-  {
-    cout << " PNG color type is RGB" << endl;
-    for (int y = 0; y < _yRes; y++)
-      for (int x = 0; x < _xRes; x++)
-      {
-        float r = (float)row_pointers[height - 1 - y][3 * x] / 255.0;
-        float g = (float)row_pointers[height - 1 - y][3 * x + 1] / 255.0;
-        float b = (float)row_pointers[height - 1 - y][3 * x + 2] / 255.0;
-        (*this)(x,y) = (r + g + b) / 3.0;
-      }
+    rows.resize(rowBytes);
+    for (int y = 0; y < height; y++)
+    {
+      png_read_row(png_ptr, &rows[0], NULL);
+      pngRowToCells(&rows[0], channels, width, &_data[(height - 1 - y) * width]);
+    }
   }
   else
   {
-    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
-    cout << " PNG color type is unsupported! " << endl;
-    exit(0);
+    rows.resize(rowBytes * height);
+    rowPointers.resize(height);
+    for (int y = 0; y < height; y++)
+      rowPointers[y] = &rows[y * rowBytes];
+    png_read_image(png_ptr, &rowPointers[0]);
+
+    for (int y = 0; y < height; y++)
+      pngRowToCells(rowPointers[height - 1 - y], channels, width, &_data[y * width]);
   }
 
-  for (int y = 0; y < height; y++)
-    free(row_pointers[y]);
-  free(row_pointers);
+  png_read_end(png_ptr, NULL);
+  png_destroy_read_struct(&png_ptr, &info_ptr, NULL);
+  fclose(fp);
+  return true;
 }
 
 ///////////////////////////////////////////////////////////////////////
-// code based on example code from
-// http://zarb.org/~gc/html/libpng.html  
+// top row first, clamped to [0,1], through one reused row
 ///////////////////////////////////////////////////////////////////////
-void FIELD_2D::writePNG(string filename)
+bool FIELD_2D::writePNG(string filename, const PNG_SETTINGS& settings) const
 {
-  cout << " Writing out PNG file " << filename.c_str() << endl;
+  vector<unsigned char> row(_xRes);
 
-  int width = _xRes; 
-  int height = _yRes;
-
-  // copy image data into pointers
-  png_bytep* row_pointers;
-  row_pointers = (png_bytep*) malloc(sizeof(png_bytep) * height);
-  for (int y = 0; y < height; y++)
-    row_pointers[y] = (png_byte*) malloc(sizeof(png_byte) * width);
-
-  for (int y = 0; y < height; y++)
-    for (int x = 0; x < width; x++)
+  PNG_WRITER writer;
+  bool success = writer.open(filename, _xRes, _yRes, 1, 8, settings);
+  for (int y = _yRes - 1; success && y >= 0; y--)
+  {
+    const float* cells = &_data[y * _xRes];
+    for (int x = 0; x < _xRes; x++)
     {
-      float value = (*this)(x,y) * 255;
+      float value = cells[x] * 255;
       value = (value > 255)  ? 255 : value;
       value = (value < 0)  ? 0 : value;
-      row_pointers[height - 1 - y][x] = (unsigned char)value;
+      row[x] = (unsigned char)value;
     }
+    success = writer.writeRow(&row[0]);
+  }
+  success = success && writer.close();
 
-  png_structp png_ptr;
-  png_infop info_ptr;
-  png_byte color_type = PNG_COLOR_TYPE_GRAY;
-  png_byte bit_depth = 8;
-
-  // create file
-  FILE *fp = fopen(filename.c_str(), "wb");
-  if (fp == NULL)
-    printf("[write_png_file] File %s could not be opened for writing\n", filename.c_str());
-
-  // initialize stuff
-  png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-
-  if (!png_ptr)
-    printf("[write_png_file] png_create_write_struct failed\n");
-
-  info_ptr = png_create_info_struct(png_ptr);
-  if (!info_ptr)
-    printf("[write_png_file] png_create_info_struct failed\n");
-
-  if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[write_png_file] Error during init_io\n");
-
-  png_init_io(png_ptr, fp);
-
-  // write header
-  if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[write_png_file] Error during writing header\n");
-
-  png_set_IHDR(png_ptr, info_ptr, width, height,
-       bit_depth, color_type, PNG_INTERLACE_NONE,
-       PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
-
-  png_write_info(png_ptr, info_ptr);
-
-  // write bytes
-  if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[write_png_file] Error during writing bytes\n");
-
-  png_write_image(png_ptr, row_pointers);
-  
-  // end write
-  if (setjmp(png_jmpbuf(png_ptr)))
-    printf("[write_png_file] Error during end of write\n");
-
-  png_write_end(png_ptr, NULL);
-
-  // cleanup heap allocation
-  for (int y=0; y<height; y++)
-    free(row_pointers[y]);
-  free(row_pointers);
-
-  fclose(fp);
+  if (!success)
+    printf("[write_png_file] %s\n", writer.error().c_str());
+  return success;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -409,25 +609,29 @@ void FIELD_2D::writeJPG(string filename)
 ///////////////////////////////////////////////////////////////////////
 void FIELD_2D::normalize()
 {
-  float maxFound = 0.0;
-  float minFound = _data[0];
-  for (int x = 0; x < _totalCells; x++)
-  {
-    maxFound = (_data[x] > maxFound) ? _data[x] : maxFound;
-    minFound = (_data[x] < minFound) ? _data[x] : minFound;
-  }
+  if (_totalCells == 0)
+    return;
 
-  float range = 1.0 / (maxFound - minFound);
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = (_data[x] - minFound) * range;
+  float minFound, maxFound;
+  minMaxField(_data, _totalCells, minFound, maxFound);
+
+  const float range = 1.0 / (maxFound - minFound);
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] = (data[x] - minFound) * range;
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D& FIELD_2D::abs()
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = fabs(_data[x]);
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] = fabsf(data[x]);
+  });
 
   return *this;
 }
@@ -436,28 +640,36 @@ FIELD_2D& FIELD_2D::abs()
 ///////////////////////////////////////////////////////////////////////
 void FIELD_2D::resizeAndWipe(int xRes, int yRes)
 {
-  if (_xRes == xRes && _yRes == yRes)
-  {
-    clear();
-    return;
-  }
-
-  if (_data)
-    delete[] _data;
+  resize(xRes, yRes);
+  clear();
+}
 
+///////////////////////////////////////////////////////////////////////
+// change the dimensions, leaving the cells undefined. Only goes back to
+// the heap when the field outgrows what it already has.
+///////////////////////////////////////////////////////////////////////
+void FIELD_2D::resize(int xRes, int yRes)
+{
   _xRes = xRes;
   _yRes = yRes;
   _totalCells = _xRes * _yRes;
+  if (_totalCells <= _capacity)
+    return;
 
-  _data = new float[_xRes * _yRes];
+  freeCells(_data);
+  _data = allocateCells(_totalCells, _capacity);
 }
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D& FIELD_2D::operator=(const float& alpha)
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = alpha;
+  const float value = alpha;
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] = value;
+  });
 
   return *this;
 }
@@ -466,8 +678,12 @@ FIELD_2D& FIELD_2D::operator=(const float& alpha)
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D& FIELD_2D::operator*=(const float& alpha)
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] *= alpha;
+  const float value = alpha;
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] *= value;
+  });
 
   return *this;
 }
@@ -476,8 +692,12 @@ FIELD_2D& FIELD_2D::operator*=(const float& alpha)
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D& FIELD_2D::operator/=(const float& alpha)
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] /= alpha;
+  const float value = alpha;
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] /= value;
+  });
 
   return *this;
 }
@@ -486,8 +706,12 @@ FIELD_2D& FIELD_2D::operator/=(const float& alpha)
 ///////////////////////////////////////////////////////////////////////
 FIELD_2D& FIELD_2D::operator+=(const float& alpha)
 {
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] += alpha;
+  const float value = alpha;
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] += value;
+  });
 
   return *this;
 }
@@ -498,8 +722,12 @@ FIELD_2D& FIELD_2D::operator-=(const FIELD_2D& input)
 {
   assert(input.xRes() == _xRes);
   assert(input.yRes() == _yRes);
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] -= input[x];
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    const float* RESTRICT other = ASSUME_ALIGNED(input._data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] -= other[x];
+  });
 
   return *this;
 }
@@ -510,8 +738,12 @@ FIELD_2D& FIELD_2D::operator+=(const FIELD_2D& input)
 {
   assert(input.xRes() == _xRes);
   assert(input.yRes() == _yRes);
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] += input[x];
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    const float* RESTRICT other = ASSUME_ALIGNED(input._data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] += other[x];
+  });
 
   return *this;
 }
@@ -523,8 +755,12 @@ FIELD_2D& FIELD_2D::operator*=(const FIELD_2D& input)
   assert(input.xRes() == _xRes);
   assert(input.yRes() == _yRes);
 
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] *= input[x];
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    const float* RESTRICT other = ASSUME_ALIGNED(input._data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] *= other[x];
+  });
 
   return *this;
 }
@@ -536,95 +772,68 @@ FIELD_2D& FIELD_2D::operator/=(const FIELD_2D& input)
   assert(input.xRes() == _xRes);
   assert(input.yRes() == _yRes);
 
-  for (int x = 0; x < _totalCells; x++)
-    if (fabs(input[x]) > 1e-6)
-      _data[x] /= input[x];
-    else
-      _data[x] = 0;
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    const float* RESTRICT other = ASSUME_ALIGNED(input._data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] = (fabsf(other[x]) > 1e-6f) ? data[x] / other[x] : 0.0f;
+  });
 
   return *this;
 }
 
 ///////////////////////////////////////////////////////////////////////
+// run "function" over the cells in blocks, for evaluating expressions
 ///////////////////////////////////////////////////////////////////////
-FIELD_2D operator*(const FIELD_2D& A, const float alpha)
-{
-  FIELD_2D final(A);
-  final *= alpha;
-  return final;
-}
-
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-FIELD_2D operator/(const FIELD_2D& A, const float alpha)
-{
-  FIELD_2D final(A);
-  final /= alpha;
-  return final;
-}
-
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-FIELD_2D operator+(const FIELD_2D& A, const FIELD_2D& B)
-{
-  FIELD_2D final(A);
-  final += B;
-  return final;
-}
-
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-FIELD_2D operator-(const FIELD_2D& A, const FIELD_2D& B)
+void FIELD_2D::forEachCellBlock(int totalCells, const std::function<void(int, int)>& function)
 {
-  FIELD_2D final(A);
-  final -= B;
-  return final;
+  forEachBlock(totalCells, totalBlocks(totalCells), [&](int block, int begin, int end) {
+    function(begin, end);
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
-FIELD_2D operator+(const FIELD_2D& A, const float alpha)
+FIELD_2D& FIELD_2D::operator=(const FIELD_2D& A)
 {
-  FIELD_2D final(A);
-  final += alpha;
-  return final;
-}
+  if (this == &A)
+    return *this;
 
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-FIELD_2D operator*(const float alpha, const FIELD_2D& A)
-{
-  return A * alpha;
-}
+  resize(A.xRes(), A.yRes());
+  if (_totalCells > 0)
+    memcpy(_data, A._data, _totalCells * sizeof(float));
 
-///////////////////////////////////////////////////////////////////////
-///////////////////////////////////////////////////////////////////////
-FIELD_2D operator+(const float alpha, const FIELD_2D& A)
-{
-  return A + alpha;
+  return *this;
 }
 
 ///////////////////////////////////////////////////////////////////////
+// take over A's cells, and give it ours to free
 ///////////////////////////////////////////////////////////////////////
-FIELD_2D& FIELD_2D::operator=(const FIELD_2D& A)
+FIELD_2D& FIELD_2D::operator=(FIELD_2D&& A)
 {
-  resizeAndWipe(A.xRes(), A.yRes());
-
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = A[x];
+  std::swap(_xRes, A._xRes);
+  std::swap(_yRes, A._yRes);
+  std::swap(_totalCells, A._totalCells);
+  std::swap(_capacity, A._capacity);
+  std::swap(_data, A._data);
 
   return *this;
 }
 
 ///////////////////////////////////////////////////////////////////////
-// sum of all entries
+// sum of all entries, accumulated pairwise in double
 ///////////////////////////////////////////////////////////////////////
 float FIELD_2D::sum()
 {
-  float total = 0;
-  for (int x = 0; x < _totalCells; x++)
-    total += _data[x];
+  const int blocks = totalBlocks(_totalCells);
+  std::vector<double> totals(blocks, 0.0);
+  forEachBlock(_totalCells, blocks, [&](int block, int begin, int end) {
+    totals[block] = pairwiseSum(_data + begin, end - begin);
+  });
 
+  double total = 0;
+  for (int x = 0; x < blocks; x++)
+    total += totals[x];
   return total;
 }
 
@@ -633,9 +842,12 @@ float FIELD_2D::sum()
 ///////////////////////////////////////////////////////////////////////
 void FIELD_2D::log(float base)
 {
-  float scale = 1.0 / std::log(base);
-  for (int x = 0; x < _totalCells; x++)
-    _data[x] = std::log(_data[x]) * scale;
+  const float scale = 1.0 / std::log(base);
+  forEachBlock(_totalCells, totalBlocks(_totalCells), [&](int block, int begin, int end) {
+    float* RESTRICT data = ASSUME_ALIGNED(_data + begin);
+    for (int x = 0; x < end - begin; x++)
+      data[x] = logf(data[x]) * scale;
+  });
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -645,12 +857,9 @@ float FIELD_2D::min()
 {
   assert(_xRes > 0);
   assert(_yRes > 0);
-  float final = _data[0];
-
-  for (int i = 0; i < _xRes * _yRes; i++)
-    final = (_data[i] < final) ? _data[i] : final;
-
-  return final;
+  float minFound, maxFound;
+  minMaxField(_data, _totalCells, minFound, maxFound);
+  return minFound;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -660,12 +869,9 @@ float FIELD_2D::max()
 {
   assert(_xRes > 0);
   assert(_yRes > 0);
-  float final = _data[0];
-
-  for (int i = 0; i < _xRes * _yRes; i++)
-    final = (_data[i] > final) ? _data[i] : final;
-
-  return final;
+  float minFound, maxFound;
+  minMaxField(_data, _totalCells, minFound, maxFound);
+  return maxFound;
 }
 
 ///////////////////////////////////////////////////////////////////////
@@ -2,17 +2,39 @@
 #define FIELD_2D_H
 
 #include <cmath>
+#include <cstdio>
+#include <cassert>
 #include <string>
 #include <iostream>
+#include <functional>
 #include <VEC3F.h>
+#include "PNG_FILE.h"
 
 using namespace std;
 
-class FIELD_2D {
+///////////////////////////////////////////////////////////////////////
+// Field arithmetic is lazy: "A + B * 2.0" builds a small tree of
+// expressions instead of a temporary field per operator, and nothing is
+// computed until the tree is assigned to a FIELD_2D, which then
+// evaluates it in a single pass over the cells.
+//
+// An expression only points at the fields it was built from, so don't
+// hang on to one with "auto"; assign it to a FIELD_2D.
+///////////////////////////////////////////////////////////////////////
+template <class EXPRESSION>
+class FIELD_EXPRESSION {
+public:
+  const EXPRESSION& self() const { return static_cast<const EXPRESSION&>(*this); };
+};
+
+class FIELD_2D : public FIELD_EXPRESSION<FIELD_2D> {
 public:
   FIELD_2D();
   FIELD_2D(const int& rows, const int& cols);
   FIELD_2D(const FIELD_2D& m);
+  FIELD_2D(FIELD_2D&& m);
+  template <class EXPRESSION>
+  FIELD_2D(const FIELD_EXPRESSION<EXPRESSION>& expression);
   ~FIELD_2D();
 
   // accessors
@@ -20,12 +42,15 @@ public:
   const float operator()(int x, int y) const { return _data[y * _xRes + x]; };
   inline float& operator[](int x) { return _data[x]; };
   const float operator[](int x) const { return _data[x]; };
+  // the cells start on a 64 byte boundary, row after row
   float* data() { return _data; };
+  const float* data() const { return _data; };
   const int xRes() const { return _xRes; };
   const int yRes() const { return _yRes; };
   const int totalCells() const { return _totalCells; };
 
-  // common field operations
+  // common field operations; these vectorize, and split fields of a
+  // million cells or more across one thread per core
   void clear();
   void normalize();
   FIELD_2D& abs();
@@ -38,20 +63,28 @@ public:
  
   // generic IO functions
   void writeMatlab(string filename, string variableName) const;
-  void write(string filename) const;
-  void read(string filename);
+  // see FIELD_2D_FILE.h for the format; both return false and say why
+  // if anything goes wrong
+  bool write(string filename, bool compress = false) const;
+  bool read(string filename);
 
   // some image file support
   void writePPM(string filename);
   void writeJPG(string filename);
-  void writePNG(string filename);
-  void readPNG(string filename);
+  // PNGs stream a row at a time; both return false if anything fails
+  bool writePNG(string filename, const PNG_SETTINGS& settings = PNG_SETTINGS()) const;
+  bool readPNG(string filename);
 
+  // zero the field at the new size; shrinking keeps the old storage
   void resizeAndWipe(int xRes, int yRes);
 
+  // how many cells fit before the field has to go back to the heap
+  const int capacity() const { return _capacity; };
+
   // overloaded operators
   FIELD_2D& operator=(const float& alpha);
   FIELD_2D& operator=(const FIELD_2D& A);
+  FIELD_2D& operator=(FIELD_2D&& A);
   FIELD_2D& operator*=(const float& alpha);
   FIELD_2D& operator/=(const float& alpha);
   FIELD_2D& operator+=(const float& alpha);
@@ -60,25 +93,212 @@ public:
   FIELD_2D& operator*=(const FIELD_2D& input);
   FIELD_2D& operator/=(const FIELD_2D& input);
 
-  // sum of all entries
+  // evaluate an expression straight into the cells
+  template <class EXPRESSION>
+  FIELD_2D& operator=(const FIELD_EXPRESSION<EXPRESSION>& expression);
+  template <class EXPRESSION>
+  FIELD_2D& operator+=(const FIELD_EXPRESSION<EXPRESSION>& expression);
+  template <class EXPRESSION>
+  FIELD_2D& operator-=(const FIELD_EXPRESSION<EXPRESSION>& expression);
+
+  // sum of all entries, accumulated pairwise in double so large fields
+  // don't drift
   float sum();
   
   // set to a checkboard for debugging
   void setToCheckerboard(int xChecks = 10, int yChecks = 10);
   
 private:
+  // resizeAndWipe without the wipe, for when every cell is about to be
+  // overwritten anyway
+  void resize(int xRes, int yRes);
+
+  // the headerless format "write" used to produce
+  bool readLegacy(FILE* file, string& error);
+
+  // run function(begin, end) over blocks of [0, totalCells), on threads
+  // when there are enough cells to be worth it
+  static void forEachCellBlock(int totalCells, const std::function<void(int, int)>& function);
+
   int _xRes;
   int _yRes;
   int _totalCells;
+  int _capacity;
   float* _data;
 };
 
-FIELD_2D operator*(const FIELD_2D& A, const float alpha);
-FIELD_2D operator/(const FIELD_2D& A, const float alpha);
-FIELD_2D operator+(const FIELD_2D& A, const float alpha);
-FIELD_2D operator*(const float alpha, const FIELD_2D& A);
-FIELD_2D operator+(const float alpha, const FIELD_2D& A);
-FIELD_2D operator-(const FIELD_2D& A, const FIELD_2D& B);
-FIELD_2D operator+(const FIELD_2D& A, const FIELD_2D& B);
+///////////////////////////////////////////////////////////////////////
+// what an expression keeps of a FIELD_2D: where its cells are
+///////////////////////////////////////////////////////////////////////
+class FIELD_LEAF : public FIELD_EXPRESSION<FIELD_LEAF> {
+public:
+  FIELD_LEAF(const FIELD_2D& field) :
+    _data(field.data()), _xRes(field.xRes()), _yRes(field.yRes())
+  {
+  };
+
+  float operator[](int x) const { return _data[x]; };
+  int xRes() const { return _xRes; };
+  int yRes() const { return _yRes; };
+
+private:
+  const float* _data;
+  int _xRes;
+  int _yRes;
+};
+
+// fields are held as leaves, everything else by value
+template <class EXPRESSION>
+struct FIELD_OPERAND { typedef EXPRESSION type; };
+template <>
+struct FIELD_OPERAND<FIELD_2D> { typedef FIELD_LEAF type; };
+
+// what to do with each pair of cells
+struct FIELD_ADD { static float apply(float left, float right) { return left + right; }; };
+struct FIELD_SUBTRACT { static float apply(float left, float right) { return left - right; }; };
+struct FIELD_MULTIPLY { static float apply(float left, float right) { return left * right; }; };
+struct FIELD_DIVIDE { static float apply(float left, float right) { return left / right; }; };
+
+///////////////////////////////////////////////////////////////////////
+// two same sized fields combined cell by cell
+///////////////////////////////////////////////////////////////////////
+template <class LEFT, class RIGHT, class OPERATION>
+class FIELD_BINARY : public FIELD_EXPRESSION<FIELD_BINARY<LEFT, RIGHT, OPERATION> > {
+public:
+  FIELD_BINARY(const LEFT& left, const RIGHT& right) :
+    _left(left), _right(right)
+  {
+    assert(_left.xRes() == _right.xRes());
+    assert(_left.yRes() == _right.yRes());
+  };
+
+  float operator[](int x) const { return OPERATION::apply(_left[x], _right[x]); };
+  int xRes() const { return _left.xRes(); };
+  int yRes() const { return _left.yRes(); };
+
+private:
+  typename FIELD_OPERAND<LEFT>::type _left;
+  typename FIELD_OPERAND<RIGHT>::type _right;
+};
+
+///////////////////////////////////////////////////////////////////////
+// a field combined with the same scalar in every cell
+///////////////////////////////////////////////////////////////////////
+template <class FIELD, class OPERATION>
+class FIELD_SCALAR : public FIELD_EXPRESSION<FIELD_SCALAR<FIELD, OPERATION> > {
+public:
+  FIELD_SCALAR(const FIELD& field, float alpha) :
+    _field(field), _alpha(alpha)
+  {
+  };
+
+  float operator[](int x) const { return OPERATION::apply(_field[x], _alpha); };
+  int xRes() const { return _field.xRes(); };
+  int yRes() const { return _field.yRes(); };
+
+private:
+  typename FIELD_OPERAND<FIELD>::type _field;
+  float _alpha;
+};
+
+template <class LEFT, class RIGHT>
+FIELD_BINARY<LEFT, RIGHT, FIELD_ADD> operator+(const FIELD_EXPRESSION<LEFT>& A, const FIELD_EXPRESSION<RIGHT>& B)
+{
+  return FIELD_BINARY<LEFT, RIGHT, FIELD_ADD>(A.self(), B.self());
+}
+
+template <class LEFT, class RIGHT>
+FIELD_BINARY<LEFT, RIGHT, FIELD_SUBTRACT> operator-(const FIELD_EXPRESSION<LEFT>& A, const FIELD_EXPRESSION<RIGHT>& B)
+{
+  return FIELD_BINARY<LEFT, RIGHT, FIELD_SUBTRACT>(A.self(), B.self());
+}
+
+template <class FIELD>
+FIELD_SCALAR<FIELD, FIELD_MULTIPLY> operator*(const FIELD_EXPRESSION<FIELD>& A, const float alpha)
+{
+  return FIELD_SCALAR<FIELD, FIELD_MULTIPLY>(A.self(), alpha);
+}
+
+template <class FIELD>
+FIELD_SCALAR<FIELD, FIELD_MULTIPLY> operator*(const float alpha, const FIELD_EXPRESSION<FIELD>& A)
+{
+  return FIELD_SCALAR<FIELD, FIELD_MULTIPLY>(A.self(), alpha);
+}
+
+template <class FIELD>
+FIELD_SCALAR<FIELD, FIELD_DIVIDE> operator/(const FIELD_EXPRESSION<FIELD>& A, const float alpha)
+{
+  return FIELD_SCALAR<FIELD, FIELD_DIVIDE>(A.self(), alpha);
+}
+
+template <class FIELD>
+FIELD_SCALAR<FIELD, FIELD_ADD> operator+(const FIELD_EXPRESSION<FIELD>& A, const float alpha)
+{
+  return FIELD_SCALAR<FIELD, FIELD_ADD>(A.self(), alpha);
+}
+
+template <class FIELD>
+FIELD_SCALAR<FIELD, FIELD_ADD> operator+(const float alpha, const FIELD_EXPRESSION<FIELD>& A)
+{
+  return FIELD_SCALAR<FIELD, FIELD_ADD>(A.self(), alpha);
+}
+
+///////////////////////////////////////////////////////////////////////
+// evaluating expressions
+///////////////////////////////////////////////////////////////////////
+template <class EXPRESSION>
+FIELD_2D::FIELD_2D(const FIELD_EXPRESSION<EXPRESSION>& expression) :
+  _xRes(0), _yRes(0), _totalCells(0), _capacity(0), _data(NULL)
+{
+  *this = expression;
+}
+
+// every cell only reads the same cell of its operands, so the
+// expression is free to mention this field too
+template <class EXPRESSION>
+FIELD_2D& FIELD_2D::operator=(const FIELD_EXPRESSION<EXPRESSION>& input)
+{
+  // a local copy, so the compiler knows writing the cells can't move them
+  const typename FIELD_OPERAND<EXPRESSION>::type expression(input.self());
+  if (expression.xRes() != _xRes || expression.yRes() != _yRes)
+    resize(expression.xRes(), expression.yRes());
+
+  float* data = _data;
+  forEachCellBlock(_totalCells, [&expression, data](int begin, int end) {
+    for (int x = begin; x < end; x++)
+      data[x] = expression[x];
+  });
+  return *this;
+}
+
+template <class EXPRESSION>
+FIELD_2D& FIELD_2D::operator+=(const FIELD_EXPRESSION<EXPRESSION>& input)
+{
+  const typename FIELD_OPERAND<EXPRESSION>::type expression(input.self());
+  assert(expression.xRes() == _xRes);
+  assert(expression.yRes() == _yRes);
+
+  float* data = _data;
+  forEachCellBlock(_totalCells, [&expression, data](int begin, int end) {
+    for (int x = begin; x < end; x++)
+      data[x] += expression[x];
+  });
+  return *this;
+}
+
+template <class EXPRESSION>
+FIELD_2D& FIELD_2D::operator-=(const FIELD_EXPRESSION<EXPRESSION>& input)
+{
+  const typename FIELD_OPERAND<EXPRESSION>::type expression(input.self());
+  assert(expression.xRes() == _xRes);
+  assert(expression.yRes() == _yRes);
+
+  float* data = _data;
+  forEachCellBlock(_totalCells, [&expression, data](int begin, int end) {
+    for (int x = begin; x < end; x++)
+      data[x] -= expression[x];
+  });
+  return *this;
+}
 
 #endif
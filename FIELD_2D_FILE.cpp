@@ -0,0 +1,440 @@
+#include "FIELD_2D_FILE.h"
+#include <zlib.h>
+#include <cstring>
+#include <algorithm>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// how much goes through zlib, and through the file, at a time
+static const size_t chunkBytes = 1 << 20;
+
+static const char fieldMagic[4] = {'F', 'L', 'D', '2'};
+
+static_assert(sizeof(FIELD_FILE_HEADER) == 64, "the header should keep the cells 64 byte aligned");
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool readFieldHeader(FILE* file, FIELD_FILE_HEADER& header, bool& versioned, std::string& error)
+{
+  versioned = false;
+  memset(&header, 0, sizeof(header));
+
+  char magic[4];
+  if (fread(magic, 1, 4, file) != 4)
+  {
+    error = "file is too short to be a field";
+    return false;
+  }
+
+  // the old format starts straight in with the dimensions
+  if (memcmp(magic, fieldMagic, 4) != 0)
+  {
+    fseek(file, 0, SEEK_SET);
+    return true;
+  }
+  versioned = true;
+
+  memcpy(header.magic, magic, 4);
+  if (fread((char*)&header + 4, sizeof(header) - 4, 1, file) != 1)
+  {
+    error = "truncated field header";
+    return false;
+  }
+  if (header.version != FIELD_FILE_VERSION)
+  {
+    error = "unsupported field file version " + std::to_string(header.version);
+    return false;
+  }
+  if (header.cellType != FIELD_CELL_FLOAT32 && header.cellType != FIELD_CELL_BIT)
+  {
+    error = "unsupported cell type " + std::to_string(header.cellType);
+    return false;
+  }
+  if (header.compression != FIELD_COMPRESSION_NONE && header.compression != FIELD_COMPRESSION_ZLIB)
+  {
+    error = "unsupported compression " + std::to_string(header.compression);
+    return false;
+  }
+  if (header.xRes < 0 || header.yRes < 0)
+  {
+    error = "bad field dimensions";
+    return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+uint64_t fieldCellBytes(const FIELD_FILE_HEADER& header)
+{
+  if (header.cellType == FIELD_CELL_BIT)
+    return ((uint64_t)header.xRes + 7) / 8 * header.yRes;
+  return (uint64_t)header.xRes * header.yRes * sizeof(float);
+}
+
+///////////////////////////////////////////////////////////////////////
+// raw bytes go straight into place; compressed ones are inflated
+// straight into place a chunk of input at a time
+///////////////////////////////////////////////////////////////////////
+static bool readPayload(FILE* file, const FIELD_FILE_HEADER& header, void* cells, size_t bytes, std::string& error)
+{
+  if (header.compression == FIELD_COMPRESSION_NONE)
+  {
+    if (header.payloadBytes < bytes || fread(cells, 1, bytes, file) != bytes)
+    {
+      error = "truncated field cells";
+      return false;
+    }
+    return true;
+  }
+
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  if (inflateInit(&stream) != Z_OK)
+  {
+    error = "couldn't start zlib";
+    return false;
+  }
+
+  std::vector<unsigned char> input(chunkBytes);
+  unsigned char* output = (unsigned char*)cells;
+  size_t outputLeft = bytes;
+  uint64_t payloadLeft = header.payloadBytes;
+  int status = Z_OK;
+  while (status != Z_STREAM_END)
+  {
+    if (stream.avail_in == 0)
+    {
+      const size_t want = (size_t)std::min<uint64_t>(chunkBytes, payloadLeft);
+      const size_t got = (want > 0) ? fread(&input[0], 1, want, file) : 0;
+      if (got == 0)
+        break;
+      payloadLeft -= got;
+      stream.next_in = &input[0];
+      stream.avail_in = got;
+    }
+
+    const uInt step = (uInt)std::min<size_t>(outputLeft, 1 << 30);
+    stream.next_out = output;
+    stream.avail_out = step;
+    status = inflate(&stream, Z_NO_FLUSH);
+    output += step - stream.avail_out;
+    outputLeft -= step - stream.avail_out;
+
+    // includes running out of room for more cells than the header said
+    if (status != Z_OK && status != Z_STREAM_END)
+      break;
+  }
+  inflateEnd(&stream);
+
+  if (status != Z_STREAM_END || outputLeft != 0)
+  {
+    error = "corrupt or truncated compressed cells";
+    return false;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// bit cells are read packed, then spread out into the floats
+///////////////////////////////////////////////////////////////////////
+bool readFieldCells(FILE* file, const FIELD_FILE_HEADER& header, float* cells, size_t totalCells, std::string& error)
+{
+  if (header.cellType != FIELD_CELL_BIT)
+    return readPayload(file, header, cells, totalCells * sizeof(float), error);
+
+  const size_t xRes = header.xRes;
+  const size_t rowBytes = (xRes + 7) / 8;
+  if (totalCells != xRes * header.yRes)
+  {
+    error = "bit cells only come a whole field at a time";
+    return false;
+  }
+  std::vector<unsigned char> bits(rowBytes * header.yRes);
+  if (!bits.empty() && !readPayload(file, header, &bits[0], bits.size(), error))
+    return false;
+
+  for (size_t y = 0; y < (size_t)header.yRes; y++)
+  {
+    const unsigned char* row = &bits[y * rowBytes];
+    float* cellRow = cells + y * xRes;
+    for (size_t x = 0; x < xRes; x++)
+      cellRow[x] = (row[x >> 3] & (0x80 >> (x & 7))) ? 1.0f : 0.0f;
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+FIELD_2D_WRITER::FIELD_2D_WRITER() :
+  _file(NULL), _stream(NULL), _rowsWritten(0)
+{
+  memset(&_header, 0, sizeof(_header));
+}
+
+FIELD_2D_WRITER::~FIELD_2D_WRITER()
+{
+  if (_stream)
+  {
+    deflateEnd(_stream);
+    delete _stream;
+  }
+  if (_file)
+    fclose(_file);
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::fail(const std::string& error)
+{
+  if (_error.empty())
+    _error = error;
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+// the header goes out now with no payload size, and gets rewritten
+// once we know it
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::open(const std::string& filename, int xRes, int yRes, bool compress, int level,
+                           uint32_t cellType)
+{
+  _filename = filename;
+  _error.clear();
+  _rowsWritten = 0;
+
+  memset(&_header, 0, sizeof(_header));
+  memcpy(_header.magic, fieldMagic, 4);
+  _header.version = FIELD_FILE_VERSION;
+  _header.xRes = xRes;
+  _header.yRes = yRes;
+  _header.cellType = cellType;
+  _header.compression = compress ? FIELD_COMPRESSION_ZLIB : FIELD_COMPRESSION_NONE;
+
+  if (cellType != FIELD_CELL_FLOAT32 && cellType != FIELD_CELL_BIT)
+    return fail("unsupported cell type " + std::to_string(cellType));
+  if (xRes < 0 || yRes < 0)
+    return fail("bad field dimensions");
+
+  _file = fopen(filename.c_str(), "wb");
+  if (_file == NULL)
+    return fail("couldn't open " + filename + " for writing");
+  if (fwrite(&_header, sizeof(_header), 1, _file) != 1)
+    return fail("couldn't write the header of " + filename);
+
+  if (compress)
+  {
+    _stream = new z_stream;
+    memset(_stream, 0, sizeof(z_stream));
+    if (deflateInit(_stream, level) != Z_OK)
+      return fail("couldn't start zlib");
+    _buffer.resize(chunkBytes);
+  }
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::writeRows(const float* rows, int totalRows)
+{
+  if (_file == NULL || !_error.empty())
+    return fail("field file isn't open");
+  if (_header.cellType != FIELD_CELL_FLOAT32)
+    return fail("float rows written to a bit field");
+  if (_rowsWritten + totalRows > _header.yRes)
+    return fail("more rows than the field has");
+
+  _rowsWritten += totalRows;
+  return writePayload(rows, (size_t)totalRows * _header.xRes * sizeof(float), false);
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::writeBitRows(const unsigned char* rows, int totalRows)
+{
+  if (_file == NULL || !_error.empty())
+    return fail("field file isn't open");
+  if (_header.cellType != FIELD_CELL_BIT)
+    return fail("bit rows written to a float field");
+  if (_rowsWritten + totalRows > _header.yRes)
+    return fail("more rows than the field has");
+
+  _rowsWritten += totalRows;
+  return writePayload(rows, (size_t)totalRows * (((size_t)_header.xRes + 7) / 8), false);
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::writePayload(const void* bytes, size_t size, bool finish)
+{
+  if (_stream == NULL)
+  {
+    if (size > 0 && fwrite(bytes, 1, size, _file) != size)
+      return fail("couldn't write to " + _filename);
+    _header.payloadBytes += size;
+    return true;
+  }
+
+  const unsigned char* input = (const unsigned char*)bytes;
+  do
+  {
+    // zlib counts in 32 bits
+    const uInt step = (uInt)std::min<size_t>(size, 1 << 30);
+    _stream->next_in = (Bytef*)input;
+    _stream->avail_in = step;
+    input += step;
+    size -= step;
+
+    const int flush = (finish && size == 0) ? Z_FINISH : Z_NO_FLUSH;
+    int status;
+    do
+    {
+      _stream->next_out = &_buffer[0];
+      _stream->avail_out = _buffer.size();
+      status = deflate(_stream, flush);
+      if (status == Z_STREAM_ERROR)
+        return fail("zlib failed");
+
+      const size_t produced = _buffer.size() - _stream->avail_out;
+      if (produced > 0 && fwrite(&_buffer[0], 1, produced, _file) != produced)
+        return fail("couldn't write to " + _filename);
+      _header.payloadBytes += produced;
+    } while (_stream->avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+  } while (size > 0);
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool FIELD_2D_WRITER::close()
+{
+  if (_file == NULL)
+    return fail("field file isn't open");
+
+  if (_error.empty() && _rowsWritten != _header.yRes)
+    fail("only " + std::to_string(_rowsWritten) + " of " + std::to_string(_header.yRes) + " rows were written");
+
+  if (_stream)
+  {
+    if (_error.empty())
+      writePayload(NULL, 0, true);
+    deflateEnd(_stream);
+    delete _stream;
+    _stream = NULL;
+  }
+
+  if (_error.empty())
+  {
+    if (fseek(_file, 0, SEEK_SET) != 0 || fwrite(&_header, sizeof(_header), 1, _file) != 1)
+      fail("couldn't finish the header of " + _filename);
+  }
+  if (fclose(_file) != 0)
+    fail("couldn't close " + _filename);
+  _file = NULL;
+
+  return _error.empty();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+MAPPED_FIELD_2D::MAPPED_FIELD_2D() :
+  _mapping(NULL), _mappingBytes(0), _data(NULL), _bits(NULL), _rowBytes(0), _xRes(0), _yRes(0), _totalCells(0)
+{
+}
+
+MAPPED_FIELD_2D::~MAPPED_FIELD_2D()
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void MAPPED_FIELD_2D::close()
+{
+#ifndef _WIN32
+  if (_mapping)
+    munmap(_mapping, _mappingBytes);
+#endif
+  _mapping = NULL;
+  _mappingBytes = 0;
+  _data = NULL;
+  _bits = NULL;
+  _rowBytes = 0;
+  _xRes = _yRes = 0;
+  _totalCells = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// check the header with stdio, then map the whole file; the cells
+// start right after the header
+///////////////////////////////////////////////////////////////////////
+bool MAPPED_FIELD_2D::open(const std::string& filename)
+{
+  close();
+  _error.clear();
+
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL)
+  {
+    _error = "couldn't open " + filename;
+    return false;
+  }
+
+  FIELD_FILE_HEADER header;
+  bool versioned;
+  bool valid = readFieldHeader(file, header, versioned, _error);
+  if (valid && !versioned)
+  {
+    _error = filename + " is in the old format, which can't be mapped";
+    valid = false;
+  }
+  if (valid && header.compression != FIELD_COMPRESSION_NONE)
+  {
+    _error = filename + " is compressed, which can't be mapped";
+    valid = false;
+  }
+
+  const size_t cellBytes = fieldCellBytes(header);
+  if (valid && header.payloadBytes < cellBytes)
+  {
+    _error = filename + " is truncated";
+    valid = false;
+  }
+  if (!valid)
+  {
+    fclose(file);
+    return false;
+  }
+
+#ifdef _WIN32
+  fclose(file);
+  _error = "mapping fields isn't supported on this platform";
+  return false;
+#else
+  _mappingBytes = sizeof(FIELD_FILE_HEADER) + cellBytes;
+  _mapping = mmap(NULL, _mappingBytes, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+  fclose(file);
+  if (_mapping == MAP_FAILED)
+  {
+    _mapping = NULL;
+    _mappingBytes = 0;
+    _error = "couldn't map " + filename;
+    return false;
+  }
+
+  const char* cells = (const char*)_mapping + sizeof(FIELD_FILE_HEADER);
+  if (header.cellType == FIELD_CELL_BIT)
+  {
+    _bits = (const unsigned char*)cells;
+    _rowBytes = ((size_t)header.xRes + 7) / 8;
+  }
+  else
+    _data = (const float*)cells;
+  _xRes = header.xRes;
+  _yRes = header.yRes;
+  _totalCells = (size_t)_xRes * _yRes;
+  return true;
+#endif
+}
@@ -0,0 +1,156 @@
+#ifndef FIELD_2D_FILE_H
+#define FIELD_2D_FILE_H
+
+///////////////////////////////////////////////////////////////////////
+// The FIELD_2D binary format. A file is a 64 byte header followed by
+// the cells, bottom row first, either raw or as one zlib stream of them:
+//
+//   "FLD2"       magic, which also catches files from the other endian
+//   version      FIELD_FILE_VERSION
+//   xRes, yRes
+//   cellType     FIELD_CELL_FLOAT32 or FIELD_CELL_BIT
+//   compression  FIELD_COMPRESSION_NONE or FIELD_COMPRESSION_ZLIB
+//   payload      bytes of cells after the header
+//
+// Float cells are native floats. Bit cells are for masks: each row is
+// packed into (xRes + 7) / 8 bytes, high bit first, with 1 for a cell
+// of 1, and reading them gives back 0s and 1s. An uncompressed 65536 x
+// 65536 mask is 512 MB that way, small enough to map.
+//
+// The header size keeps raw cells 64 byte aligned in a mapped file.
+// Cell counts are 64 bit, so a file can have more cells than a FIELD_2D
+// can hold, which FIELD_2D::read turns down; MAPPED_FIELD_2D reads any
+// size. FIELD_2D::read still takes the old headerless
+// dimensions-then-doubles files.
+//
+// FIELD_2D_WRITER streams a field out a band of rows at a time, so a
+// field never has to be in memory all at once to be written, and
+// MAPPED_FIELD_2D maps an uncompressed file read-only without copying
+// it anywhere. Nothing in here exits on a bad file; the calls return
+// false and error() says why.
+///////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "FIELD_2D.h"
+
+enum { FIELD_FILE_VERSION = 1 };
+enum { FIELD_CELL_FLOAT32 = 1, FIELD_CELL_BIT = 2 };
+enum { FIELD_COMPRESSION_NONE = 0, FIELD_COMPRESSION_ZLIB = 1 };
+
+struct FIELD_FILE_HEADER {
+  char magic[4];
+  uint32_t version;
+  int32_t xRes;
+  int32_t yRes;
+  uint32_t cellType;
+  uint32_t compression;
+  uint64_t payloadBytes;
+  uint8_t reserved[32];
+};
+
+// is this the start of a versioned file? If it has the magic but isn't
+// something we can read, returns false and says why in "error"
+bool readFieldHeader(FILE* file, FIELD_FILE_HEADER& header, bool& versioned, std::string& error);
+
+// bytes of payload an uncompressed file's cells take up
+uint64_t fieldCellBytes(const FIELD_FILE_HEADER& header);
+
+// read "totalCells" cells of a file whose header has already been read,
+// unpacking bit cells into 0s and 1s
+bool readFieldCells(FILE* file, const FIELD_FILE_HEADER& header, float* cells, size_t totalCells, std::string& error);
+
+// opaque zlib state, so this header doesn't drag in zlib.h
+struct z_stream_s;
+
+class FIELD_2D_WRITER {
+public:
+  FIELD_2D_WRITER();
+  ~FIELD_2D_WRITER();
+
+  // start an xRes x yRes field of "cellType" cells; "compress" runs
+  // the cells through zlib at "level" (1 fastest to 9 smallest)
+  bool open(const std::string& filename, int xRes, int yRes, bool compress = false, int level = 6,
+            uint32_t cellType = FIELD_CELL_FLOAT32);
+
+  // append the next "totalRows" rows, bottom row first
+  bool writeRows(const float* rows, int totalRows);
+
+  // the same for a bit field, with rows already packed the way the file
+  // wants them
+  bool writeBitRows(const unsigned char* rows, int totalRows);
+
+  // finish the stream and fill in the header; false if the field wasn't
+  // complete or anything failed along the way
+  bool close();
+
+  const std::string& error() const { return _error; };
+
+private:
+  // push "bytes" through the compressor, or straight out
+  bool writePayload(const void* bytes, size_t size, bool finish);
+  bool fail(const std::string& error);
+
+  FILE* _file;
+  z_stream_s* _stream;
+  std::vector<unsigned char> _buffer;
+  std::string _filename;
+  std::string _error;
+  FIELD_FILE_HEADER _header;
+  int _rowsWritten;
+
+  FIELD_2D_WRITER(const FIELD_2D_WRITER&);
+  FIELD_2D_WRITER& operator=(const FIELD_2D_WRITER&);
+};
+
+class MAPPED_FIELD_2D {
+public:
+  MAPPED_FIELD_2D();
+  ~MAPPED_FIELD_2D();
+
+  // map an uncompressed field file, of either cell type
+  bool open(const std::string& filename);
+  void close();
+
+  // accessors, the same as FIELD_2D's const ones, but with 64 bit cell
+  // indices; bit cells come back as 0 or 1
+  const float operator()(int x, int y) const
+  {
+    return _bits ? bit(x, y) : _data[(size_t)y * _xRes + x];
+  };
+  const float operator[](size_t x) const { return _bits ? bit(x % _xRes, x / _xRes) : _data[x]; };
+  const int xRes() const { return _xRes; };
+  const int yRes() const { return _yRes; };
+  const size_t totalCells() const { return _totalCells; };
+
+  // the raw cells; data() is NULL for a bit field and bits() for a
+  // float one, and a bit field's rows are rowBytes() apart
+  const float* data() const { return _data; };
+  const unsigned char* bits() const { return _bits; };
+  const size_t rowBytes() const { return _rowBytes; };
+
+  const std::string& error() const { return _error; };
+
+private:
+  float bit(size_t x, size_t y) const
+  {
+    return (_bits[y * _rowBytes + (x >> 3)] & (0x80 >> (x & 7))) ? 1.0f : 0.0f;
+  };
+
+  void* _mapping;
+  size_t _mappingBytes;
+  const float* _data;
+  const unsigned char* _bits;
+  size_t _rowBytes;
+  int _xRes;
+  int _yRes;
+  size_t _totalCells;
+  std::string _error;
+
+  MAPPED_FIELD_2D(const MAPPED_FIELD_2D&);
+  MAPPED_FIELD_2D& operator=(const MAPPED_FIELD_2D&);
+};
+
+#endif
@@ -0,0 +1,245 @@
+#include "GIGAPIXEL_RENDERER.h"
+#include "JULIA_RENDERER.h"
+#include "FIELD_2D_FILE.h"
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// one band of packed rows, in the order the file wants them, and what
+// was summed over it
+struct BAND {
+  BAND() : done(false), inside(0), xSum(0), ySum(0), iterations(0), rechecked(0) {};
+
+  vector<unsigned char> bits; // rowBytes per row, high bit first, 1 where the point didn't escape
+  bool done; // rendered, and not written yet
+  long long inside;
+  long long xSum; // the columns and mask rows of the inside pixels
+  long long ySum;
+  long long iterations;
+  long long rechecked;
+};
+
+///////////////////////////////////////////////////////////////////////
+// iterate one pixel the way renderImage would
+///////////////////////////////////////////////////////////////////////
+static inline int iterateGigapixel(const GIGAPIXEL_SETTINGS& settings, const VEC3F& center,
+                                   const vector<VEC3F>& roots, long long& iterations, long long& rechecked)
+{
+  if (!settings.mixedPrecision)
+  {
+    const int totalIterations = iterateRoots(center, roots, settings.maxIterations, settings.escapeRadius);
+    iterations += totalIterations;
+    return totalIterations;
+  }
+
+  bool nearThreshold;
+  const int totalIterations = iterateRootsFlagged(center, roots, settings.maxIterations, settings.escapeRadius,
+                                                  nearThreshold);
+  iterations += totalIterations;
+  if (!nearThreshold)
+    return totalIterations;
+
+  const int checkedIterations = iterateRootsDouble(center, roots, settings.maxIterations, settings.escapeRadius);
+  iterations += checkedIterations;
+  rechecked++;
+  return checkedIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// file row r is mask row r of a FIELD_2D file, and mask row
+// yRes - 1 - r of a PNG
+///////////////////////////////////////////////////////////////////////
+static void renderBand(const GIGAPIXEL_SETTINGS& settings, const vector<VEC3F>& roots, int index, BAND& band)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  const int rowBytes = (xRes + 7) / 8;
+  const int firstRow = index * settings.bandRows;
+  const int totalRows = min(settings.bandRows, yRes - firstRow);
+
+  // the same centers as renderImage's first pass
+  const float dx = 4.0f / xRes;
+  const float dy = 4.0f / yRes;
+
+  band.inside = band.xSum = band.ySum = band.iterations = band.rechecked = 0;
+  memset(&band.bits[0], 0, (size_t)totalRows * rowBytes);
+  for (int r = 0; r < totalRows; r++)
+  {
+    const int y = (settings.format == GIGAPIXEL_SETTINGS::GIGAPIXEL_PNG) ? yRes - 1 - (firstRow + r) : firstRow + r;
+    unsigned char* row = &band.bits[(size_t)r * rowBytes];
+    long long inside = 0;
+
+    VEC3F center;
+    center[1] = -2.0f + y * dy;
+    for (int x = 0; x < xRes; x++)
+    {
+      center[0] = -2.0f + x * dx;
+      if (iterateGigapixel(settings, center, roots, band.iterations, band.rechecked) == settings.maxIterations)
+      {
+        row[x >> 3] |= 0x80 >> (x & 7);
+        inside++;
+        band.xSum += x;
+      }
+    }
+    band.inside += inside;
+    band.ySum += inside * y;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+static long long fileBytes(const string& filename)
+{
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL)
+    return 0;
+  fseek(file, 0, SEEK_END);
+  const long long bytes = ftell(file);
+  fclose(file);
+  return bytes;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Band i goes in slot i % maxBands, and a thread only starts on it once
+// band i - maxBands, the slot's last one, has been written. Bands are
+// handed out in order, so the one the writer waits on is always being
+// rendered.
+///////////////////////////////////////////////////////////////////////
+bool renderGigapixel(const GIGAPIXEL_SETTINGS& settings, const vector<VEC3F>& roots, const string& filename,
+                     GIGAPIXEL_RESULT& result, string& error)
+{
+  result = GIGAPIXEL_RESULT();
+  error.clear();
+
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  if (xRes <= 0 || yRes <= 0 || settings.bandRows <= 0)
+  {
+    error = "the resolution and band size have to be positive";
+    return false;
+  }
+  const bool png = (settings.format == GIGAPIXEL_SETTINGS::GIGAPIXEL_PNG);
+  const int rowBytes = (xRes + 7) / 8;
+  const int totalBands = (yRes + settings.bandRows - 1) / settings.bandRows;
+
+  FIELD_2D_WRITER fieldWriter;
+  PNG_WRITER pngWriter;
+  const bool opened = png ? pngWriter.open(filename, xRes, yRes, 1, 1, settings.png)
+                          : fieldWriter.open(filename, xRes, yRes, false, 0, FIELD_CELL_BIT);
+  if (!opened)
+  {
+    error = png ? pngWriter.error() : fieldWriter.error();
+    return false;
+  }
+
+  int totalThreads = settings.totalThreads;
+  if (totalThreads <= 0)
+    totalThreads = thread::hardware_concurrency();
+  if (totalThreads <= 0)
+    totalThreads = 1;
+  int maxBands = settings.maxBands;
+  if (maxBands <= 0)
+    maxBands = 2 * totalThreads;
+
+  vector<BAND> bands(min(maxBands, totalBands));
+  for (unsigned int x = 0; x < bands.size(); x++)
+    bands[x].bits.resize((size_t)settings.bandRows * rowBytes);
+  const int slots = bands.size();
+
+  mutex bandMutex;
+  condition_variable bandDone;
+  condition_variable slotFree;
+  int nextBand = 0;
+  int written = 0;
+  int inMemory = 0;
+  bool stop = false;
+
+  auto work = [&]()
+  {
+    while (true)
+    {
+      int index;
+      {
+        unique_lock<mutex> lock(bandMutex);
+        if (stop || nextBand == totalBands)
+          return;
+        index = nextBand++;
+        slotFree.wait(lock, [&]() { return stop || index < written + slots; });
+        if (stop)
+          return;
+        inMemory++;
+        result.peakBands = max(result.peakBands, inMemory);
+      }
+
+      renderBand(settings, roots, index, bands[index % slots]);
+
+      {
+        lock_guard<mutex> lock(bandMutex);
+        bands[index % slots].done = true;
+      }
+      bandDone.notify_all();
+    }
+  };
+
+  vector<thread> threads;
+  for (int x = 0; x < totalThreads; x++)
+    threads.push_back(thread(work));
+
+  // write the bands in order as they come in, summing as we go
+  long long xSum = 0;
+  long long ySum = 0;
+  bool failed = false;
+  for (int index = 0; index < totalBands && !failed; index++)
+  {
+    BAND& band = bands[index % slots];
+    {
+      unique_lock<mutex> lock(bandMutex);
+      bandDone.wait(lock, [&]() { return band.done; });
+    }
+
+    // a FIELD_2D bit field packs its rows the same way
+    const int totalRows = min(settings.bandRows, yRes - index * settings.bandRows);
+    if (png)
+      for (int r = 0; r < totalRows && !failed; r++)
+        failed = !pngWriter.writeRow(&band.bits[(size_t)r * rowBytes]);
+    else
+      failed = !fieldWriter.writeBitRows(&band.bits[0], totalRows);
+    result.insidePixels += band.inside;
+    result.iterations += band.iterations;
+    result.rechecked += band.rechecked;
+    xSum += band.xSum;
+    ySum += band.ySum;
+
+    {
+      lock_guard<mutex> lock(bandMutex);
+      band.done = false;
+      written++;
+      inMemory--;
+      stop = failed;
+    }
+    slotFree.notify_all();
+  }
+
+  for (unsigned int x = 0; x < threads.size(); x++)
+    threads[x].join();
+
+  const bool closed = png ? pngWriter.close() : fieldWriter.close();
+  if (failed || !closed)
+  {
+    error = png ? pngWriter.error() : fieldWriter.error();
+    return false;
+  }
+  result.bytes = png ? pngWriter.bytes() : fileBytes(filename);
+
+  const double dx = 4.0 / xRes;
+  const double dy = 4.0 / yRes;
+  result.area = result.insidePixels * dx * dy;
+  if (result.insidePixels > 0)
+    result.centerOfMass = VEC3F(-2.0 + dx * xSum / result.insidePixels, -2.0 + dy * ySum / result.insidePixels, 0.0);
+  return true;
+}
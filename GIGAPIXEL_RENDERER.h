@@ -0,0 +1,82 @@
+#ifndef GIGAPIXEL_RENDERER_H
+#define GIGAPIXEL_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// Renders a mask too big to hold in memory, like 65536 x 65536, straight
+// to disk. renderImage keeps a whole frame as a FIELD_2D and an RGB
+// buffer, which at that size is 64 GB; this never holds more than a
+// few bands of rows.
+//
+// The image is cut into bands of "bandRows" full rows, in the order the
+// file wants them. One thread per core takes the next band, iterates it
+// with the same pixel centers renderImage uses over its X[-2, 2] Y[-2, 2]
+// window, and packs it 8 pixels to a byte. The calling thread writes
+// the bands out in order as they finish, and a thread that gets more
+// than "maxBands" ahead of it waits, so memory stays at maxBands bands
+// however big the image is.
+//
+// The mask goes out as either
+//
+//   - an uncompressed FIELD_2D bit field (see FIELD_2D_FILE.h), bottom
+//     row first, with 1 where the point didn't escape, the same as
+//     renderImage's mask. At 65536 x 65536 that's 512 MB, which
+//     MAPPED_FIELD_2D maps back in; or
+//   - a 1 bit PNG, top row first, white where the point didn't escape,
+//     the same as writeMaskPNG's
+//
+// The shape's pixel count and center of mass are summed per band as
+// whole numbers of pixels while it is written, so they are exact at
+// any size. There is no centering: the window is always renderImage's
+// first pass.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include "VEC3F.h"
+#include "PNG_FILE.h"
+
+struct GIGAPIXEL_SETTINGS {
+  GIGAPIXEL_SETTINGS() :
+    xRes(65536), yRes(65536), bandRows(64), maxBands(0), totalThreads(0), maxIterations(100),
+    escapeRadius(200.0), mixedPrecision(false), format(GIGAPIXEL_FIELD)
+  {
+  };
+
+  enum FORMAT { GIGAPIXEL_FIELD, GIGAPIXEL_PNG };
+
+  // the extension that goes with format
+  const char* extension() const { return (format == GIGAPIXEL_PNG) ? "png" : "fld"; };
+
+  int xRes; // resolution of the mask
+  int yRes;
+  int bandRows; // rows a thread renders at once
+  int maxBands; // bands held in memory at once, 0 for two per thread
+  int totalThreads; // 0 is one per core
+  int maxIterations; // the same limits renderImage gets from RENDER_SETTINGS
+  float escapeRadius;
+  bool mixedPrecision; // iterate again in double where float rounding could have decided; see renderImage
+  FORMAT format;
+  PNG_SETTINGS png; // how hard to compress a PNG
+};
+
+struct GIGAPIXEL_RESULT {
+  GIGAPIXEL_RESULT() :
+    insidePixels(0), area(0), iterations(0), rechecked(0), bytes(0), peakBands(0)
+  {
+  };
+
+  long long insidePixels; // pixels that didn't escape
+  double area; // their area, in units of the plane
+  VEC3F centerOfMass; // of those pixels' centers, (0, 0) if there are none
+  long long iterations; // over every pixel
+  long long rechecked; // pixels iterated again in double, with mixedPrecision
+  long long bytes; // size of the file
+  int peakBands; // the most bands that were in memory at once
+};
+
+// render "roots" into "filename"; false if the file couldn't be
+// written, with the reason in "error"
+bool renderGigapixel(const GIGAPIXEL_SETTINGS& settings, const std::vector<VEC3F>& roots, const std::string& filename,
+                     GIGAPIXEL_RESULT& result, std::string& error);
+
+#endif
@@ -0,0 +1,625 @@
+#include "GOLDEN.h"
+#include "JULIA_RENDERER.h"
+#include "SHAPE_COMPARE.h"
+#include "BOUNDARY_RENDERER.h"
+#include "CRITICAL_ORBIT.h"
+#include "BATCH_RENDERER.h"
+#include "GIGAPIXEL_RENDERER.h"
+#include "FIELD_2D_FILE.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+
+// resolution of every golden image; small enough to record and check
+// in a couple of seconds
+static const int goldenRes = 128;
+
+// one configuration to render
+struct GOLDEN_CASE {
+  string name;
+  int centerShape;
+  vector<VEC3F> roots;
+};
+
+// what came out of rendering it
+struct GOLDEN_RESULT {
+  bool shape;
+  int passes;
+  VEC3F centerOfMass;
+  vector<unsigned char> mask; // one byte per pixel, 1 for white
+  vector<unsigned char> rgb; // what renderImage wrote
+};
+
+///////////////////////////////////////////////////////////////////////
+// degree 2 with and without centering, one that is only a sprinkle of
+// white pixels, one with no shape at all, and a few higher degrees
+///////////////////////////////////////////////////////////////////////
+static vector<GOLDEN_CASE> goldenCases()
+{
+  const float configurations[][10] = {
+    // centerShape, # of roots, root positions
+    {0, 2, -0.3, 0.0, 0.3, 0.0},
+    {1, 2, -0.3, 0.0, 0.3, 0.0},
+    {0, 2, -0.25, 0.25, 0.25, -0.25},
+    {0, 2, 0.0, 0.0, 0.3, 0.9},
+    {1, 2, 0.0, 0.0, 0.3, 0.9},
+    {0, 2, 0.0, 0.0, 0.5, 0.5},
+    {0, 2, -2.0, 2.0, 2.0, -2.0},
+    {0, 3, -0.3, 0.0, 0.3, 0.0, 0.0, 0.4},
+    {1, 3, 0.3, 0.3, -0.3, 0.3, 0.0, -0.3},
+    {0, 4, 0.3, 0.0, -0.3, 0.0, 0.0, 0.3, 0.0, -0.3}
+  };
+  const int totalConfigurations = sizeof(configurations) / sizeof(configurations[0]);
+
+  vector<GOLDEN_CASE> cases;
+  for (int x = 0; x < totalConfigurations; x++)
+  {
+    GOLDEN_CASE golden;
+    char name[64];
+    sprintf(name, "case%02i", x);
+    golden.name = name;
+    golden.centerShape = (int)configurations[x][0];
+    const int totalRoots = (int)configurations[x][1];
+    for (int y = 0; y < totalRoots; y++)
+      golden.roots.push_back(VEC3F(configurations[x][2 + 2 * y], configurations[x][3 + 2 * y], 0.0));
+    cases.push_back(golden);
+  }
+  return cases;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+static GOLDEN_RESULT renderCase(const GOLDEN_CASE& golden, RENDER_CONTEXT& context)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = goldenRes;
+  settings.centerShape = golden.centerShape;
+
+  ofstream comFile("/dev/null");
+
+  GOLDEN_RESULT result;
+  result.shape = renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), golden.centerShape, comFile, context);
+  result.passes = context.passes();
+  result.centerOfMass = context.origin();
+
+  FIELD_2D& mask = context.mask();
+  result.mask.resize(mask.totalCells());
+  for (int x = 0; x < mask.totalCells(); x++)
+    result.mask[x] = (mask[x] > 0.5) ? 1 : 0;
+  result.rgb.assign(context.rgb(), context.rgb() + 3 * goldenRes * goldenRes);
+  return result;
+}
+
+///////////////////////////////////////////////////////////////////////
+// run lengths of alternating black and white pixels, starting with black
+///////////////////////////////////////////////////////////////////////
+static string encodeMask(const vector<unsigned char>& mask)
+{
+  ostringstream out;
+  unsigned char current = 0;
+  int run = 0;
+  for (unsigned int x = 0; x < mask.size(); x++)
+  {
+    if (mask[x] != current)
+    {
+      out << run << " ";
+      current = mask[x];
+      run = 0;
+    }
+    run++;
+  }
+  out << run;
+  return out.str();
+}
+
+static vector<unsigned char> decodeMask(istream& in)
+{
+  vector<unsigned char> mask;
+  unsigned char current = 0;
+  int run;
+  while (in >> run)
+  {
+    mask.insert(mask.end(), run, current);
+    current = 1 - current;
+  }
+  return mask;
+}
+
+///////////////////////////////////////////////////////////////////////
+//
+// The file is one line per record:
+//
+//   mask (name) (centerShape) (# of roots) (root0_x) (root0_y) ... (shape) (passes) (COM x) (COM y) (run lengths ...)
+//   score (name) (name) (ratio) (reflected ratio)
+//
+///////////////////////////////////////////////////////////////////////
+bool recordGolden(const string& filename)
+{
+  ofstream out(filename.c_str());
+  if (!out.is_open())
+  {
+    cout << "Couldn't open " << filename << " for writing." << endl;
+    return false;
+  }
+  out.precision(9);
+
+  vector<GOLDEN_CASE> cases = goldenCases();
+  vector<GOLDEN_RESULT> results;
+  RENDER_CONTEXT context;
+  for (unsigned int x = 0; x < cases.size(); x++)
+  {
+    const GOLDEN_CASE& golden = cases[x];
+    results.push_back(renderCase(golden, context));
+    const GOLDEN_RESULT& result = results.back();
+
+    out << "mask " << golden.name << " " << golden.centerShape << " " << golden.roots.size();
+    for (unsigned int y = 0; y < golden.roots.size(); y++)
+      out << " " << golden.roots[y][0] << " " << golden.roots[y][1];
+    out << " " << result.shape << " " << result.passes << " "
+        << result.centerOfMass[0] << " " << result.centerOfMass[1] << " " << encodeMask(result.mask) << endl;
+  }
+
+  for (unsigned int x = 0; x < cases.size(); x++)
+    for (unsigned int y = x + 1; y < cases.size(); y++)
+    {
+      if (!results[x].shape || !results[y].shape)
+        continue;
+      SHAPE_SCORE score;
+      scoreShapes(&results[x].rgb[0], &results[y].rgb[0], goldenRes, goldenRes, score);
+      out << "score " << cases[x].name << " " << cases[y].name << " " << score.ratio << " " << score.reflectedRatio << endl;
+    }
+
+  cout << "Recorded " << cases.size() << " golden images in " << filename << endl;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool verifyGolden(const string& filename, const GOLDEN_TOLERANCE& tolerance)
+{
+  ifstream in(filename.c_str());
+  if (!in.is_open())
+  {
+    cout << "Couldn't open " << filename << "." << endl;
+    return false;
+  }
+
+  map<string, GOLDEN_RESULT> rendered;
+  RENDER_CONTEXT context;
+  int failures = 0;
+  int checks = 0;
+
+  string line;
+  while (getline(in, line))
+  {
+    istringstream record(line);
+    string type;
+    record >> type;
+
+    if (type == "mask")
+    {
+      GOLDEN_CASE golden;
+      int totalRoots;
+      record >> golden.name >> golden.centerShape >> totalRoots;
+      for (int x = 0; x < totalRoots; x++)
+      {
+        float rootX, rootY;
+        record >> rootX >> rootY;
+        golden.roots.push_back(VEC3F(rootX, rootY, 0.0));
+      }
+      bool shape;
+      int passes;
+      float comX, comY;
+      record >> shape >> passes >> comX >> comY;
+      vector<unsigned char> mask = decodeMask(record);
+
+      GOLDEN_RESULT result = renderCase(golden, context);
+      rendered[golden.name] = result;
+      checks++;
+
+      int flipped = 0;
+      for (unsigned int x = 0; x < mask.size() && x < result.mask.size(); x++)
+        if (mask[x] != result.mask[x])
+          flipped++;
+      const int allowed = (int)(tolerance.pixelFraction * goldenRes * goldenRes);
+
+      bool ok = true;
+      if (result.shape != shape || mask.size() != result.mask.size())
+      {
+        cout << golden.name << ": shape " << result.shape << ", expected " << shape << endl;
+        ok = false;
+      }
+      else if (flipped > allowed)
+      {
+        cout << golden.name << ": " << flipped << " pixels differ, " << allowed << " allowed" << endl;
+        ok = false;
+      }
+      if (fabs(result.centerOfMass[0] - comX) > tolerance.centerOfMass ||
+          fabs(result.centerOfMass[1] - comY) > tolerance.centerOfMass)
+      {
+        cout << golden.name << ": center of mass " << result.centerOfMass
+             << ", expected (" << comX << ", " << comY << ")" << endl;
+        ok = false;
+      }
+      if (!ok)
+        failures++;
+    }
+    else if (type == "score")
+    {
+      string first, second;
+      float ratio, reflectedRatio;
+      record >> first >> second >> ratio >> reflectedRatio;
+      if (rendered.find(first) == rendered.end() || rendered.find(second) == rendered.end())
+      {
+        cout << "score " << first << " " << second << ": unknown case" << endl;
+        failures++;
+        continue;
+      }
+      checks++;
+
+      SHAPE_SCORE score;
+      scoreShapes(&rendered[first].rgb[0], &rendered[second].rgb[0], goldenRes, goldenRes, score);
+      if (fabs(score.ratio - ratio) > tolerance.score || fabs(score.reflectedRatio - reflectedRatio) > tolerance.score)
+      {
+        cout << "score " << first << " " << second << ": " << score.ratio << " " << score.reflectedRatio
+             << ", expected " << ratio << " " << reflectedRatio << endl;
+        failures++;
+      }
+    }
+  }
+
+  cout << checks - failures << " of " << checks << " golden checks passed" << endl;
+  return failures == 0 && checks > 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool crossCheckBoundary(int resolution, const GOLDEN_TOLERANCE& tolerance)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  ofstream comFile("/dev/null");
+  RENDER_CONTEXT context;
+  FIELD_2D boundary;
+  FIELD_2D mask;
+
+  vector<GOLDEN_CASE> cases = goldenCases();
+  int failures = 0;
+  double renderSeconds = 0;
+  double boundarySeconds = 0;
+  for (unsigned int x = 0; x < cases.size(); x++)
+  {
+    const GOLDEN_CASE& golden = cases[x];
+    settings.centerShape = golden.centerShape;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    const bool shape = renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), golden.centerShape, comFile, context);
+    chrono::steady_clock::time_point middle = chrono::steady_clock::now();
+    BOUNDARY_STATS stats;
+    renderBoundary(settings, golden.roots, context.origin(), boundary, 4, &stats);
+    const bool boundaryShape = fillBoundary(settings, golden.roots, context.origin(), boundary, mask, &stats);
+    chrono::steady_clock::time_point stop = chrono::steady_clock::now();
+
+    // with centering on, only the last pass is comparable
+    const double renderTime = chrono::duration<double>(middle - start).count() / context.passes();
+    const double boundaryTime = chrono::duration<double>(stop - middle).count();
+    renderSeconds += renderTime;
+    boundarySeconds += boundaryTime;
+
+    int flipped = 0;
+    for (int y = 0; y < mask.totalCells(); y++)
+      if ((mask[y] > 0.5) != (context.mask()[y] > 0.5))
+        flipped++;
+    const int allowed = (int)(tolerance.pixelFraction * resolution * resolution);
+    const bool ok = (shape == boundaryShape) && (flipped <= allowed);
+    if (!ok)
+      failures++;
+
+    char line[256];
+    snprintf(line, sizeof(line), "%s: %i pixels differ, %i allowed; %i outline pixels, %i of %i iterated, speedup %.1fx%s",
+             golden.name.c_str(), flipped, allowed, stats.boundaryPixels, stats.iteratedPixels,
+             resolution * resolution, renderTime / boundaryTime, ok ? "" : " FAILED");
+    cout << line << endl;
+  }
+
+  cout << cases.size() - failures << " of " << cases.size() << " boundary cross-checks passed at "
+       << resolution << "x" << resolution << ", speedup " << renderSeconds / boundarySeconds << "x overall" << endl;
+  return failures == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// The lanes only match iterateRoots bit for bit if neither kernel has
+// its multiplies and adds fused; the Makefile turns contraction off for
+// every file, and this is what catches a build that didn't.
+///////////////////////////////////////////////////////////////////////
+bool checkBatch(int resolution)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  ofstream comFile("/dev/null");
+  RENDER_CONTEXT context;
+
+  // the golden configurations grouped by degree, and a row of the
+  // -pinned grid, where batches come from
+  map<int, vector<vector<VEC3F> > > rootSets;
+  vector<GOLDEN_CASE> cases = goldenCases();
+  for (unsigned int x = 0; x < cases.size(); x++)
+    rootSets[cases[x].roots.size()].push_back(cases[x].roots);
+  for (int x = 0; x < 16; x++)
+  {
+    vector<VEC3F> roots;
+    roots.push_back(VEC3F(0.0, 0.0, 0.0));
+    roots.push_back(VEC3F(-2.0 + x * 0.25, 0.5, 0.0));
+    rootSets[2].push_back(roots);
+  }
+
+  const int lanes[] = {BATCH_LANES, BATCH_WIDE_LANES};
+  int failures = 0;
+  int checks = 0;
+  for (map<int, vector<vector<VEC3F> > >::iterator degree = rootSets.begin(); degree != rootSets.end(); degree++)
+  {
+    const vector<vector<VEC3F> >& sets = degree->second;
+    vector<FIELD_2D> expected(sets.size());
+    for (unsigned int x = 0; x < sets.size(); x++)
+    {
+      renderImage(settings, sets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      expected[x] = context.mask();
+    }
+
+    for (int l = 0; l < 2; l++)
+    {
+      vector<FIELD_2D> masks;
+      renderBatch(settings, sets, masks, lanes[l]);
+      for (unsigned int x = 0; x < sets.size(); x++)
+      {
+        FIELD_2D pixelMask;
+        renderPixelLanes(settings, sets[x], pixelMask, lanes[l]);
+
+        int batchDiffer = 0;
+        int pixelDiffer = 0;
+        for (int y = 0; y < expected[x].totalCells(); y++)
+        {
+          if (masks[x][y] != expected[x][y])
+            batchDiffer++;
+          if (pixelMask[y] != expected[x][y])
+            pixelDiffer++;
+        }
+        checks++;
+        if (batchDiffer > 0 || pixelDiffer > 0)
+        {
+          failures++;
+          cout << "degree " << degree->first << " set " << x << ", " << lanes[l] << " lanes: " << batchDiffer
+               << " batch pixels and " << pixelDiffer << " pixel lane pixels differ FAILED" << endl;
+        }
+      }
+    }
+  }
+
+  cout << checks - failures << " of " << checks << " lane renders matched renderImage at "
+       << resolution << "x" << resolution << endl;
+  return failures == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// The reflections are only exact if the compiler computes a * d + b * c
+// the same way as c * b + d * a, which a fused multiply-add breaks; the
+// Makefile turns contraction off for every file, and this is what
+// catches a build that didn't.
+///////////////////////////////////////////////////////////////////////
+bool checkSymmetry(int resolution)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  ofstream comFile("/dev/null");
+  RENDER_CONTEXT direct;
+  RENDER_CONTEXT mirrored;
+
+  // a -pinned configuration with a real root, and a conjugate pair
+  // with a real root
+  vector<GOLDEN_CASE> cases = goldenCases();
+  const float symmetric[][8] = {
+    {2, 0.0, 0.0, 0.7, 0.0},
+    {3, -0.1, 0.5, -0.1, -0.5, 0.2, 0.0}
+  };
+  for (int x = 0; x < 2; x++)
+  {
+    GOLDEN_CASE golden;
+    char name[64];
+    sprintf(name, "symmetric%i", x);
+    golden.name = name;
+    golden.centerShape = 0;
+    for (int y = 0; y < (int)symmetric[x][0]; y++)
+      golden.roots.push_back(VEC3F(symmetric[x][1 + 2 * y], symmetric[x][2 + 2 * y], 0.0));
+    cases.push_back(golden);
+  }
+
+  int failures = 0;
+  for (unsigned int x = 0; x < cases.size(); x++)
+  {
+    const GOLDEN_CASE& golden = cases[x];
+    settings.centerShape = golden.centerShape;
+    settings.symmetry = false;
+    renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), golden.centerShape, comFile, direct);
+    settings.symmetry = true;
+    renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), golden.centerShape, comFile, mirrored);
+
+    int differ = 0;
+    for (int y = 0; y < direct.mask().totalCells(); y++)
+      if (direct.mask()[y] != mirrored.mask()[y])
+        differ++;
+    if (differ > 0 || direct.passes() != mirrored.passes())
+      failures++;
+    cout << golden.name << ": " << mirrored.filledPixels() << " pixels reflected, " << differ << " differ"
+         << ((differ > 0 || direct.passes() != mirrored.passes()) ? " FAILED" : "") << endl;
+  }
+
+  cout << cases.size() - failures << " of " << cases.size() << " symmetric renders matched at "
+       << resolution << "x" << resolution << endl;
+  return failures == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Roots (0, 0) and (r, 0) for r just under 0.87 have a shape, but zero
+// only just attracts the critical point at r / 2 and takes 80 to 100
+// iterations to capture it.
+///////////////////////////////////////////////////////////////////////
+bool checkPredictions(int resolution)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  ofstream comFile("/dev/null");
+  RENDER_CONTEXT context;
+
+  vector<GOLDEN_CASE> cases = goldenCases();
+  const float lateCaptures[] = {0.84, 0.85, 0.86};
+  for (int x = 0; x < 3; x++)
+  {
+    GOLDEN_CASE golden;
+    char name[64];
+    sprintf(name, "lateCapture%.2f", lateCaptures[x]);
+    golden.name = name;
+    golden.centerShape = 0;
+    golden.roots.push_back(VEC3F(0.0, 0.0, 0.0));
+    golden.roots.push_back(VEC3F(lateCaptures[x], 0.0, 0.0));
+    cases.push_back(golden);
+  }
+
+  // what PREDICTION_AUDIT counts as a shape
+  const float sprinkleFraction = 1e-4;
+  int failures = 0;
+  for (unsigned int x = 0; x < cases.size(); x++)
+  {
+    const GOLDEN_CASE& golden = cases[x];
+    const SHAPE_PREDICTION prediction = predictShape(golden.roots, settings.maxIterations, settings.escapeRadius);
+    renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    const long long whitePixels = (long long)(context.mask().sum() + 0.5);
+    const long long totalPixels = context.mask().totalCells();
+
+    const bool missed = hopeless(prediction) && whitePixels > 0 && whitePixels >= sprinkleFraction * totalPixels;
+    if (missed)
+      failures++;
+    cout << golden.name << ": predicted " << predictionName(prediction) << ", " << whitePixels << " white pixels"
+         << (missed ? " MISSED" : "") << endl;
+  }
+
+  cout << cases.size() - failures << " of " << cases.size() << " predictions kept their shapes at "
+       << resolution << "x" << resolution << endl;
+  return failures == 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// any cell pattern that doesn't line up with the bytes or the rows
+///////////////////////////////////////////////////////////////////////
+static inline bool bigFieldCell(unsigned int x, unsigned int y)
+{
+  return ((x * 2654435761u) ^ (y * 40503u)) >> 31;
+}
+
+///////////////////////////////////////////////////////////////////////
+// 65536 x 32769 is 2^31 + 65536 cells, past where an int product of
+// the dimensions wraps, in a 256 MB file
+///////////////////////////////////////////////////////////////////////
+bool checkFieldFile(const string& filename, int resolution)
+{
+  const int bigX = 65536;
+  const int bigY = 32769;
+  const size_t rowBytes = bigX / 8;
+  int failures = 0;
+
+  FIELD_2D_WRITER writer;
+  vector<unsigned char> row(rowBytes);
+  bool written = writer.open(filename, bigX, bigY, false, 0, FIELD_CELL_BIT);
+  for (int y = 0; y < bigY && written; y++)
+  {
+    memset(&row[0], 0, rowBytes);
+    for (int x = 0; x < bigX; x++)
+      if (bigFieldCell(x, y))
+        row[x >> 3] |= 0x80 >> (x & 7);
+    written = writer.writeBitRows(&row[0], 1);
+  }
+  written = writer.close() && written;
+
+  MAPPED_FIELD_2D mapped;
+  if (!written || !mapped.open(filename))
+  {
+    cout << bigX << "x" << bigY << " bit field: " << (written ? mapped.error() : writer.error()) << " FAILED" << endl;
+    failures++;
+  }
+  else
+  {
+    long long differ = 0;
+    for (int y = 0; y < bigY; y++)
+      for (int x = 0; x < bigX; x++)
+        if (mapped(x, y) != (bigFieldCell(x, y) ? 1.0f : 0.0f))
+          differ++;
+    const size_t last = mapped.totalCells() - 1;
+    if (mapped.totalCells() != (size_t)bigX * bigY || mapped[last] != (bigFieldCell(bigX - 1, bigY - 1) ? 1.0f : 0.0f))
+      differ++;
+    if (differ > 0)
+      failures++;
+    cout << bigX << "x" << bigY << " bit field: " << mapped.totalCells() << " cells mapped back, " << differ
+         << " differ" << (differ > 0 ? " FAILED" : "") << endl;
+  }
+  mapped.close();
+
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  ofstream comFile("/dev/null");
+  RENDER_CONTEXT context;
+
+  GIGAPIXEL_SETTINGS gigapixel;
+  gigapixel.xRes = gigapixel.yRes = resolution;
+  gigapixel.maxIterations = settings.maxIterations;
+  gigapixel.escapeRadius = settings.escapeRadius;
+  gigapixel.mixedPrecision = settings.mixedPrecision;
+
+  vector<GOLDEN_CASE> cases = goldenCases();
+  for (unsigned int x = 0; x < cases.size(); x++)
+  {
+    const GOLDEN_CASE& golden = cases[x];
+    renderImage(settings, golden.roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    const FIELD_2D& expected = context.mask();
+
+    GIGAPIXEL_RESULT result;
+    string error;
+    FIELD_2D loaded;
+    if (!renderGigapixel(gigapixel, golden.roots, filename, result, error) || !mapped.open(filename) ||
+        !loaded.read(filename))
+    {
+      cout << golden.name << ": " << (error.empty() ? mapped.error() : error) << " FAILED" << endl;
+      failures++;
+      continue;
+    }
+
+    const bool sameSize = (loaded.xRes() == expected.xRes() && loaded.yRes() == expected.yRes());
+    int mappedDiffer = 0;
+    int readDiffer = sameSize ? 0 : expected.totalCells();
+    for (int y = 0; y < expected.totalCells(); y++)
+    {
+      if (mapped[y] != expected[y])
+        mappedDiffer++;
+      if (sameSize && loaded[y] != expected[y])
+        readDiffer++;
+    }
+    mapped.close();
+    if (mappedDiffer > 0 || readDiffer > 0)
+    {
+      failures++;
+      cout << golden.name << ": " << mappedDiffer << " mapped and " << readDiffer << " read pixels differ FAILED"
+           << endl;
+    }
+  }
+  remove(filename.c_str());
+
+  cout << cases.size() + 1 - failures << " of " << cases.size() + 1 << " field files read back exactly, the golden ones at "
+       << resolution << "x" << resolution << endl;
+  return failures == 0;
+}
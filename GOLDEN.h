@@ -0,0 +1,72 @@
+#ifndef GOLDEN_H
+#define GOLDEN_H
+
+///////////////////////////////////////////////////////////////////////
+// Golden-image checks for renderImage, centering and the shape score.
+//
+// "recordGolden" renders a fixed set of root configurations and writes
+// out their masks, centers of mass and the pairwise shape scores;
+// "verifyGolden" re-renders the same configurations and reports
+// anything that moved by more than the tolerances, which leave room
+// for floating-point reordering in an optimized kernel but not for
+// real changes in shape.
+//
+// golden.txt, at the top of the tree, is the file to verify against.
+// It was recorded with the renderImage of the original single-file
+// mandelbrot.cpp, before any of the kernel's optimizations, so it
+// catches one that changes the shapes.
+///////////////////////////////////////////////////////////////////////
+
+#include <string>
+
+struct GOLDEN_TOLERANCE {
+  GOLDEN_TOLERANCE() :
+    pixelFraction(0.001), centerOfMass(0.001), score(0.001)
+  {
+  };
+
+  float pixelFraction; // fraction of a mask's pixels allowed to flip
+  float centerOfMass; // per axis
+  float score; // shape score ratios
+};
+
+// returns false if the file couldn't be written
+bool recordGolden(const std::string& filename);
+
+// returns false if anything is out of tolerance, printing what is
+bool verifyGolden(const std::string& filename, const GOLDEN_TOLERANCE& tolerance);
+
+// render every golden configuration at "resolution" with renderImage
+// and again with the boundary renderer (see BOUNDARY_RENDERER.h), at
+// the origin renderImage settled on, and report how many pixels differ;
+// returns false if any mask is out of tolerance
+bool crossCheckBoundary(int resolution, const GOLDEN_TOLERANCE& tolerance);
+
+// render the golden configurations and a row of -pinned ones at
+// "resolution" with renderBatch and renderPixelLanes (see
+// BATCH_RENDERER.h), 8 and 16 lanes at a time, and check that every
+// mask is exactly renderImage's; returns false if any pixel differs
+bool checkBatch(int resolution);
+
+// render every golden configuration, and a few more whose images are
+// symmetric, at "resolution" with settings.symmetry on and off, and
+// check that the reflected pixels are exactly the ones a direct render
+// gives; returns false if any pixel differs
+bool checkSymmetry(int resolution);
+
+// render every golden configuration, and ones whose critical orbits
+// are only slowly captured by a root, at "resolution" and check that
+// predictShape (see CRITICAL_ORBIT.h) never calls one that has a shape
+// hopeless, the way a -predict skip sweep with -audit would see it;
+// returns false if any shape would have been skipped
+bool checkPredictions(int resolution);
+
+// write a bit field to "filename" with more cells than an int counts,
+// 65536 x 32769, and check that every cell maps back (see
+// FIELD_2D_FILE.h); then stream every golden configuration there with
+// renderGigapixel at "resolution" and check that mapping it and reading
+// it into a FIELD_2D both give exactly renderImage's mask. Removes the
+// file after; returns false if any cell differs
+bool checkFieldFile(const std::string& filename, int resolution);
+
+#endif
@@ -0,0 +1,207 @@
+#include "ITERATION_BUDGET.h"
+#include "CRITICAL_ORBIT.h"
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+using namespace std;
+
+// how close to its cycle a critical orbit has to get before the rate
+// it closes in at means anything in double
+static const double settledDistance = 1e-9;
+
+///////////////////////////////////////////////////////////////////////
+// how far iterate "n" of an orbit is from the one 1 to 8 steps before
+// it, whichever is closest; 0 once it has landed on a short cycle
+///////////////////////////////////////////////////////////////////////
+static double cycleDistance(const vector<COMPLEX>& orbit, int n)
+{
+  double closest = abs(orbit[n] - orbit[n - 1]);
+  for (int k = 2; k <= 8 && k <= n; k++)
+    closest = min(closest, abs(orbit[n] - orbit[n - k]));
+  return closest;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Is some bounded critical orbit still closing in on its cycle slowly
+// at the end of the budget? Next to an attracting cycle it closes in
+// geometrically, and halving the distance to it takes a few iterations.
+// Next to a cycle that is only just attracting, or neutral, it closes
+// in like 1 / n, and so do the pixels around the Julia set that escape
+// through that neighbourhood: their escape times have a long tail that
+// a 64 x 64 probe doesn't see, and the geometric fit would cut it off.
+// Roots (0, 0) and (0, 1) are like that, with pixels still stopping at
+// 99 of 100 iterations.
+///////////////////////////////////////////////////////////////////////
+static bool slowCycle(const vector<VEC3F>& roots, int maxIterations, double escapeRadius)
+{
+  vector<COMPLEX> points;
+  criticalPoints(roots, points);
+  const int half = maxIterations / 2;
+  if (half < 8)
+    return false;
+
+  for (unsigned int x = 0; x < points.size(); x++)
+  {
+    vector<COMPLEX> orbit(1, points[x]);
+    bool stopped = false;
+    while ((int)orbit.size() <= maxIterations && !stopped)
+    {
+      COMPLEX g(1.0, 0.0);
+      for (unsigned int y = 0; y < roots.size(); y++)
+        g *= orbit.back() - COMPLEX(roots[y][0], roots[y][1]);
+      orbit.push_back(g);
+      stopped = abs(g) > escapeRadius || abs(g) < 1e-7;
+    }
+    if (stopped)
+      continue;
+
+    // still far off at the end, and no more than a quarter nearer than
+    // half way there
+    const double halfWay = cycleDistance(orbit, half);
+    const double end = cycleDistance(orbit, maxIterations);
+    if (end > settledDistance && end > 0.25 * halfWay)
+      return true;
+  }
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+// The tail is the slowest tenth of the probe pixels that stopped. For
+// a geometric tail the chance of going on past j more iterations is
+// q^j, with q = mean / (1 + mean) for the mean number of iterations
+// past the start of the tail.
+///////////////////////////////////////////////////////////////////////
+BUDGET_ESTIMATE estimateBudget(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots,
+                               const BUDGET_SETTINGS& budget)
+{
+  const int fullBudget = settings.maxIterations;
+  BUDGET_ESTIMATE estimate;
+  estimate.maxIterations = fullBudget;
+
+  // the probe's pixel centers, laid out the way renderImage does it
+  const float dx = 4.0f / budget.probeRes;
+  vector<int> stopped;
+  for (int y = 0; y < budget.probeRes; y++)
+    for (int x = 0; x < budget.probeRes; x++)
+    {
+      VEC3F center;
+      center[0] = -2.0f + x * dx;
+      center[1] = -2.0f + y * dx;
+      const int totalIterations = iterateRoots(center, roots, fullBudget, settings.escapeRadius);
+      if (totalIterations == fullBudget)
+        estimate.probeInside++;
+      else
+        stopped.push_back(totalIterations);
+    }
+
+  estimate.criticalSlowest = slowestCriticalOrbit(roots, fullBudget, settings.escapeRadius);
+  if (!stopped.empty())
+    estimate.probeSlowest = *max_element(stopped.begin(), stopped.end());
+
+  // only pixels that don't escape cost more with a bigger budget, so
+  // with hardly any there is nothing to save, and a lower budget could
+  // only add some
+  if (estimate.probeInside * 1024 < budget.probeRes * budget.probeRes)
+    return estimate;
+
+  // the tail is too long for the fit
+  estimate.slowCycle = slowCycle(roots, fullBudget, settings.escapeRadius);
+  if (estimate.slowCycle)
+    return estimate;
+
+  // the image has many more pixels closer to the Julia set than the
+  // probe, and they take longer: at 800 x 800 the slowest one to stop
+  // took up to twice as long as the probe's on the -pinned grids
+  const int slowest = max(estimate.probeSlowest, estimate.criticalSlowest);
+  int chosen = max(2 * slowest + budget.margin, budget.minIterations);
+  double expectedFlips = 0.0;
+  if (!stopped.empty() && chosen < fullBudget)
+  {
+    sort(stopped.begin(), stopped.end());
+    const int tailStart = stopped[(stopped.size() - 1) * 9 / 10];
+    int tail = 0;
+    double excess = 0.0;
+    for (unsigned int x = 0; x < stopped.size(); x++)
+      if (stopped[x] >= tailStart)
+      {
+        tail++;
+        excess += stopped[x] - tailStart;
+      }
+    const double mean = excess / tail;
+    const double q = mean / (1.0 + mean);
+
+    // image pixels expected to stop at "chosen" or later, which would
+    // all come out white
+    const double scale = (double)settings.xRes * settings.yRes / ((double)budget.probeRes * budget.probeRes);
+    expectedFlips = scale * tail * pow(q, chosen - tailStart);
+    while (chosen < fullBudget && expectedFlips > budget.tolerance)
+    {
+      chosen++;
+      expectedFlips *= q;
+    }
+  }
+
+  if (chosen >= fullBudget)
+  {
+    chosen = fullBudget;
+    expectedFlips = 0.0;
+  }
+  estimate.maxIterations = chosen;
+  estimate.expectedFlips = expectedFlips;
+  return estimate;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+BUDGET_REPORT::BUDGET_REPORT(const string& filename, int fullBudget) :
+  _file(filename.c_str()), _fullBudget(fullBudget), _configurations(0), _shapes(0), _budgetSum(0),
+  _iterations(0), _expectedFlips(0), _worstFlips(0)
+{
+}
+
+BUDGET_REPORT::~BUDGET_REPORT()
+{
+  close();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void BUDGET_REPORT::add(const vector<VEC3F>& roots, const BUDGET_ESTIMATE& estimate, bool shape, long long iterations)
+{
+  _configurations++;
+  if (shape)
+    _shapes++;
+  _budgetSum += estimate.maxIterations;
+  _iterations += iterations;
+  _expectedFlips += estimate.expectedFlips;
+  _worstFlips = max(_worstFlips, estimate.expectedFlips);
+  if (!_file.is_open())
+    return;
+
+  for (unsigned int x = 0; x < roots.size(); x++)
+    _file << "topRoots" << x << roots[x] << ", ";
+  char line[256];
+  snprintf(line, sizeof(line), "maxIterations %i (probe %i, critical %i, inside %i%s), expected flips %.3g, %s",
+           estimate.maxIterations, estimate.probeSlowest, estimate.criticalSlowest, estimate.probeInside,
+           estimate.slowCycle ? ", slow cycle" : "", estimate.expectedFlips, shape ? "shape" : "no shape");
+  _file << line << endl;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void BUDGET_REPORT::close()
+{
+  if (!_file.is_open())
+    return;
+
+  _file << endl;
+  _file << "configurations: " << _configurations << ", with a shape: " << _shapes << endl;
+  if (_configurations > 0)
+  {
+    _file << "mean maxIterations: " << (double)_budgetSum / _configurations << " of " << _fullBudget << endl;
+    _file << "iterations rendered: " << _iterations << endl;
+    _file << "expected flipped pixels: " << _expectedFlips << ", worst configuration: " << _worstFlips << endl;
+  }
+  _file.close();
+}
@@ -0,0 +1,107 @@
+#ifndef ITERATION_BUDGET_H
+#define ITERATION_BUDGET_H
+
+///////////////////////////////////////////////////////////////////////
+// Picks maxIterations for each configuration, instead of spending
+// RENDER_SETTINGS' budget on every pixel that doesn't escape. This is
+// lossy: it trades the chance of a few pixels coming out white, and so
+// of a shape changing, for fewer iterations, and the images aren't
+// guaranteed to be the full budget's.
+//
+// A pixel that doesn't escape costs the whole budget, and one that
+// escapes or lands on zero costs however long that took. Lowering the
+// budget only ever turns pixels white: one that would have stopped at
+// iteration k now counts as not escaping if the budget is k or less. So
+// the budget has to stay past the slowest pixel that stops. That is
+// estimated two ways:
+//
+//   - the escape-time histogram of a coarse probe of the window, at the
+//     full budget. Toward the Julia set the pixels take longer, and the
+//     histogram's tail falls off about geometrically, so it can be
+//     extrapolated to as many pixels as the image has, to find where
+//     fewer than "tolerance" of them would still be stopping
+//   - the critical orbits, which the pixels around each critical point
+//     follow, so the budget stays past the slowest one that stops
+//
+// The budget starts at twice the slowest of those, and goes up until
+// the tail puts fewer than "tolerance" pixels past it. A critical orbit
+// that is still closing in on its cycle like 1 / n at the end of the
+// budget, rather than geometrically, means a tail much longer than the
+// fit, so those configurations keep the full budget.
+//
+// The pixels the tail puts past the chosen budget are the risk: that
+// many are expected to come out white where the full budget would have
+// made them black. If the probe found next to nothing white, any of
+// them could give the image a shape it wouldn't have had, so those
+// configurations keep the full budget; they have nothing to save anyway.
+//
+// The expected count is the fit's, not a bound. Measured at 800 x 800
+// against the full budget of 100, over the 12 x 12 and 20 x 20 -pinned
+// grids and 90 random configurations of degree 2 to 4, 35 of 368 got a
+// lower budget and rendered about half of their iterations, about 5%
+// fewer over all of them; 6 of those came out with pixels turned white,
+// 42 pixels in all, where the fit expected 0.014. The 12 x 12 -pinned
+// sweep happens to come out unchanged, but nothing promises that of
+// another. Use the full budget wherever the shapes have to be exactly
+// the ones it gives; -adaptive is only on when asked for.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "VEC3F.h"
+#include "JULIA_RENDERER.h"
+
+struct BUDGET_SETTINGS {
+  BUDGET_SETTINGS() : probeRes(64), tolerance(0.01), minIterations(8), margin(4) {};
+
+  int probeRes; // the probe is probeRes x probeRes over renderImage's window
+  double tolerance; // how many pixels of the image may be expected to flip
+  int minIterations; // never go below this
+  int margin; // iterations past the slowest probe pixel or critical orbit that stopped
+};
+
+struct BUDGET_ESTIMATE {
+  BUDGET_ESTIMATE() : maxIterations(0), probeSlowest(0), criticalSlowest(0), probeInside(0),
+                      slowCycle(false), expectedFlips(0) {};
+
+  int maxIterations; // what to render with, at most the full budget
+  int probeSlowest; // the most iterations a probe pixel took to stop, 0 if none did
+  int criticalSlowest; // the same for the critical orbits
+  int probeInside; // probe pixels that never stopped
+  bool slowCycle; // a critical orbit closes in on its cycle too slowly for the tail fit
+  double expectedFlips; // image pixels expected to turn white that the full budget would make black
+};
+
+// the budget for "roots", with settings.maxIterations as the full one
+// and the image's resolution to extrapolate to
+BUDGET_ESTIMATE estimateBudget(const RENDER_SETTINGS& settings, const std::vector<VEC3F>& roots,
+                               const BUDGET_SETTINGS& budget = BUDGET_SETTINGS());
+
+// one line per configuration with its budget and risk, and how the
+// budgets compared with the full one at the end
+class BUDGET_REPORT {
+public:
+  BUDGET_REPORT(const std::string& filename, int fullBudget);
+  ~BUDGET_REPORT();
+
+  bool isOpen() const { return _file.is_open(); };
+
+  // "iterations" is what the render at the estimated budget took
+  void add(const std::vector<VEC3F>& roots, const BUDGET_ESTIMATE& estimate, bool shape, long long iterations);
+
+  // write the summary and close the file
+  void close();
+
+private:
+  std::ofstream _file;
+  int _fullBudget;
+  long long _configurations;
+  long long _shapes;
+  long long _budgetSum;
+  long long _iterations;
+  double _expectedFlips;
+  double _worstFlips;
+};
+
+#endif
@@ -0,0 +1,784 @@
+#include "JULIA_RENDERER.h"
+#include "PPM_FILE.h"
+#include "METRICS.h"
+#include "POLYNOMIAL.h"
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+// Do a complex multiply
+///////////////////////////////////////////////////////////////////////
+VEC3F complexMultiply(VEC3F left, VEC3F right)
+{
+  float a = left[0];
+  float b = left[1];
+  float c = right[0];
+  float d = right[1];
+  return VEC3F(a * c - b * d, a * d + b * c, 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////
+// Iterate the polynomial defined by "roots" starting at "center".
+// Returns the number of iterations taken before the iterate escaped or
+// landed on a root; maxIterations means it did neither.
+///////////////////////////////////////////////////////////////////////
+int iterateRoots(const VEC3F& center, const vector<VEC3F>& roots, int maxIterations, float escapeRadius)
+{
+  const int totalRoots = roots.size();
+
+  VEC3F iterate = center; // iterate is q
+  VEC3F p; // hold calculated polynomial
+
+  float magnitude = iterate.magnitude();
+  int totalIterations = 0;
+  while (magnitude < escapeRadius && totalIterations < maxIterations)
+  {
+    VEC3F g = VEC3F(1.0, 0.0, 0.0); // holds current polynomial on top
+    VEC3F diff;
+
+    // compute the top: iterate through top roots
+    for (int x = 0; x < totalRoots; x++)
+    {
+      // add (q-root) onto g, the polynomial on the top
+      diff = (iterate - roots[x]);
+      g = complexMultiply(g, diff);
+    }
+
+    // compute the polynomial
+    p = g;
+    iterate = p;
+
+    magnitude = iterate.magnitude();
+    totalIterations++;
+
+    // exit conditions
+    if (magnitude > escapeRadius)
+      break;
+    if (magnitude < 1e-7)
+      break;
+  }
+  return totalIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// iterateRoots, step for step, also carrying a bound on how far float
+// rounding could have moved the iterate from the exact orbit. Each step
+// the error so far is stretched by at most |p'(z)|, bounded by
+// degree |p(z)| / min |z - root|, and the step adds its own rounding,
+// which is largest next to a root where (z - root) cancels. If the
+// threshold a step was tested against ever lies within that bound of
+// the iterate's magnitude, the test could have gone the other way.
+///////////////////////////////////////////////////////////////////////
+int iterateRootsFlagged(const VEC3F& center, const vector<VEC3F>& roots, int maxIterations, float escapeRadius,
+                        bool& nearThreshold)
+{
+  const int totalRoots = roots.size();
+  const float epsilon = 6e-8f;
+  float largestRoot = 0.0f;
+  for (int x = 0; x < totalRoots; x++)
+    largestRoot = max(largestRoot, (float)sqrt(roots[x][0] * roots[x][0] + roots[x][1] * roots[x][1]));
+
+  // the same float operations as iterateRoots on VEC3Fs, whose third
+  // component stays zero, without carrying it along
+  float iterateX = center[0];
+  float iterateY = center[1];
+  float magnitude = sqrt(iterateX * iterateX + iterateY * iterateY);
+  float error = 0.0f;
+  nearThreshold = false;
+  int totalIterations = 0;
+  while (magnitude < escapeRadius && totalIterations < maxIterations)
+  {
+    float gX = 1.0f;
+    float gY = 0.0f;
+    float closestSq = 1e30f;
+    for (int x = 0; x < totalRoots; x++)
+    {
+      const float diffX = iterateX - roots[x][0];
+      const float diffY = iterateY - roots[x][1];
+      closestSq = min(closestSq, diffX * diffX + diffY * diffY);
+      const float productX = gX * diffX - gY * diffY;
+      const float productY = gX * diffY + gY * diffX;
+      gX = productX;
+      gY = productY;
+    }
+    const float previous = magnitude;
+    iterateX = gX;
+    iterateY = gY;
+
+    magnitude = sqrt(iterateX * iterateX + iterateY * iterateY);
+    totalIterations++;
+
+    const float closest = sqrt(closestSq);
+    error = totalRoots * magnitude * (error + epsilon * (previous + largestRoot)) / closest +
+            2 * totalRoots * epsilon * magnitude;
+    if (fabs(magnitude - escapeRadius) <= 4.0f * error || fabs(magnitude - 1e-7f) <= 4.0f * error)
+      nearThreshold = true;
+
+    if (magnitude > escapeRadius)
+      break;
+    if (magnitude < 1e-7)
+      break;
+  }
+  return totalIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// iterateRoots in double, from the same float pixel center and roots
+///////////////////////////////////////////////////////////////////////
+int iterateRootsDouble(const VEC3F& center, const vector<VEC3F>& roots, int maxIterations, double escapeRadius)
+{
+  const int totalRoots = roots.size();
+
+  double iterateX = center[0];
+  double iterateY = center[1];
+  double magnitude = sqrt(iterateX * iterateX + iterateY * iterateY);
+  int totalIterations = 0;
+  while (magnitude < escapeRadius && totalIterations < maxIterations)
+  {
+    double gX = 1.0;
+    double gY = 0.0;
+    for (int x = 0; x < totalRoots; x++)
+    {
+      const double diffX = iterateX - roots[x][0];
+      const double diffY = iterateY - roots[x][1];
+      const double productX = gX * diffX - gY * diffY;
+      const double productY = gX * diffY + gY * diffX;
+      gX = productX;
+      gY = productY;
+    }
+    iterateX = gX;
+    iterateY = gY;
+
+    magnitude = sqrt(iterateX * iterateX + iterateY * iterateY);
+    totalIterations++;
+
+    if (magnitude > escapeRadius)
+      break;
+    if (magnitude < 1e-7)
+      break;
+  }
+  return totalIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+RENDER_CONTEXT::RENDER_CONTEXT() :
+  _xRes(0), _yRes(0), _passes(0), _hasPrevious(false), _iteratedPixels(0), _filledPixels(0), _iterations(0),
+  _recheckedPixels(0),
+  _supplied(NULL), _suppliedIterations(0), _suppliedHistogram(NULL)
+{
+}
+
+///////////////////////////////////////////////////////////////////////
+// only touches the heap when the image gets bigger than anything this
+// context has rendered before
+///////////////////////////////////////////////////////////////////////
+void RENDER_CONTEXT::reserve(int xRes, int yRes)
+{
+  _xRes = xRes;
+  _yRes = yRes;
+  _passes = 0;
+  _iteratedPixels = 0;
+  _filledPixels = 0;
+  _iterations = 0;
+  _recheckedPixels = 0;
+  if (_mask.xRes() != xRes || _mask.yRes() != yRes)
+    _mask.resizeAndWipe(xRes, yRes);
+  if (_rgb.size() < (size_t)(3 * xRes * yRes))
+    _rgb.resize(3 * xRes * yRes);
+}
+
+///////////////////////////////////////////////////////////////////////
+// one pixel for renderImage: iterateRoots, or with mixed precision the
+// flagged float iteration and, if it can't be trusted, the double one.
+// "iterations" gets every iteration done and "rechecked" counts the
+// pixels done twice.
+///////////////////////////////////////////////////////////////////////
+static inline int iteratePixel(const RENDER_SETTINGS& settings, const VEC3F& center, const vector<VEC3F>& roots,
+                               long long& iterations, long long& rechecked)
+{
+  if (!settings.mixedPrecision)
+  {
+    const int totalIterations = iterateRoots(center, roots, settings.maxIterations, settings.escapeRadius);
+    iterations += totalIterations;
+    return totalIterations;
+  }
+
+  bool nearThreshold;
+  const int totalIterations = iterateRootsFlagged(center, roots, settings.maxIterations, settings.escapeRadius,
+                                                  nearThreshold);
+  iterations += totalIterations;
+  if (!nearThreshold)
+    return totalIterations;
+
+  const int checkedIterations = iterateRootsDouble(center, roots, settings.maxIterations, settings.escapeRadius);
+  iterations += checkedIterations;
+  rechecked++;
+  return checkedIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// is "guess" all one value over [x0, x1] x [y0, y1], clamped to the
+// image? If so, "value" gets it.
+///////////////////////////////////////////////////////////////////////
+static bool uniformGuess(const FIELD_2D& guess, int x0, int y0, int x1, int y1, bool& value)
+{
+  x0 = max(x0, 0);
+  y0 = max(y0, 0);
+  x1 = min(x1, guess.xRes() - 1);
+  y1 = min(y1, guess.yRes() - 1);
+  value = guess(x0, y0) == 1.0;
+  for (int y = y0; y <= y1; y++)
+    for (int x = x0; x <= x1; x++)
+      if ((guess(x, y) == 1.0) != value)
+        return false;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+// What iterateRoots would say for every point of the disk around
+// "center": the disk itself is iterated, each (z - root) a disk and each
+// product bounded with the triangle inequality, and grown every step by
+// more than float rounding could move an iterate. Returns 1 if every
+// point would be white, 0 if every point would escape or land on zero
+// before maxIterations, and -1 if the disk can't tell.
+///////////////////////////////////////////////////////////////////////
+static int proveDisk(COMPLEX center, double radius, const vector<VEC3F>& roots, int maxIterations, float escapeRadius)
+{
+  const double rounding = 16.0 * roots.size() * 6e-8; // float epsilon, a few times over per root
+  const double margin = 1e-6; // for float's magnitude()
+  const double capture = 1e-7;
+
+  double magnitude = abs(center);
+  if (magnitude - radius > escapeRadius * (1.0 + margin))
+    return 0;
+  bool white = (magnitude + radius < escapeRadius * (1.0 - margin));
+
+  // where the iterate lands on the last iteration doesn't matter, since
+  // it gets counted as maxIterations either way
+  for (int totalIterations = 1; totalIterations < maxIterations; totalIterations++)
+  {
+    COMPLEX product(1.0, 0.0);
+    double productRadius = 0.0;
+    double bound = 1.0;
+    for (unsigned int x = 0; x < roots.size(); x++)
+    {
+      const COMPLEX factor = center - COMPLEX(roots[x][0], roots[x][1]);
+      productRadius = abs(product) * radius + abs(factor) * productRadius + productRadius * radius;
+      product *= factor;
+      bound *= abs(factor) + radius;
+    }
+    center = product;
+    radius = productRadius + rounding * bound;
+    magnitude = abs(center);
+
+    // everything has stopped by now, one way or the other
+    if (magnitude - radius > escapeRadius * (1.0 + margin) || magnitude + radius < capture * (1.0 - margin))
+      return 0;
+
+    white = white && (magnitude + radius < escapeRadius * (1.0 - margin)) && (magnitude - radius > capture * (1.0 + margin));
+    if (!white && radius > escapeRadius)
+      return -1;
+  }
+  return white ? 1 : -1;
+}
+
+///////////////////////////////////////////////////////////////////////
+// renderImage's pixel loop, guessing from the previous frame. Tiles the
+// previous frame had as one value, a pixel past their edges as well,
+// are tried with proveDisk on a disk holding every pixel center in
+// them, computed the way renderImage computes them; the rest, and any
+// that the disk can't settle, are iterated pixel by pixel. "shade"
+// iterates and colors a pixel, and "paint" colors it without iterating.
+// Returns how many pixels were painted from proofs.
+///////////////////////////////////////////////////////////////////////
+template <class SHADE, class PAINT>
+static long long renderFromGuess(const RENDER_SETTINGS& settings, const FIELD_2D& guess, const vector<VEC3F>& roots,
+                                 const VEC3F& origin, SHADE& shade, PAINT& paint)
+{
+  const int tileSize = 8;
+  const int xRes = guess.xRes();
+  const int yRes = guess.yRes();
+  const float dx = 4.0f / xRes;
+  const float dy = 4.0f / yRes;
+
+  long long guessed = 0;
+  for (int y0 = 0; y0 < yRes; y0 += tileSize)
+    for (int x0 = 0; x0 < xRes; x0 += tileSize)
+    {
+      const int x1 = min(x0 + tileSize, xRes) - 1;
+      const int y1 = min(y0 + tileSize, yRes) - 1;
+
+      bool value;
+      int proven = -1;
+      if (uniformGuess(guess, x0 - 1, y0 - 1, x1 + 1, y1 + 1, value))
+      {
+        const float xLow = -2.0f + origin[0] + x0 * dx;
+        const float xHigh = -2.0f + origin[0] + x1 * dx;
+        const float yLow = -2.0f + origin[1] + y0 * dy;
+        const float yHigh = -2.0f + origin[1] + y1 * dy;
+        const COMPLEX center(0.5 * ((double)xLow + xHigh), 0.5 * ((double)yLow + yHigh));
+        const double radius = 0.5 * hypot((double)xHigh - xLow, (double)yHigh - yLow) * (1.0 + 1e-6) + 1e-12;
+        proven = proveDisk(center, radius, roots, settings.maxIterations, settings.escapeRadius);
+      }
+
+      for (int y = y0; y <= y1; y++)
+        for (int x = x0; x <= x1; x++)
+          if (proven < 0)
+            shade(x, y);
+          else
+            paint(x, y, proven == 1);
+      if (proven >= 0)
+        guessed += (long long)(x1 - x0 + 1) * (y1 - y0 + 1);
+    }
+  return guessed;
+}
+
+///////////////////////////////////////////////////////////////////////
+// a + b without rounding: the double it rounds to, and what rounding
+// took off
+///////////////////////////////////////////////////////////////////////
+static void exactSum(float a, float b, double& high, double& low)
+{
+  high = (double)a + (double)b;
+  const double bRounded = high - a;
+  low = ((double)a - (high - bRounded)) + ((double)b - bRounded);
+}
+
+///////////////////////////////////////////////////////////////////////
+// for each of the "res" pixel centers "start + i * spacing", worked
+// out the way renderImage works them out, the pixel whose center adds
+// up with it to exactly a + b, or -1 if no center does
+///////////////////////////////////////////////////////////////////////
+static void partnerPixels(float start, float spacing, int res, float a, float b, vector<int>& partners)
+{
+  double sumHigh, sumLow;
+  exactSum(a, b, sumHigh, sumLow);
+
+  partners.assign(res, -1);
+  for (int i = 0; i < res; i++)
+  {
+    const float center = start + i * spacing;
+    const int nearest = (int)floor((sumHigh - center - start) / spacing + 0.5);
+    for (int j = max(nearest - 1, 0); j <= min(nearest + 1, res - 1); j++)
+    {
+      double high, low;
+      exactSum(center, start + j * spacing, high, low);
+      if (high == sumHigh && low == sumLow)
+        partners[i] = j;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// Which pixels are exact reflections of each other, as far as
+// iterateRoots goes, for these roots at this origin. Float arithmetic
+// is only symmetric in some cases:
+//
+// mirrorRows[y] is the row mirroring row y about the real axis. That
+// needs every root but the first two to be real, and those to be real
+// or each other's conjugate: conjugating every factor then gives the
+// same product, with the first two factors swapped, which is exact.
+//
+// For degree 2, (pointColumns[x], pointRows[y]) is pixel (x, y) turned
+// half way around the roots' midpoint. The two factors of one are then
+// exactly the negated factors of the other, swapped, so the first
+// iterate is the same. The first magnitude test differs, so every
+// pixel in the window has to pass it.
+//
+// Either one is only filled in where the reflected pixel center lands
+// exactly on another one, which is every row and column at power of
+// two resolutions, and some of them otherwise. Returns false if there
+// is too little to reflect to be worth it.
+///////////////////////////////////////////////////////////////////////
+static bool findSymmetry(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin,
+                         vector<int>& mirrorRows, vector<int>& pointColumns, vector<int>& pointRows)
+{
+  mirrorRows.clear();
+  pointColumns.clear();
+  pointRows.clear();
+  if (!settings.symmetry || roots.empty())
+    return false;
+
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  const float dx = 4.0f / xRes;
+  const float dy = 4.0f / yRes;
+  const float xStart = -2.0f + origin[0];
+  const float yStart = -2.0f + origin[1];
+
+  bool conjugate = true;
+  for (unsigned int x = 2; x < roots.size(); x++)
+    conjugate = conjugate && roots[x][1] == 0.0f;
+  if (roots.size() == 1)
+    conjugate = roots[0][1] == 0.0f;
+  else
+    conjugate = conjugate && ((roots[0][1] == 0.0f && roots[1][1] == 0.0f) ||
+                              (roots[0][0] == roots[1][0] && roots[0][1] == -roots[1][1]));
+  if (conjugate)
+    partnerPixels(yStart, dy, yRes, 0.0f, 0.0f, mirrorRows);
+
+  if (roots.size() == 2)
+  {
+    const double xFar = max(fabs((double)xStart), fabs((double)(xStart + (xRes - 1) * dx)));
+    const double yFar = max(fabs((double)yStart), fabs((double)(yStart + (yRes - 1) * dy)));
+    if (hypot(xFar, yFar) < settings.escapeRadius * (1.0 - 1e-6))
+    {
+      partnerPixels(xStart, dx, xRes, roots[0][0], roots[1][0], pointColumns);
+      partnerPixels(yStart, dy, yRes, roots[0][1], roots[1][1], pointRows);
+    }
+  }
+
+  // about half of the pixels with a reflection get filled in; with
+  // hardly any, the plain loop is quicker
+  const int none = -1;
+  const long long mirrored = (long long)xRes * (mirrorRows.size() - count(mirrorRows.begin(), mirrorRows.end(), none));
+  const long long turned = (long long)(pointRows.size() - count(pointRows.begin(), pointRows.end(), none)) *
+                           (pointColumns.size() - count(pointColumns.begin(), pointColumns.end(), none));
+  return (mirrored + turned) / 2 >= (long long)xRes * yRes / 16;
+}
+
+///////////////////////////////////////////////////////////////////////
+// renderImage's pixel loop, filling in from findSymmetry's reflections
+// whatever has a reflection earlier in the loop, and iterating the
+// rest. "paint" colors a pixel. Returns how many pixels were filled in.
+///////////////////////////////////////////////////////////////////////
+template <class PAINT>
+static long long renderSymmetric(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const VEC3F& origin,
+                                 const vector<int>& mirrorRows, const vector<int>& pointColumns,
+                                 const vector<int>& pointRows, FIELD_2D& field, PAINT& paint,
+                                 long long& iterations, long long& rechecked, unsigned int* histogram)
+{
+  const int xRes = settings.xRes;
+  const int yRes = settings.yRes;
+  const float dx = 4.0f / xRes;
+  const float dy = 4.0f / yRes;
+  const int maxIterations = settings.maxIterations;
+
+  long long filled = 0;
+  for (int y = 0; y < yRes; y++)
+  {
+    const int mirrorRow = mirrorRows.empty() ? -1 : mirrorRows[y];
+    const int pointRow = pointRows.empty() ? -1 : pointRows[y];
+    const int mirrorPointRow = (mirrorRow >= 0 && !pointRows.empty()) ? pointRows[mirrorRow] : -1;
+
+    for (int x = 0; x < xRes; x++)
+    {
+      const int pointColumn = pointColumns.empty() ? -1 : pointColumns[x];
+
+      int fromX = -1;
+      int fromY = -1;
+      if (mirrorRow >= 0 && mirrorRow < y)
+      {
+        fromX = x;
+        fromY = mirrorRow;
+      }
+      else if (pointColumn >= 0 && pointRow >= 0 && (pointRow < y || (pointRow == y && pointColumn < x)))
+      {
+        fromX = pointColumn;
+        fromY = pointRow;
+      }
+      else if (pointColumn >= 0 && mirrorPointRow >= 0 && (mirrorPointRow < y || (mirrorPointRow == y && pointColumn < x)))
+      {
+        fromX = pointColumn;
+        fromY = mirrorPointRow;
+      }
+
+      if (fromX >= 0)
+      {
+        field(x, y) = field(fromX, fromY);
+        filled++;
+        continue;
+      }
+
+      VEC3F center;
+      center[0] = -2.0f + origin[0] + x * dx;
+      center[1] = -2.0f + origin[1] + y * dy;
+      int totalIterations = iteratePixel(settings, center, roots, iterations, rechecked);
+      if (histogram)
+        histogram[totalIterations]++;
+      field(x, y) = (totalIterations == maxIterations) ? 1.0 : 0.0;
+    }
+  }
+
+  for (int y = 0; y < yRes; y++)
+    for (int x = 0; x < xRes; x++)
+      paint(x, y, field(x, y) == 1.0);
+  return filled;
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// Returns true if there is a shape in the image; if numCentered = 0, don't translate shape to center
+//////////////////////////////////////////////////////////////////////////////////
+bool renderImage(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const string& filename,
+                 VEC3F centerOfMass, int numCentered, ofstream& comFile, RENDER_CONTEXT& context)
+{
+  if(!comFile.is_open())
+  {
+    // erro opening center of mass info text file
+    cout << "Couldn't open the COM info file." << endl;
+  }
+
+  int xRes = settings.xRes;
+  int yRes = settings.yRes;
+  context.reserve(xRes, yRes);
+  FIELD_2D& field = context.mask();
+  unsigned char* ppmOut = context.rgb(); // the final image
+
+  float xLength = 4.0; // get standard X[-2, 2] Y[-2, 2] viewing window
+  float yLength = 4.0;
+
+  int maxIterations = settings.maxIterations;
+
+  float dx = xLength / xRes;
+  float dy = yLength / yRes;
+  float xHalf = xLength * 0.5;
+  float yHalf = yLength * 0.5;
+
+  // only keep the per-pixel counts if someone is collecting them
+  SWEEP_METRICS* metrics = sweepMetrics;
+  unsigned int* histogram = NULL;
+  if (metrics)
+  {
+    context.histogram().assign(maxIterations + 1, 0);
+    histogram = &context.histogram()[0];
+  }
+  long long iterations = 0;
+  long long rechecked = 0;
+
+  // only this call gets the supplied first pass
+  const FIELD_2D* supplied = context.supplied();
+  const long long suppliedIterations = context.suppliedIterations();
+  const vector<unsigned int>* suppliedHistogram = context.suppliedHistogram();
+  context.supply(NULL, 0, NULL);
+  if (supplied && (supplied->xRes() != xRes || supplied->yRes() != yRes || settings.mixedPrecision ||
+                   centerOfMass[0] != 0.0f || centerOfMass[1] != 0.0f))
+    supplied = NULL;
+
+  // findSymmetry's reflections, for each pass
+  vector<int> mirrorRows;
+  vector<int> pointColumns;
+  vector<int> pointRows;
+
+  // each pass re-renders with the shape's center of mass from the
+  // previous pass as the origin, until it stops moving
+  while (true)
+  {
+    VEC3F origin = centerOfMass; // origin is center of mass; first time compute, center of mass is at the standard origin of (0.0, 0.0)
+    context.addPass(origin);
+
+    // get the pixel values of the roots, changing from x[-2 x 2], y[-2 x 2] to [xRes x yRes]
+    float root1x_pixel = (roots[0][0] + xHalf - origin[0]) * (1.0 / dx);
+    float root1y_pixel = (roots[0][1] + yHalf - origin[1]) * (1.0 / dy);
+    float root2x_pixel = (roots[1][0] + xHalf - origin[0]) * (1.0 / dx);
+    float root2y_pixel = (roots[1][1] + yHalf - origin[1]) * (1.0 / dy);
+
+    bool shape = false; // hold whether there is a shape (whether there are white pixels)
+
+    // to calculate shape's center of mass
+    float xPosSum = 0.0; // sum of x values of white pixels
+    float yPosSum = 0.0; // sum of y values of white pixels
+    int numWhitePixels = 0; // number of white pixels
+
+    const FIELD_2D& previous = context.previous();
+    const bool guessing = settings.incremental && context.hasPrevious() &&
+                          previous.xRes() == xRes && previous.yRes() == yRes &&
+                          context.previousOrigin()[0] == origin[0] && context.previousOrigin()[1] == origin[1];
+    long long filledPixels = 0;
+    const bool supplying = (supplied != NULL && context.passes() == 1);
+    const bool symmetric = !supplying && findSymmetry(settings, roots, origin, mirrorRows, pointColumns, pointRows);
+    if (supplying || symmetric || guessing)
+    {
+      METRIC_TIMER timer(METRIC_RENDER);
+
+      // color one pixel, in the mask and the final image, the same way
+      // as the loop below
+      auto paint = [&](int x, int y, bool inside)
+      {
+        int pixelIndex = x + (yRes - 1 - y) * xRes;
+        const unsigned char value = inside ? 255 : 0;
+        field(x, y) = inside ? 1.0 : 0.0;
+        ppmOut[3 * pixelIndex] = value;
+        ppmOut[3 * pixelIndex + 1] = value;
+        ppmOut[3 * pixelIndex + 2] = value;
+        shape = shape || inside;
+
+        if (settings.colorRed)
+        {
+          if (((x > (root1x_pixel - 10.0f)) && (x < (root1x_pixel + 10.0f)) && (y > (root1y_pixel - 10.0f)) && (y < (root1y_pixel + 10.0f))) || ((x > (root2x_pixel - 10.0f)) && (x < (root2x_pixel + 10.0f)) && (y > (root2y_pixel - 10.0f)) && (y < (root2y_pixel + 10.0f))))
+          {
+            ppmOut[3 * pixelIndex] = 255;
+            ppmOut[3 * pixelIndex + 1] = 0;
+            ppmOut[3 * pixelIndex + 2] = 0;
+          }
+        }
+      };
+
+      // iterate one pixel and color it
+      auto shade = [&](int x, int y)
+      {
+        VEC3F center;
+        center[0] = -xHalf + origin[0] + x * dx;
+        center[1] = -yHalf + origin[1] + y * dy;
+
+        int totalIterations = iteratePixel(settings, center, roots, iterations, rechecked);
+        if (histogram)
+          histogram[totalIterations]++;
+
+        paint(x, y, totalIterations == maxIterations);
+      };
+
+      if (supplying)
+      {
+        for (int y = 0; y < yRes; y++)
+          for (int x = 0; x < xRes; x++)
+            paint(x, y, (*supplied)(x, y) == 1.0);
+        iterations += suppliedIterations;
+        if (histogram && suppliedHistogram)
+          for (int x = 0; x <= maxIterations && x < (int)suppliedHistogram->size(); x++)
+            histogram[x] += (*suppliedHistogram)[x];
+      }
+      else if (symmetric)
+        filledPixels = renderSymmetric(settings, roots, origin, mirrorRows, pointColumns, pointRows, field, paint,
+                                       iterations, rechecked, histogram);
+      else
+        filledPixels = renderFromGuess(settings, previous, roots, origin, shade, paint);
+
+      // the center of mass sums, in the same order as the loop below
+      // adds them up, so that centering comes out the same
+      if (shape && numCentered != 0)
+        for (int y = 0; y < yRes; y++)
+          for (int x = 0; x < xRes; x++)
+          {
+            if (field(x, y) != 1.0)
+              continue;
+            VEC3F center;
+            center[0] = -xHalf + origin[0] + x * dx;
+            center[1] = -yHalf + origin[1] + y * dy;
+            numWhitePixels += 1;
+            xPosSum += center[0];
+            yPosSum += center[1];
+          }
+    }
+    else
+    {
+      METRIC_TIMER timer(METRIC_RENDER);
+      for (int y = 0; y < yRes; y++)
+      {
+        for (int x = 0; x < xRes; x++)
+        {
+          // getting the center coordinate here is a little sticky
+          VEC3F center;
+          center[0] = -xHalf + origin[0] + x * dx;
+          center[1] = -yHalf + origin[1] + y * dy;
+
+          int totalIterations = iteratePixel(settings, center, roots, iterations, rechecked);
+          if (histogram)
+            histogram[totalIterations]++;
+
+          int pixelIndex = x + (yRes - 1 - y) * xRes; // calculate pixel index for pixel values array that represents the final output image, flipped so +y is up
+
+          // color accordingly
+          if (totalIterations == maxIterations)
+          {
+            field(x, y) = 1.0; // did not escape, color white
+            if (numCentered != 0)
+            {
+              // store info to calculate center of mass
+              numWhitePixels += 1; // increment total number of white pixels
+              xPosSum += center[0]; // increment sum of x positions of white pixels
+              yPosSum += center[1]; // increment sum of y positions of white pixels
+            }
+
+            // set, in final image
+            ppmOut[3 * pixelIndex] = 255;
+            ppmOut[3 * pixelIndex + 1] = 255;
+            ppmOut[3 * pixelIndex + 2] = 255;
+            shape = true; // there is a fractal shape
+          }
+          else
+          {
+            field(x, y) = 0.0; // escaped, color black
+            // set, in final image
+            ppmOut[3 * pixelIndex] = 0;
+            ppmOut[3 * pixelIndex + 1] = 0;
+            ppmOut[3 * pixelIndex + 2] = 0;
+          }
+
+          if (settings.colorRed)
+          {
+            // red square around roots to be able to see root positions
+            if (((x > (root1x_pixel - 10.0f)) && (x < (root1x_pixel + 10.0f)) && (y > (root1y_pixel - 10.0f)) && (y < (root1y_pixel + 10.0f))) || ((x > (root2x_pixel - 10.0f)) && (x < (root2x_pixel + 10.0f)) && (y > (root2y_pixel - 10.0f)) && (y < (root2y_pixel + 10.0f))))
+            {
+              // cout << "near root" << endl;
+              ppmOut[3 * pixelIndex] = 255;
+              ppmOut[3 * pixelIndex + 1] = 0;
+              ppmOut[3 * pixelIndex + 2] = 0;
+            }
+          }
+        }
+      }
+    }
+
+    context.addPixels((long long)xRes * yRes - filledPixels, filledPixels);
+    context.setIterations(iterations);
+    context.setRecheckedPixels(rechecked);
+
+    // what the next frame guesses from
+    if (settings.incremental && context.passes() == 1)
+      context.remember(origin);
+
+    if (!shape) // no fractal shape
+    {
+      if (metrics)
+        metrics->addFrame(false, context.iteratedPixels(), iterations, context.passes(), context.histogram());
+      return false;
+    }
+
+    METRIC_TIMER logTimer(METRIC_LOG);
+    comFile << filename << " COM for iteration " << numCentered << ": " << centerOfMass << endl;
+    // fractal shape exists
+    if (numCentered != 0 && numCentered < 11) // check if more than 10 passes or if not even centering the shape to start with
+    {
+      VEC3F newCenterOfMass = VEC3F((xPosSum / float(numWhitePixels)), yPosSum / float(numWhitePixels), 0.0); // calculate new center of mass
+
+      if ((abs(centerOfMass[0] - newCenterOfMass[0])) > 0.001 || abs(centerOfMass[1] - newCenterOfMass[1]) > 0.001) // check how much center of mass is changing by
+      {
+        // center of mass is still changing, so repeat rigid translation to center shape
+        centerOfMass = newCenterOfMass;
+        numCentered++;
+        continue;
+      }
+
+      // center of mass is not changing, so shape is already centered
+      comFile << filename << " centered." << endl;
+      comFile << endl; // spacer in COM text file to indicate end of this image's centering
+    }
+    else if (numCentered == 11)
+    {
+      comFile << filename << " could not be centered." << endl;
+      comFile << endl; // spacer in COM text file to indicate end of this image's centering
+    }
+    logTimer.stop();
+
+    long bytes = 3L * xRes * yRes;
+    {
+      METRIC_TIMER timer(METRIC_WRITE);
+      if (settings.imageFormat == RENDER_SETTINGS::IMAGE_PNG && settings.colorRed)
+        writePNG(filename, xRes, yRes, ppmOut, settings.png, &bytes); // output fractal shape
+      else if (settings.imageFormat == RENDER_SETTINGS::IMAGE_PNG)
+        writeMaskPNG(filename, xRes, yRes, ppmOut, settings.png, &bytes);
+      else
+        writePPM(filename, xRes, yRes, ppmOut);
+    }
+    if (metrics)
+    {
+      metrics->addBytes(bytes);
+      metrics->addFrame(true, context.iteratedPixels(), iterations, context.passes(), context.histogram());
+    }
+    return true;
+  }
+}
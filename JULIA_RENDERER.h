@@ -0,0 +1,187 @@
+#ifndef JULIA_RENDERER_H
+#define JULIA_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// The rendering kernel: iterates the polynomial whose roots are given
+// and decides which pixels of the standard X[-2, 2] Y[-2, 2] viewing
+// window belong to the fractal shape.
+//
+// Nothing in here knows about GL, so it can be linked into the headless
+// command line tool as well as the viewer.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "FIELD_2D.h"
+#include "VEC3F.h"
+
+// everything about how a sweep renders its images, other than the roots
+struct RENDER_SETTINGS {
+  RENDER_SETTINGS() :
+    xRes(800), yRes(800), colorRed(false), centerShape(0),
+    maxIterations(100), escapeRadius(200.0), imageFormat(IMAGE_PPM), incremental(false), symmetry(true),
+    mixedPrecision(false)
+  {
+  };
+
+  enum IMAGE_FORMAT { IMAGE_PPM, IMAGE_PNG };
+
+  // the extension that goes with imageFormat
+  const char* imageExtension() const { return (imageFormat == IMAGE_PNG) ? "png" : "ppm"; };
+
+  int xRes; // resolution of the output images
+  int yRes;
+  bool colorRed; // mark the first two roots with red squares
+  int centerShape; // 1 to translate the shape to the center of the image, 0 to leave it
+  int maxIterations; // a pixel that takes this many iterations without escaping is white
+  float escapeRadius; // to match the js version
+  IMAGE_FORMAT imageFormat; // PNGs are 1 bit masks, or RGB when colorRed is on
+  PNG_SETTINGS png; // how hard to compress them
+  bool incremental; // carry proven tiles over from the context's last frame; see renderImage
+  bool symmetry; // fill in the pixels that are exact reflections of others; see renderImage
+  bool mixedPrecision; // iterate again in double where float rounding could have decided; see renderImage
+};
+
+// the buffers a render writes into, kept around so that a sweep can
+// render frame after frame without going back to the heap. Give each
+// thread its own.
+class RENDER_CONTEXT {
+public:
+  RENDER_CONTEXT();
+
+  // size the buffers for an xRes x yRes image
+  void reserve(int xRes, int yRes);
+
+  // 1 where the point didn't escape, 0 where it did
+  FIELD_2D& mask() { return _mask; };
+
+  // the output image, as bottom-up RGB triples
+  unsigned char* rgb() { return &_rgb[0]; };
+
+  int xRes() const { return _xRes; };
+  int yRes() const { return _yRes; };
+
+  // how many times the last renderImage call rendered the image, which
+  // is more than once when it had to center the shape, and the origin
+  // its last pass used
+  int passes() const { return _passes; };
+  const VEC3F& origin() const { return _origin; };
+  void addPass(const VEC3F& origin) { _passes++; _origin = origin; };
+
+  // scratch space for the iteration counts when metrics are on
+  std::vector<unsigned int>& histogram() { return _histogram; };
+
+  // the first pass of the last frame, for incremental renders to guess
+  // from, and the origin it was rendered at; forget() drops it
+  const FIELD_2D& previous() const { return _previous; };
+  const VEC3F& previousOrigin() const { return _previousOrigin; };
+  bool hasPrevious() const { return _hasPrevious; };
+  void remember(const VEC3F& origin) { _previous = _mask; _previousOrigin = origin; _hasPrevious = true; };
+  void forget() { _hasPrevious = false; };
+
+  // how many pixels the last renderImage call iterated, over all of its
+  // passes, and how many it filled in without iterating them, from
+  // proven tiles or reflections
+  long long iteratedPixels() const { return _iteratedPixels; };
+  long long filledPixels() const { return _filledPixels; };
+  void addPixels(long long iterated, long long filled) { _iteratedPixels += iterated; _filledPixels += filled; };
+
+  // how many iterations the last renderImage call took, over all of its
+  // passes
+  long long iterations() const { return _iterations; };
+  void setIterations(long long iterations) { _iterations = iterations; };
+
+  // how many of the pixels the last renderImage call iterated were
+  // iterated again in double, with settings.mixedPrecision
+  long long recheckedPixels() const { return _recheckedPixels; };
+  void setRecheckedPixels(long long rechecked) { _recheckedPixels = rechecked; };
+
+  // a first pass rendered somewhere else, like renderBatch's mask, its
+  // iteration count and its iteration histogram (which can be NULL),
+  // for the next renderImage call to use instead of iterating. Only
+  // the next call takes it, and the caller keeps them alive until then.
+  void supply(const FIELD_2D* mask, long long iterations, const std::vector<unsigned int>* histogram)
+  {
+    _supplied = mask; _suppliedIterations = iterations; _suppliedHistogram = histogram;
+  };
+  const FIELD_2D* supplied() const { return _supplied; };
+  long long suppliedIterations() const { return _suppliedIterations; };
+  const std::vector<unsigned int>* suppliedHistogram() const { return _suppliedHistogram; };
+
+private:
+  int _xRes;
+  int _yRes;
+  int _passes;
+  VEC3F _origin;
+  FIELD_2D _mask;
+  std::vector<unsigned char> _rgb;
+  std::vector<unsigned int> _histogram;
+  FIELD_2D _previous;
+  VEC3F _previousOrigin;
+  bool _hasPrevious;
+  long long _iteratedPixels;
+  long long _filledPixels;
+  long long _iterations;
+  long long _recheckedPixels;
+  const FIELD_2D* _supplied;
+  long long _suppliedIterations;
+  const std::vector<unsigned int>* _suppliedHistogram;
+};
+
+// do a complex multiply
+VEC3F complexMultiply(VEC3F left, VEC3F right);
+
+// iterate the polynomial defined by "roots" starting at "center"; returns
+// the number of iterations taken before the iterate escaped or landed on
+// a root, so maxIterations means it did neither
+int iterateRoots(const VEC3F& center, const std::vector<VEC3F>& roots, int maxIterations, float escapeRadius);
+
+// iterateRoots, which also sets "nearThreshold" if float rounding
+// could have put an iterate on the other side of the escape radius or
+// of the distance that counts as landing on a root
+int iterateRootsFlagged(const VEC3F& center, const std::vector<VEC3F>& roots, int maxIterations, float escapeRadius,
+                        bool& nearThreshold);
+
+// iterateRoots in double precision, starting from the same float center
+int iterateRootsDouble(const VEC3F& center, const std::vector<VEC3F>& roots, int maxIterations, double escapeRadius);
+
+// render the image for "roots" into "context" and write it to "filename";
+// returns true if there is a shape in the image. If numCentered = 0, the
+// shape is not translated to the center.
+//
+// With settings.incremental, a pass at the same origin as the context's
+// previous frame doesn't iterate the 8 x 8 tiles that were all one
+// value in it if it can prove them: the disk around the tile's pixel
+// centers is iterated as a whole, with enough slack for float rounding,
+// and a tile whose every point must escape, or must stay, is painted
+// without touching its pixels. Everything else is iterated as usual, so
+// the image is the same as without it. Consecutive steps of a grid
+// sweep differ by a small move of one root, so most tiles far from the
+// outline carry over.
+//
+// With settings.symmetry, a pass whose roots make the image symmetric
+// about the real axis, or for degree 2 about the roots' midpoint, in a
+// way that float arithmetic reproduces exactly, iterates only one side
+// and fills in the pixels whose reflections land exactly on pixels
+// already done. That is all of them at power of two resolutions and
+// some of them otherwise; -pinned configurations with a real root are
+// the common case. The image is the same as without it, as long as
+// the compiler doesn't fuse multiplies and adds, since a fused a * d +
+// b * c rounds differently from c * b + d * a; the Makefile builds
+// every file, VEC3F's magnitude included, with -ffp-contract=off, and
+// checkSymmetry (see GOLDEN.h) checks.
+//
+// With settings.mixedPrecision, every pixel is iterated in float with
+// a running bound on its rounding error (iterateRootsFlagged), and the
+// few whose orbits came within that bound of a threshold, mostly ones
+// that wander next to the Julia set, are iterated again in double and
+// take that answer. The proofs of an incremental render hold either
+// way, and the double iteration reflects as exactly as the float one.
+//
+// A mask supplied to the context stands in for the first pass, if it
+// is at the standard origin and resolution, and the render is in float.
+bool renderImage(const RENDER_SETTINGS& settings, const std::vector<VEC3F>& roots, const std::string& filename,
+                 VEC3F centerOfMass, int numCentered, std::ofstream& comFile, RENDER_CONTEXT& context);
+
+#endif
@@ -0,0 +1,126 @@
+#include "METRICS.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+using namespace std;
+using namespace std::chrono;
+
+SWEEP_METRICS* sweepMetrics = NULL;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+SWEEP_METRICS::SWEEP_METRICS(const string& filename, double intervalSeconds) :
+  _filename(filename), _intervalSeconds(intervalSeconds),
+  _accepted(0), _rejected(0), _skipped(0), _pixels(0), _iterations(0), _passes(0), _maxPasses(0), _bytes(0)
+{
+  _start = _lastWrite = steady_clock::now();
+  for (int x = 0; x < TOTAL_METRIC_STAGES; x++)
+    _seconds[x] = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void SWEEP_METRICS::addFrame(bool accepted, long long pixels, long long iterations, int passes,
+                             const vector<unsigned int>& histogram)
+{
+  {
+    lock_guard<mutex> lock(_mutex);
+    if (accepted)
+      _accepted++;
+    else
+      _rejected++;
+    _pixels += pixels;
+    _iterations += iterations;
+    _passes += passes;
+    if (passes > _maxPasses)
+      _maxPasses = passes;
+
+    if (_histogram.size() < histogram.size())
+      _histogram.resize(histogram.size(), 0);
+    for (unsigned int x = 0; x < histogram.size(); x++)
+      _histogram[x] += histogram[x];
+  }
+  update();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void SWEEP_METRICS::addSkipped()
+{
+  {
+    lock_guard<mutex> lock(_mutex);
+    _skipped++;
+  }
+  update();
+}
+
+void SWEEP_METRICS::addTime(METRIC_STAGE stage, double seconds)
+{
+  lock_guard<mutex> lock(_mutex);
+  _seconds[stage] += seconds;
+}
+
+void SWEEP_METRICS::addBytes(long long bytes)
+{
+  lock_guard<mutex> lock(_mutex);
+  _bytes += bytes;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void SWEEP_METRICS::update()
+{
+  {
+    lock_guard<mutex> lock(_mutex);
+    if (duration<double>(steady_clock::now() - _lastWrite).count() < _intervalSeconds)
+      return;
+  }
+  write(false);
+}
+
+///////////////////////////////////////////////////////////////////////
+// write to a scratch file and move it over the old one, so whatever is
+// watching the file never sees half of it
+///////////////////////////////////////////////////////////////////////
+void SWEEP_METRICS::write(bool final)
+{
+  lock_guard<mutex> lock(_mutex);
+  _lastWrite = steady_clock::now();
+
+  const long long frames = _accepted + _rejected;
+  const string scratch = _filename + ".tmp";
+  ofstream out(scratch.c_str());
+  if (!out.is_open())
+  {
+    cout << "Couldn't open " << scratch << " for writing metrics." << endl;
+    return;
+  }
+
+  out << "{" << endl;
+  out << "  \"final\": " << (final ? "true" : "false") << "," << endl;
+  out << "  \"elapsedSeconds\": " << duration<double>(_lastWrite - _start).count() << "," << endl;
+  out << "  \"combinationsTried\": " << frames << "," << endl;
+  out << "  \"combinationsAccepted\": " << _accepted << "," << endl;
+  out << "  \"combinationsRejected\": " << _rejected << "," << endl;
+  out << "  \"combinationsSkipped\": " << _skipped << "," << endl;
+  out << "  \"pixelsIterated\": " << _pixels << "," << endl;
+  out << "  \"totalIterations\": " << _iterations << "," << endl;
+  out << "  \"iterationsPerPixel\": " << ((_pixels > 0) ? (double)_iterations / _pixels : 0.0) << "," << endl;
+  out << "  \"centeringPasses\": " << _passes << "," << endl;
+  out << "  \"centeringPassesPerFrame\": " << ((frames > 0) ? (double)_passes / frames : 0.0) << "," << endl;
+  out << "  \"maxCenteringPasses\": " << _maxPasses << "," << endl;
+  out << "  \"renderSeconds\": " << _seconds[METRIC_RENDER] << "," << endl;
+  out << "  \"writeSeconds\": " << _seconds[METRIC_WRITE] << "," << endl;
+  out << "  \"logSeconds\": " << _seconds[METRIC_LOG] << "," << endl;
+  out << "  \"classifySeconds\": " << _seconds[METRIC_CLASSIFY] << "," << endl;
+  out << "  \"bytesWritten\": " << _bytes << "," << endl;
+  out << "  \"iterationHistogram\": [";
+  for (unsigned int x = 0; x < _histogram.size(); x++)
+    out << ((x > 0) ? ", " : "") << _histogram[x];
+  out << "]" << endl;
+  out << "}" << endl;
+  out.close();
+
+  rename(scratch.c_str(), _filename.c_str());
+}
@@ -0,0 +1,89 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+///////////////////////////////////////////////////////////////////////
+// Counters and timers for long sweeps, written out as a JSON file every
+// few seconds and once more when the sweep finishes.
+//
+// Metrics are off unless a SWEEP_METRICS has been installed in
+// "sweepMetrics". The hot paths only test that pointer, and renderImage
+// adds up its counts per frame before handing them over, so leaving
+// metrics off costs next to nothing.
+///////////////////////////////////////////////////////////////////////
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+// where the time goes
+enum METRIC_STAGE { METRIC_RENDER, METRIC_WRITE, METRIC_LOG, METRIC_CLASSIFY, TOTAL_METRIC_STAGES };
+
+class SWEEP_METRICS {
+public:
+  // write to "filename" at most every "intervalSeconds"
+  SWEEP_METRICS(const std::string& filename, double intervalSeconds = 10.0);
+
+  // one renderImage call: did it find a shape, how many pixels it
+  // iterated over all of its passes, and how many iterations they took.
+  // histogram[i] is the number of pixels that took i iterations.
+  void addFrame(bool accepted, long long pixels, long long iterations, int passes,
+                const std::vector<unsigned int>& histogram);
+
+  // a combination the critical orbit test held back; deferred ones
+  // are counted again when they do get rendered
+  void addSkipped();
+
+  void addTime(METRIC_STAGE stage, double seconds);
+  void addBytes(long long bytes);
+
+  // write the file if the interval is up
+  void update();
+
+  // write the file now; "final" marks the last one of the sweep
+  void write(bool final);
+
+private:
+  std::string _filename;
+  double _intervalSeconds;
+  std::chrono::steady_clock::time_point _start;
+  std::chrono::steady_clock::time_point _lastWrite;
+
+  std::mutex _mutex;
+  long long _accepted;
+  long long _rejected;
+  long long _skipped;
+  long long _pixels;
+  long long _iterations;
+  long long _passes;
+  int _maxPasses;
+  long long _bytes;
+  double _seconds[TOTAL_METRIC_STAGES];
+  std::vector<long long> _histogram;
+};
+
+// the metrics being collected, or NULL if they're off
+extern SWEEP_METRICS* sweepMetrics;
+
+// adds the time spent in its scope to a stage, if metrics are on
+class METRIC_TIMER {
+public:
+  METRIC_TIMER(METRIC_STAGE stage) : _stage(stage), _metrics(sweepMetrics) {
+    if (_metrics) _start = std::chrono::steady_clock::now();
+  };
+  ~METRIC_TIMER() { stop(); };
+
+  // stop early instead of at the end of the scope
+  void stop() {
+    if (_metrics)
+      _metrics->addTime(_stage, std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count());
+    _metrics = NULL;
+  };
+
+private:
+  METRIC_STAGE _stage;
+  SWEEP_METRICS* _metrics;
+  std::chrono::steady_clock::time_point _start;
+};
+
+#endif
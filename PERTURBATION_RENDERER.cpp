@@ -0,0 +1,192 @@
+#include "PERTURBATION_RENDERER.h"
+#include "POLYNOMIAL.h"
+#include <cmath>
+
+using namespace std;
+
+// an orbit within this fraction of a critical point's distance from the
+// reference has glitched
+static const double glitchTolerance = 1e-3;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+PERTURBATION_RENDERER::PERTURBATION_RENDERER(const vector<VEC3F>& roots, long double xCenter, long double yCenter,
+                                             int maxIterations, float escapeRadius) :
+  _roots(roots), _maxIterations(maxIterations), _escapeRadius(escapeRadius)
+{
+  // the roots of the derivative, divided by the degree so that it stays
+  // monic
+  const int degree = roots.size();
+  if (degree >= 2)
+  {
+    vector<COMPLEX> coefficients;
+    expandRoots(roots, coefficients);
+    vector<COMPLEX> derivative(degree);
+    for (int i = 0; i < degree; i++)
+      derivative[i] = coefficients[i + 1] * (double)(i + 1) / (double)degree;
+
+    vector<COMPLEX> points;
+    solveMonic(derivative, points);
+    for (unsigned int i = 0; i < points.size(); i++)
+    {
+      _criticalX.push_back(points[i].real());
+      _criticalY.push_back(points[i].imag());
+    }
+  }
+
+  _references.resize(1 + _criticalX.size());
+  buildReference(xCenter, yCenter, _references[0]);
+  for (unsigned int j = 0; j < _criticalX.size(); j++)
+    buildReference(_criticalX[j], _criticalY[j], _references[1 + j]);
+}
+
+///////////////////////////////////////////////////////////////////////
+// iterate "start" in long double with iterateRoots' exits, but always
+// take at least one step, so that there is something to rebase onto
+///////////////////////////////////////////////////////////////////////
+void PERTURBATION_RENDERER::buildReference(long double startX, long double startY, REFERENCE& reference)
+{
+  const int degree = _roots.size();
+  const int critical = _criticalX.size();
+
+  long double zX = startX;
+  long double zY = startY;
+  int length = 0;
+  while (true)
+  {
+    reference.zX.push_back((double)zX);
+    reference.zY.push_back((double)zY);
+    reference.fromStartX.push_back((double)(zX - startX));
+    reference.fromStartY.push_back((double)(zY - startY));
+    for (int j = 0; j < critical; j++)
+    {
+      const long double toX = zX - _criticalX[j];
+      const long double toY = zY - _criticalY[j];
+      reference.toCriticalX.push_back((double)toX);
+      reference.toCriticalY.push_back((double)toY);
+      reference.glitchSq.push_back((double)((toX * toX + toY * toY) * (glitchTolerance * glitchTolerance)));
+    }
+
+    const long double magnitude = sqrt(zX * zX + zY * zY);
+    if (length == _maxIterations || (length > 0 && (magnitude > _escapeRadius || magnitude < 1e-7)) ||
+        !(magnitude == magnitude))
+      break;
+
+    long double gX = 1.0;
+    long double gY = 0.0;
+    for (int k = 0; k < degree; k++)
+    {
+      const long double factorX = zX - _roots[k][0];
+      const long double factorY = zY - _roots[k][1];
+      reference.factorX.push_back((double)factorX);
+      reference.factorY.push_back((double)factorY);
+      reference.partialX.push_back((double)gX);
+      reference.partialY.push_back((double)gY);
+
+      const long double productX = gX * factorX - gY * factorY;
+      const long double productY = gX * factorY + gY * factorX;
+      gX = productX;
+      gY = productY;
+    }
+    zX = gX;
+    zY = gY;
+    length++;
+  }
+  reference.length = length;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+int PERTURBATION_RENDERER::iterate(double xOffset, double yOffset, int* rebases, int* glitches) const
+{
+  const int degree = _roots.size();
+  const int critical = _criticalX.size();
+  const double escapeRadius = _escapeRadius;
+
+  const REFERENCE* reference = &_references[0];
+  int step = 0;
+  double offsetX = xOffset;
+  double offsetY = yOffset;
+  int totalRebases = 0;
+  int totalGlitches = 0;
+
+  double zX = reference->zX[0] + offsetX;
+  double zY = reference->zY[0] + offsetY;
+  double magnitude = sqrt(zX * zX + zY * zY);
+  int totalIterations = 0;
+  while (magnitude < escapeRadius && totalIterations < _maxIterations)
+  {
+    // the difference between p at the pixel and p at the reference,
+    // one factor at a time
+    double differenceX = 0.0;
+    double differenceY = 0.0;
+    const int first = step * degree;
+    for (int k = 0; k < degree; k++)
+    {
+      const double factorX = reference->factorX[first + k] + offsetX;
+      const double factorY = reference->factorY[first + k] + offsetY;
+      const double partialX = reference->partialX[first + k];
+      const double partialY = reference->partialY[first + k];
+      const double nextX = differenceX * factorX - differenceY * factorY + partialX * offsetX - partialY * offsetY;
+      const double nextY = differenceX * factorY + differenceY * factorX + partialX * offsetY + partialY * offsetX;
+      differenceX = nextX;
+      differenceY = nextY;
+    }
+    offsetX = differenceX;
+    offsetY = differenceY;
+    step++;
+
+    zX = reference->zX[step] + offsetX;
+    zY = reference->zY[step] + offsetY;
+    magnitude = sqrt(zX * zX + zY * zY);
+    totalIterations++;
+
+    // exit conditions
+    if (magnitude > escapeRadius)
+      break;
+    if (magnitude < 1e-7)
+      break;
+
+    // glitched next to a critical point: carry on from its orbit
+    bool rebased = false;
+    const int index = step * critical;
+    for (int j = 0; j < critical && !rebased; j++)
+    {
+      const double toX = reference->toCriticalX[index + j] + offsetX;
+      const double toY = reference->toCriticalY[index + j] + offsetY;
+      if (toX * toX + toY * toY < reference->glitchSq[index + j])
+      {
+        reference = &_references[1 + j];
+        offsetX = toX;
+        offsetY = toY;
+        step = 0;
+        rebased = true;
+        totalGlitches++;
+      }
+    }
+    if (rebased)
+    {
+      totalRebases++;
+      continue;
+    }
+
+    // closer to the start of the reference than to the reference, or
+    // past its end: carry on from the start
+    const double fromStartX = reference->fromStartX[step] + offsetX;
+    const double fromStartY = reference->fromStartY[step] + offsetY;
+    if (step == reference->length ||
+        fromStartX * fromStartX + fromStartY * fromStartY < offsetX * offsetX + offsetY * offsetY)
+    {
+      offsetX = fromStartX;
+      offsetY = fromStartY;
+      step = 0;
+      totalRebases++;
+    }
+  }
+
+  if (rebases)
+    *rebases = totalRebases;
+  if (glitches)
+    *glitches = totalGlitches;
+  return totalIterations;
+}
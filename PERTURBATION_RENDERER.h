@@ -0,0 +1,87 @@
+#ifndef PERTURBATION_RENDERER_H
+#define PERTURBATION_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// Iterates the points of a deep zoom as offsets from a reference orbit.
+//
+// Past a magnification of about 1e-5, float can't tell neighbouring
+// pixels apart, and past about 1e-13 neither can double. Instead, the
+// orbit Z of the view's center is iterated once in long double, and a
+// pixel z = Z + d only carries its offset d, in double:
+//
+//   d' = p(Z + d) - p(Z)
+//
+// The product form of p gives that without cancellation. With g_k the
+// product of the first k factors,
+//
+//   g_k(Z + d) - g_k(Z) = (g_k-1(Z + d) - g_k-1(Z)) (Z - root_k + d) + g_k-1(Z) d
+//
+// and the reference keeps Z - root_k and g_k-1(Z) for every step, so a
+// pixel's step costs about what one of iterateRoots' does.
+//
+// The offset only stays accurate while it is small next to the orbit's
+// distance from the critical points, where p folds the plane over. An
+// orbit that comes much closer to a critical point than its reference
+// does would lose its digits there (a glitch), so it is rebased onto a
+// reference orbit started at that critical point. An orbit that gets
+// closer to its reference's start than to the reference itself, or
+// outlives the reference, is rebased onto the start of it, the way
+// Zhuoran's rebasing does it for the Mandelbrot set.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "VEC3F.h"
+
+class PERTURBATION_RENDERER {
+public:
+  // the reference orbits of (xCenter, yCenter) and of every critical
+  // point of the polynomial with "roots"
+  PERTURBATION_RENDERER(const std::vector<VEC3F>& roots, long double xCenter, long double yCenter,
+                        int maxIterations, float escapeRadius);
+
+  // what iterateRoots would return for the point (xOffset, yOffset)
+  // away from the center, if it had the precision. If given, "rebases"
+  // gets how many times the orbit was rebased and "glitches" how many
+  // of those were onto a critical point.
+  int iterate(double xOffset, double yOffset, int* rebases = NULL, int* glitches = NULL) const;
+
+  int maxIterations() const { return _maxIterations; };
+
+  // how many steps the center's orbit took before it escaped, landed on
+  // zero or ran out of iterations
+  int referenceLength() const { return _references[0].length; };
+
+private:
+  // one orbit, with everything a pixel step needs from it. Step n uses
+  // factor and partial [n * degree + k], for n up to length - 1; the
+  // rest go up to length.
+  struct REFERENCE {
+    int length;
+    std::vector<double> zX; // the orbit, rounded to double
+    std::vector<double> zY;
+    std::vector<double> factorX; // Z - root_k
+    std::vector<double> factorY;
+    std::vector<double> partialX; // g_k-1(Z)
+    std::vector<double> partialY;
+    std::vector<double> fromStartX; // Z - the orbit's start
+    std::vector<double> fromStartY;
+    std::vector<double> toCriticalX; // Z - critical point j, at [n * critical + j]
+    std::vector<double> toCriticalY;
+    std::vector<double> glitchSq; // how close to critical point j is a glitch, squared
+  };
+
+  void buildReference(long double startX, long double startY, REFERENCE& reference);
+
+  std::vector<VEC3F> _roots;
+  int _maxIterations;
+  float _escapeRadius;
+
+  // the critical points, in double
+  std::vector<double> _criticalX;
+  std::vector<double> _criticalY;
+
+  // the center's orbit, then one per critical point
+  std::vector<REFERENCE> _references;
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "PNG_FILE.h"
+#include <png.h>
+#include <zlib.h>
+#include <vector>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+PNG_WRITER::PNG_WRITER() :
+  _file(NULL), _png(NULL), _info(NULL), _height(0), _rowsWritten(0), _bytes(0)
+{
+}
+
+PNG_WRITER::~PNG_WRITER()
+{
+  destroy();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void PNG_WRITER::destroy()
+{
+  if (_png)
+  {
+    png_structp png = _png;
+    png_infop info = _info;
+    png_destroy_write_struct(&png, info ? &info : NULL);
+  }
+  _png = NULL;
+  _info = NULL;
+  if (_file)
+    fclose(_file);
+  _file = NULL;
+}
+
+bool PNG_WRITER::fail(const string& error)
+{
+  if (_error.empty())
+    _error = error;
+  destroy();
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool PNG_WRITER::open(const string& filename, int width, int height, int channels, int bitDepth,
+                      const PNG_SETTINGS& settings)
+{
+  destroy();
+  _filename = filename;
+  _error.clear();
+  _height = height;
+  _rowsWritten = 0;
+  _bytes = 0;
+
+  _file = fopen(filename.c_str(), "wb");
+  if (_file == NULL)
+    return fail("couldn't open " + filename + " for writing");
+
+  _png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+  if (_png)
+    _info = png_create_info_struct(_png);
+  if (!_png || !_info)
+    return fail("couldn't start libpng");
+
+  if (setjmp(png_jmpbuf(_png)))
+    return fail("libpng failed writing the header of " + filename);
+
+  png_init_io(_png, _file);
+  png_set_IHDR(_png, _info, width, height, bitDepth,
+               (channels == 3) ? PNG_COLOR_TYPE_RGB : PNG_COLOR_TYPE_GRAY,
+               PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+
+  png_set_compression_level(_png, settings.level);
+  if (settings.fast)
+  {
+    png_set_filter(_png, PNG_FILTER_TYPE_BASE, PNG_FILTER_NONE);
+    png_set_compression_strategy(_png, Z_RLE);
+  }
+  else
+  {
+    png_set_filter(_png, PNG_FILTER_TYPE_BASE, PNG_ALL_FILTERS);
+    png_set_compression_strategy(_png, Z_DEFAULT_STRATEGY);
+  }
+
+  png_write_info(_png, _info);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool PNG_WRITER::writeRow(const unsigned char* row)
+{
+  if (!_png)
+    return fail("png file isn't open");
+  if (_rowsWritten >= _height)
+    return fail("more rows than the image has");
+
+  if (setjmp(png_jmpbuf(_png)))
+    return fail("libpng failed writing " + _filename);
+
+  png_write_row(_png, (png_const_bytep)row);
+  _rowsWritten++;
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool PNG_WRITER::close()
+{
+  if (!_png)
+    return fail("png file isn't open");
+  if (_rowsWritten != _height)
+    return fail("only " + to_string(_rowsWritten) + " of " + to_string(_height) + " rows were written");
+
+  if (setjmp(png_jmpbuf(_png)))
+    return fail("libpng failed finishing " + _filename);
+  png_write_end(_png, NULL);
+
+  fflush(_file);
+  _bytes = ftell(_file);
+  const bool closed = (fclose(_file) == 0);
+  _file = NULL;
+  destroy();
+
+  if (!closed)
+    return fail("couldn't close " + _filename);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool writePNG(const string& filename, int xRes, int yRes, const unsigned char* pixels,
+              const PNG_SETTINGS& settings, long* bytes)
+{
+  PNG_WRITER writer;
+  bool success = writer.open(filename, xRes, yRes, 3, 8, settings);
+  for (int y = 0; success && y < yRes; y++)
+    success = writer.writeRow(pixels + 3 * xRes * y);
+  success = success && writer.close();
+
+  if (!success)
+    printf("[write_png_file] %s\n", writer.error().c_str());
+  if (bytes)
+    *bytes = writer.bytes();
+  return success;
+}
+
+///////////////////////////////////////////////////////////////////////
+// pack each row into one reused buffer on its way out
+///////////////////////////////////////////////////////////////////////
+bool writeMaskPNG(const string& filename, int xRes, int yRes, const unsigned char* pixels,
+                  const PNG_SETTINGS& settings, long* bytes)
+{
+  vector<unsigned char> row((xRes + 7) / 8);
+
+  PNG_WRITER writer;
+  bool success = writer.open(filename, xRes, yRes, 1, 1, settings);
+  for (int y = 0; success && y < yRes; y++)
+  {
+    const unsigned char* rgb = pixels + 3 * xRes * y;
+    for (unsigned int x = 0; x < row.size(); x++)
+      row[x] = 0;
+    for (int x = 0; x < xRes; x++)
+      row[x >> 3] |= (rgb[3 * x] >> 7) << (7 - (x & 7));
+    success = writer.writeRow(&row[0]);
+  }
+  success = success && writer.close();
+
+  if (!success)
+    printf("[write_png_file] %s\n", writer.error().c_str());
+  if (bytes)
+    *bytes = writer.bytes();
+  return success;
+}
@@ -0,0 +1,79 @@
+#ifndef PNG_FILE_H
+#define PNG_FILE_H
+
+///////////////////////////////////////////////////////////////////////
+// Streaming PNG output, one row at a time, so nothing bigger than a row
+// is ever buffered on our side.
+//
+// The settings trade speed for size: "fast" turns off libpng's row
+// filters and uses run-length zlib matching, which is what black and
+// white masks want anyway; otherwise every filter is tried per row with
+// the default zlib strategy. "level" is the zlib level, 0 to 9.
+///////////////////////////////////////////////////////////////////////
+
+#include <cstdio>
+#include <string>
+
+struct PNG_SETTINGS {
+  PNG_SETTINGS() : level(6), fast(false) {};
+
+  static PNG_SETTINGS fastest() { PNG_SETTINGS settings; settings.level = 1; settings.fast = true; return settings; };
+  static PNG_SETTINGS smallest() { PNG_SETTINGS settings; settings.level = 9; settings.fast = false; return settings; };
+
+  int level;
+  bool fast;
+};
+
+// libpng's state, without dragging png.h into everything
+struct png_struct_def;
+struct png_info_def;
+
+class PNG_WRITER {
+public:
+  PNG_WRITER();
+  ~PNG_WRITER();
+
+  // start a width x height image; "channels" is 1 for gray or 3 for RGB,
+  // and "bitDepth" is 1 or 8. 1 bit rows are packed high bit first, 1
+  // is white.
+  bool open(const std::string& filename, int width, int height, int channels, int bitDepth,
+            const PNG_SETTINGS& settings = PNG_SETTINGS());
+
+  // the next row, top row first
+  bool writeRow(const unsigned char* row);
+
+  // finish the file; false if rows are missing or anything failed
+  bool close();
+
+  // size of the finished file
+  long bytes() const { return _bytes; };
+
+  const std::string& error() const { return _error; };
+
+private:
+  bool fail(const std::string& error);
+  void destroy();
+
+  FILE* _file;
+  png_struct_def* _png;
+  png_info_def* _info;
+  int _height;
+  int _rowsWritten;
+  long _bytes;
+  std::string _filename;
+  std::string _error;
+
+  PNG_WRITER(const PNG_WRITER&);
+  PNG_WRITER& operator=(const PNG_WRITER&);
+};
+
+// RGB triples, top row first, the same layout writePPM takes
+bool writePNG(const std::string& filename, int xRes, int yRes, const unsigned char* pixels,
+              const PNG_SETTINGS& settings = PNG_SETTINGS(), long* bytes = NULL);
+
+// the same layout, written as a 1 bit mask that is white wherever the
+// red channel is
+bool writeMaskPNG(const std::string& filename, int xRes, int yRes, const unsigned char* pixels,
+                  const PNG_SETTINGS& settings = PNG_SETTINGS(), long* bytes = NULL);
+
+#endif
@@ -0,0 +1,104 @@
+#include "POLYNOMIAL.h"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void expandRoots(const vector<VEC3F>& roots, vector<COMPLEX>& coefficients)
+{
+  coefficients.assign(1, COMPLEX(1.0, 0.0));
+  for (unsigned int x = 0; x < roots.size(); x++)
+  {
+    const COMPLEX root(roots[x][0], roots[x][1]);
+    coefficients.push_back(COMPLEX(0.0, 0.0));
+    for (int i = coefficients.size() - 1; i > 0; i--)
+      coefficients[i] = coefficients[i - 1] - root * coefficients[i];
+    coefficients[0] = -root * coefficients[0];
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// Durand-Kerner starts from a spiral that is big enough to hold every
+// root and moves them all at once
+///////////////////////////////////////////////////////////////////////
+void solveMonic(const vector<COMPLEX>& coefficients, vector<COMPLEX>& roots)
+{
+  const int degree = coefficients.size() - 1;
+  roots.clear();
+  if (degree < 1)
+    return;
+
+  if (degree == 1)
+  {
+    roots.push_back(-coefficients[0]);
+    return;
+  }
+
+  if (degree == 2)
+  {
+    const COMPLEX b = coefficients[1];
+    const COMPLEX root = sqrt(b * b - 4.0 * coefficients[0]);
+
+    // pick the sign that doesn't cancel, and get the other root from the
+    // product, which is coefficients[0]
+    const COMPLEX first = (real(conj(b) * root) >= 0.0) ? -0.5 * (b + root) : -0.5 * (b - root);
+    roots.push_back(first);
+    roots.push_back((abs(first) > 0.0) ? coefficients[0] / first : -b - first);
+    return;
+  }
+
+  double radius = 1.0;
+  for (int i = 0; i < degree; i++)
+    radius = max(radius, 1.0 + abs(coefficients[i]));
+  roots.resize(degree);
+  COMPLEX spiral(0.4, 0.9);
+  COMPLEX power(1.0, 0.0);
+  for (int i = 0; i < degree; i++)
+  {
+    roots[i] = radius * power / abs(power);
+    power *= spiral;
+  }
+
+  for (int iteration = 0; iteration < 500; iteration++)
+  {
+    double change = 0.0;
+    for (int i = 0; i < degree; i++)
+    {
+      COMPLEX denominator(1.0, 0.0);
+      for (int j = 0; j < degree; j++)
+        if (j != i)
+          denominator *= roots[i] - roots[j];
+
+      // repeated roots can land two guesses on top of each other
+      if (abs(denominator) < 1e-300)
+        continue;
+
+      const COMPLEX step = evaluate(coefficients, roots[i]) / denominator;
+      roots[i] -= step;
+      change = max(change, abs(step));
+    }
+    if (change < 1e-14 * radius)
+      break;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// Horner's rule
+///////////////////////////////////////////////////////////////////////
+COMPLEX evaluate(const vector<COMPLEX>& coefficients, const COMPLEX& z)
+{
+  COMPLEX value(0.0, 0.0);
+  for (int i = coefficients.size() - 1; i >= 0; i--)
+    value = value * z + coefficients[i];
+  return value;
+}
+
+COMPLEX evaluateDerivative(const vector<COMPLEX>& coefficients, const COMPLEX& z)
+{
+  COMPLEX value(0.0, 0.0);
+  for (int i = coefficients.size() - 1; i >= 1; i--)
+    value = value * z + coefficients[i] * (double)i;
+  return value;
+}
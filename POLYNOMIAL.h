@@ -0,0 +1,27 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+///////////////////////////////////////////////////////////////////////
+// Double precision helpers for the polynomials the renderers iterate,
+// which are always monic and given by their roots. Coefficients are
+// lowest power first, so coefficients[i] goes with z^i.
+///////////////////////////////////////////////////////////////////////
+
+#include <complex>
+#include <vector>
+#include "VEC3F.h"
+
+typedef std::complex<double> COMPLEX;
+
+// multiply out (z - roots[0]) (z - roots[1]) ...
+void expandRoots(const std::vector<VEC3F>& roots, std::vector<COMPLEX>& coefficients);
+
+// every root of the monic polynomial with "coefficients", repeated ones
+// included: directly up to quadratics, and with Durand-Kerner past that
+void solveMonic(const std::vector<COMPLEX>& coefficients, std::vector<COMPLEX>& roots);
+
+// the polynomial and its derivative at "z"
+COMPLEX evaluate(const std::vector<COMPLEX>& coefficients, const COMPLEX& z);
+COMPLEX evaluateDerivative(const std::vector<COMPLEX>& coefficients, const COMPLEX& z);
+
+#endif
@@ -0,0 +1,90 @@
+#include "PPM_FILE.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+//////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+void writePPM(const string &filename, int &xRes, int &yRes, const float *values)
+{
+  int totalCells = xRes * yRes;
+  vector<unsigned char> pixels(3 * totalCells);
+  for (int i = 0; i < 3 * totalCells; i++)
+    pixels[i] = values[i];
+
+  writePPM(filename, xRes, yRes, &pixels[0]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////
+void writePPM(const string &filename, int xRes, int yRes, const unsigned char *pixels)
+{
+  int totalCells = xRes * yRes;
+
+  FILE *fp;
+  fp = fopen(filename.c_str(), "wb");
+  if (fp == NULL)
+  {
+    cout << " Could not open file \"" << filename.c_str() << "\" for writing." << endl;
+    cout << " Make sure you're not trying to write from a weird location or with a " << endl;
+    cout << " strange filename. Bailing ... " << endl;
+    exit(0);
+  }
+
+  fprintf(fp, "P6\n%d %d\n255\n", xRes, yRes);
+  fwrite(pixels, 1, totalCells * 3, fp);
+  fclose(fp);
+}
+
+//////////////////////////////////////////////////////////////////////////////////
+// Read in a raw PPM file of the "P6" style.
+//
+// Input: "filename" is the name of the file you want to read in
+// Output: "pixels" will point to an array of pixel values
+//         "width" will be the width of the image
+//         "height" will be the height of the image
+//
+// The PPM file format is:
+//
+//   P6
+//   <image width> <image height>
+//   255
+//   <raw, 8-bit binary stream of RGB values>
+//
+// Open one in a text editor to see for yourself.
+//
+//////////////////////////////////////////////////////////////////////////////////
+bool readPPM(const char* filename, unsigned char*& pixels, int& width, int& height, bool verbose)
+{
+  // try to open the file
+  FILE* file;
+  file = fopen(filename, "rb");
+  if (file == NULL)
+  {
+    cout << " Couldn't open file " << filename << "! " << endl;
+    return false; 
+  }
+
+  // get the dimensions
+  unsigned char newline;
+  if (fscanf(file, "P6\n%d %d\n255%c", &width, &height, &newline) != 3 || newline != '\n') {
+    cout << " The header of " << filename << " may be improperly formatted." << endl;
+    cout << " The program will continue, but you may want to check your input. " << endl;
+  }
+  int totalPixels = width * height;
+
+  // allocate three times as many pixels since there are R,G, and B channels
+  pixels = new unsigned char[3 * totalPixels];
+  if (fread(pixels, 1, 3 * totalPixels, file) != (size_t)(3 * totalPixels))
+    cout << " " << filename << " is shorter than its header says." << endl;
+  fclose(file);
+  
+  // output some success information
+  if (verbose)
+    cout << " Successfully read in " << filename << " with dimensions: " 
+         << width << " " << height << endl;
+  return true;
+}
@@ -0,0 +1,16 @@
+#ifndef PPM_FILE_H
+#define PPM_FILE_H
+
+#include <string>
+
+// write out a raw "P6" PPM file; "values" holds xRes * yRes RGB triples in [0, 255]
+void writePPM(const std::string& filename, int& xRes, int& yRes, const float* values);
+
+// same, but straight from bytes, so there's no conversion buffer
+void writePPM(const std::string& filename, int xRes, int yRes, const unsigned char* pixels);
+
+// read a raw "P6" PPM file into a newly allocated "pixels", which the
+// caller deletes; "verbose" reports every successful read on stdout
+bool readPPM(const char* filename, unsigned char*& pixels, int& width, int& height, bool verbose = true);
+
+#endif
@@ -6,7 +6,9 @@
 // (it will set dimensions based on the first frame passed in)
 // and "writeMovie" to write the MOV out when you're done.
 //
-// Or, to grab a frame from GL, call "addFrameGL"
+// Or, to grab a frame from GL, call "addFrameGL". Define
+// QUICKTIME_MOVIE_NO_GL before including this to leave that out, so
+// programs without a display don't have to link against GL.
 ///////////////////////////////////////////////////////////////////////
 
 #ifndef QUICKTIME_MOVIE_H
@@ -26,15 +28,16 @@
 
 
 // enables OpenGL screengrabs
+#ifndef QUICKTIME_MOVIE_NO_GL
 #if _WIN32
 #include <gl/glut.h>
 #elif __APPLE__
 #include <GLUT/glut.h>
 #else
-#include <GL/gl.h>
-#include <GL/glu.h>
+#include <GL/glut.h>
 #include <arpa/inet.h>
 #endif
+#endif
 
 typedef unsigned int uint;
 typedef unsigned short ushort;
@@ -143,6 +146,7 @@ public:
     _totalFrames++;
   }
 
+#ifndef QUICKTIME_MOVIE_NO_GL
     ////////////////////////////////////////////////////////////////////////
   // Grab the current OpenGL frame and add it to the movie
   //
@@ -194,6 +198,7 @@ public:
 
     _totalFrames++;
   }
+#endif
 
   ////////////////////////////////////////////////////////////////////////
   // dump out the final movie
@@ -0,0 +1,64 @@
+#include "SHAPE_COMPARE.h"
+
+///////////////////////////////////////////////////////////////////////
+// The possible matches are the larger of the two images' pixel counts
+// of each color
+///////////////////////////////////////////////////////////////////////
+void scoreShapes(const unsigned char* reference, const unsigned char* image, int width, int height, SHAPE_SCORE& score)
+{
+  int refWhitePixels = 0; // total number of white pixels in the reference image
+  int imgWhitePixels = 0; // total number of white pixels in the uncategorized image
+  int refBlackPixels = 0; // total number of black pixels in the reference image
+  int imgBlackPixels = 0; // total number of black pixels in the uncategorized image
+
+  int pixelWhiteMatches = 0; // white pixel matches between the reference image and the image to categorize
+  int reflectedPixelWhiteMatches = 0; // the same, with the image to categorize reflected across the y axis
+  int pixelBlackMatches = 0; // black pixel matches between the reference image and the image to categorize
+  int reflectedPixelBlackMatches = 0; // the same, with the image to categorize reflected across the y axis
+
+  for (int y = 0; y < height; y++)
+  {
+    const unsigned char* referenceRow = reference + 3 * (height - 1 - y) * width;
+    const unsigned char* imageRow = image + 3 * (height - 1 - y) * width;
+
+    for (int x = 0; x < width; x++)
+    {
+      const unsigned char* ref = referenceRow + 3 * x;
+      const unsigned char* img = imageRow + 3 * x;
+      const unsigned char* reflected = imageRow + 3 * (width - 1 - x);
+
+      if (ref[0] == 255) refWhitePixels++;
+      if (img[0] == 255) imgWhitePixels++;
+      if (ref[0] == 0) refBlackPixels++;
+      if (img[0] == 0) imgBlackPixels++;
+
+      const bool refWhite = ref[0] == 255 && ref[1] == 255 && ref[2] == 255;
+      const bool refBlack = ref[0] == 0 && ref[1] == 0 && ref[2] == 0;
+
+      // the red, green, and blue values of the pixel are the same, so the two images have the same value at that pixel
+      if (ref[0] == img[0] && ref[1] == img[1] && ref[2] == img[2])
+      {
+        if (refWhite) pixelWhiteMatches++;
+        if (refBlack) pixelBlackMatches++;
+      }
+
+      // same value at the reflected pixel
+      if (ref[0] == reflected[0] && ref[1] == reflected[1] && ref[2] == reflected[2])
+      {
+        if (refWhite) reflectedPixelWhiteMatches++;
+        if (refBlack) reflectedPixelBlackMatches++;
+      }
+    }
+  }
+
+  const int possibleWhiteMatches = (imgWhitePixels > refWhitePixels) ? imgWhitePixels : refWhitePixels;
+  const int possibleBlackMatches = (imgBlackPixels > refBlackPixels) ? imgBlackPixels : refBlackPixels;
+
+  score.whiteRatio = float(pixelWhiteMatches) / float(possibleWhiteMatches);
+  score.blackRatio = float(pixelBlackMatches) / float(possibleBlackMatches);
+  score.ratio = (0.5 * score.whiteRatio) + (0.5 * score.blackRatio);
+
+  score.whiteReflectedRatio = float(reflectedPixelWhiteMatches) / float(possibleWhiteMatches);
+  score.blackReflectedRatio = float(reflectedPixelBlackMatches) / float(possibleBlackMatches);
+  score.reflectedRatio = (0.5 * score.whiteReflectedRatio) + (0.5 * score.blackReflectedRatio);
+}
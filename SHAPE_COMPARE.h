@@ -0,0 +1,26 @@
+#ifndef SHAPE_COMPARE_H
+#define SHAPE_COMPARE_H
+
+///////////////////////////////////////////////////////////////////////
+// The pixel-by-pixel score categorize uses to decide whether two
+// rendered shapes are the same. Both images are bottom-up RGB triples
+// of the same size, as written by renderImage.
+///////////////////////////////////////////////////////////////////////
+
+struct SHAPE_SCORE {
+  // 0.5 * (white pixel matches / possible white matches) +
+  // 0.5 * (black pixel matches / possible black matches)
+  float ratio;
+  float whiteRatio;
+  float blackRatio;
+
+  // the same, with the second image reflected across the y axis
+  float reflectedRatio;
+  float whiteReflectedRatio;
+  float blackReflectedRatio;
+};
+
+// compare "image" against "reference"
+void scoreShapes(const unsigned char* reference, const unsigned char* image, int width, int height, SHAPE_SCORE& score);
+
+#endif
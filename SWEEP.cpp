@@ -0,0 +1,839 @@
+#include "SWEEP.h"
+#include "JULIA_RENDERER.h"
+#include "METRICS.h"
+#include "CRITICAL_ORBIT.h"
+#include "ATLAS.h"
+#include "BATCH_RENDERER.h"
+#include "ITERATION_BUDGET.h"
+#include "GIGAPIXEL_RENDERER.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+
+using namespace std;
+using namespace std::chrono;
+
+// what runSweep's image options set up for every sweep
+static RENDER_SETTINGS sweepDefaults;
+
+// what runSweep's -predict and -audit options ask for: leave out
+// configurations with no critical orbit that could make a shape, or
+// render them after everything else, and check the predictions
+// against renders
+enum PREDICT_MODE { PREDICT_OFF, PREDICT_SKIP, PREDICT_DEFER };
+static PREDICT_MODE sweepPredict = PREDICT_OFF;
+static PREDICTION_AUDIT* sweepAudit = NULL;
+
+// what runSweep's -batch option asks for: how many root sets the grids
+// hand renderBatch at once, or 0 to render them one at a time
+static int sweepBatch = 0;
+
+// what runSweep's -adaptive option asks for: a budget per configuration
+// instead of sweepDefaults.maxIterations, and the report on them
+static BUDGET_REPORT* sweepBudget = NULL;
+
+///////////////////////////////////////////////////////////////////////
+// classify "roots" if anyone asked for it; false if they are hopeless
+// and should be left out for now. An audit renders everything.
+///////////////////////////////////////////////////////////////////////
+static bool worthRendering(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, SHAPE_PREDICTION& prediction,
+                           double& classifySeconds)
+{
+  prediction = SHAPE_CONNECTED;
+  classifySeconds = 0;
+  if (sweepPredict == PREDICT_OFF && sweepAudit == NULL)
+    return true;
+
+  auto start = steady_clock::now();
+  {
+    METRIC_TIMER timer(METRIC_CLASSIFY);
+    prediction = predictShape(roots, settings.maxIterations, settings.escapeRadius);
+  }
+  classifySeconds = duration<double>(steady_clock::now() - start).count();
+
+  if (sweepAudit != NULL || sweepPredict == PREDICT_OFF || !hopeless(prediction))
+    return true;
+  if (sweepMetrics)
+    sweepMetrics->addSkipped();
+  return false;
+}
+
+///////////////////////////////////////////////////////////////////////
+// renderImage, at the budget -adaptive picked if it is on, and the
+// audit's record of it
+///////////////////////////////////////////////////////////////////////
+static bool renderPredicted(const RENDER_SETTINGS& settings, const vector<VEC3F>& roots, const char* filename,
+                            SHAPE_PREDICTION prediction, double classifySeconds, ofstream& comInfo, RENDER_CONTEXT& context)
+{
+  auto start = steady_clock::now();
+  RENDER_SETTINGS job = settings;
+  BUDGET_ESTIMATE budget;
+  if (sweepBudget)
+  {
+    METRIC_TIMER timer(METRIC_CLASSIFY);
+    budget = estimateBudget(settings, roots);
+    job.maxIterations = budget.maxIterations;
+  }
+
+  bool shape = renderImage(job, roots, filename, VEC3F(0.0, 0.0, 0.0), job.centerShape, comInfo, context); // compute shape, if any
+  if (sweepBudget)
+    sweepBudget->add(roots, budget, shape, context.iterations());
+  if (sweepAudit)
+  {
+    FIELD_2D& mask = context.mask();
+    sweepAudit->add(roots, prediction, (long long)(mask.sum() + 0.5), mask.totalCells());
+    sweepAudit->addTime(classifySeconds, duration<double>(steady_clock::now() - start).count());
+  }
+  return shape;
+}
+
+///////////////////////////////////////////////////////////////////////
+// the grid configurations -batch is holding back until there are
+// enough of the same degree to fill renderBatch's lanes, and its masks
+///////////////////////////////////////////////////////////////////////
+struct PENDING_RENDERS {
+  vector<vector<VEC3F> > roots;
+  vector<SHAPE_PREDICTION> predictions;
+  vector<double> classifySeconds;
+
+  vector<FIELD_2D> masks;
+  vector<long long> iterations;
+  vector<vector<unsigned int> > histograms;
+};
+
+///////////////////////////////////////////////////////////////////////
+// render everything pending in one batch, then hand each configuration
+// to renderRoots in the order it came in, with its mask supplied to the
+// context so that renderImage doesn't iterate its first pass again
+///////////////////////////////////////////////////////////////////////
+template <class RENDER>
+static void flushPending(const RENDER_SETTINGS& settings, PENDING_RENDERS& pending, RENDER_CONTEXT& context,
+                         RENDER& renderRoots)
+{
+  if (pending.roots.empty())
+    return;
+
+  {
+    METRIC_TIMER timer(METRIC_RENDER);
+    renderBatch(settings, pending.roots, pending.masks, sweepBatch, &pending.iterations,
+                sweepMetrics ? &pending.histograms : NULL);
+  }
+  for (unsigned int x = 0; x < pending.roots.size(); x++)
+  {
+    context.supply(&pending.masks[x], pending.iterations[x], sweepMetrics ? &pending.histograms[x] : NULL);
+    renderRoots(pending.roots[x], pending.predictions[x], pending.classifySeconds[x]);
+  }
+  pending.roots.clear();
+  pending.predictions.clear();
+  pending.classifySeconds.clear();
+}
+
+///////////////////////////////////////////////////////////////////////
+// renderRoots now, or once a batch of the same degree has filled up
+///////////////////////////////////////////////////////////////////////
+template <class RENDER>
+static void queueRender(const RENDER_SETTINGS& settings, PENDING_RENDERS& pending, RENDER_CONTEXT& context,
+                        const vector<VEC3F>& roots, SHAPE_PREDICTION prediction, double classifySeconds,
+                        RENDER& renderRoots)
+{
+  if (sweepBatch == 0)
+  {
+    renderRoots(roots, prediction, classifySeconds);
+    return;
+  }
+
+  if (!pending.roots.empty() && pending.roots[0].size() != roots.size())
+    flushPending(settings, pending, context, renderRoots);
+  pending.roots.push_back(roots);
+  pending.predictions.push_back(prediction);
+  pending.classifySeconds.push_back(classifySeconds);
+  if ((int)pending.roots.size() == sweepBatch)
+    flushPending(settings, pending, context, renderRoots);
+}
+
+///////////////////////////////////////////////////////////////////////
+// after a grid: render what -predict defer held back, or just count
+// what -predict skip left out
+///////////////////////////////////////////////////////////////////////
+template <class RENDER>
+static void logDeferred(ofstream& rootInfo, const vector<vector<VEC3F> >& deferred, RENDER& renderRoots)
+{
+  if (sweepPredict == PREDICT_OFF)
+    return;
+
+  if (sweepPredict == PREDICT_SKIP)
+  {
+    rootInfo << "rootCombinations skipped as hopeless: " << deferred.size() << endl;
+    return;
+  }
+
+  for (unsigned int x = 0; x < deferred.size(); x++)
+    renderRoots(deferred[x], SHAPE_CANTOR_DUST, 0.0); // never audited, since an audit defers nothing
+  rootInfo << "rootCombinations deferred as hopeless: " << deferred.size() << endl;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////
+// Generate random root locations: X[-2.0, 2.0], Y[-2.0, 2.0] and store in randomRoots
+///////////////////////////////////////////////////////////////////////////////////////////////
+void generateRoots(int numRoots, vector<VEC3F>& randomRoots)
+{
+  random_device rd;
+  mt19937 gen(rd()); // initialize generator
+  uniform_real_distribution<float> dist(-2.0, 2.0); // set range for random number
+
+  for (int i = 0; i < numRoots; i++)
+  {
+    VEC3F randomRoot = VEC3F(0.0, 0.0, 0.0);
+    for (int j = 0; j < 2; j++) // each root requires two random numbers, one for x and one for y
+    {
+      float randomNum = dist(gen);
+      randomRoot[j] = randomNum; // update root position to random generated
+    }
+    randomRoots.push_back(VEC3F(randomRoot[0], randomRoot[1], 0.0f));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// random exploration: keep trying random roots until enough of them
+// produce a shape
+///////////////////////////////////////////////////////////////////////
+int sweepRandom(int argc, char** argv)
+{
+  auto start = high_resolution_clock::now(); // record sweep start time
+
+  // create and open a text file to store root information alongside output image file names
+  ofstream rootInfo("random/root_info.txt");
+
+  // create and open a text file to store COM information alongside output image file names
+  ofstream comInfo("shapes/COM_info.txt");
+
+  int numRootsToExplore = 2; // default # roots if not specified by user
+  int numCombinations = 8; // default # of random combinations if not specified by user
+
+  int rootCombinations = 0; // hold number of root combinations tried
+  int skippedCombinations = 0; // hold number predicted hopeless and never rendered
+
+  RENDER_SETTINGS settings = sweepDefaults;
+  RENDER_CONTEXT context; // reused for every image in the sweep
+  vector<VEC3F> topRoots;
+  vector<VEC3F> randomRoots;
+
+  // format: ./mandelbrot -random (-any or -pinned) (# of roots) (# of with-shape images to generate) (-color or -noColor) (-center or -notCentered)
+  if (argc == 7)
+  {
+    numRootsToExplore = atoi(argv[3]); // set # of roots to be user-specified
+    numCombinations = atoi(argv[4]); // set # of random combinations to be user-specified
+
+    if (strcmp(argv[5], "-color") == 0)
+    {
+      settings.colorRed = true; // color roots red
+    }
+    else
+    {
+      settings.colorRed = false; // don't color roots red
+    }
+
+    if (strcmp(argv[6], "-center") == 0)
+    {
+      settings.centerShape = 1; // center the shape
+    }
+    else
+    {
+      settings.centerShape = 0; // don't center the shape
+    }
+
+    
+  }
+  else // error
+  {
+    cout << "Program usage: " << argv[0] << " -random (-any or -pinned) (# of roots) (# of images to generate) (-color or -noColor) (-center or -notCentered)" << endl;
+    return 1;
+  }
+
+  cout << "numCombinations: " << numCombinations << endl; // numCombinations holds # of images to generate (each image requires a pair of roots)
+  bool pinned = false; // hold whether one root is pinned to the origin, as set by the -pinned flag
+
+  int numRoots = 0; // number of root locations to generate
+  if (strcmp(argv[2], "-pinned") == 0)
+  {
+    numRoots = numRootsToExplore - 1; // one root is pinned to the origin, the other root can move
+    pinned = true;
+  }
+  else
+  {
+    numRoots = numRootsToExplore; // numRoots holds # of random root locations to generate, all roots can have random locations
+  }
+
+  if (rootInfo.is_open()) // make sure the text file can be opened
+  {
+    rootInfo << "Root information for: "; // save where the root information came from in the text file
+    for (int i = 0; i < argc; i++)
+    {
+      rootInfo << argv[i] << " ";
+    }
+    rootInfo << endl;
+    
+
+    // generate fractal shapes
+    int image_num = 0; // current output image number
+    for (int i = 0; i < numCombinations; i++) // go through root combinations
+    {
+      randomRoots.clear(); // clear roots from last iteration
+      generateRoots(numRoots, randomRoots); // generate random roots
+  
+      if (numRoots!= randomRoots.size()) // make sure number of random roots generated is correct
+      {
+        cout << "generateRoots failed" << endl;
+        return 1;
+      }
+
+      for (int j = 0; j < numRoots; j++)
+      {
+        cout << "randomRoot[" << j << "]: " << randomRoots[j] << endl;
+      }
+
+      char buffer[256]; // hold location to put image file
+      sprintf(buffer, "./random/frame.%06i.%s", image_num, settings.imageExtension());
+
+      topRoots.clear(); // clear from last iteration
+      if (pinned)
+      {
+        topRoots.push_back(VEC3F(0.0, 0.0, 0.0)); // first root is pinned to the origin
+        for (int j = 0; j < (numRootsToExplore - 1); j++)
+        {
+          topRoots.push_back(randomRoots[j]); // root is in a random position
+        }
+      }
+      else
+      {
+        for (int j = 0; j < numRootsToExplore; j++)
+        {
+          topRoots.push_back(randomRoots[j]); // root is in a random position
+        }
+      }
+
+      // hopeless ones get replaced by another random combination, so
+      // deferring them is the same as skipping them
+      SHAPE_PREDICTION prediction;
+      double classifySeconds;
+      if (!worthRendering(settings, topRoots, prediction, classifySeconds))
+      {
+        skippedCombinations += 1;
+        i -= 1;
+        continue;
+      }
+
+      bool shape = renderPredicted(settings, topRoots, buffer, prediction, classifySeconds, comInfo, context);
+      rootCombinations += 1; // increment total # of root combinations tried
+
+      if (shape)
+      { // only save root information if shape exists
+        METRIC_TIMER timer(METRIC_LOG);
+        rootInfo << buffer << ": ";
+        for (int j = 0; j < numRootsToExplore; j++)
+        {
+          rootInfo << "topRoots" << j << topRoots[j];
+          if (j != (numRootsToExplore - 1))
+          {
+            rootInfo << ", ";
+          }
+        }
+        rootInfo << "; rootCombinations tried: " << rootCombinations << endl; // write root info to text file and remember the number of root combinations tried
+        image_num++;
+      }
+      else
+      {
+        i -= 1;
+      }
+    }
+    rootInfo << "total rootCombinations tried: " << rootCombinations << endl;
+    if (sweepPredict != PREDICT_OFF)
+      rootInfo << "rootCombinations skipped as hopeless: " << skippedCombinations << endl;
+    auto stop = high_resolution_clock::now(); 
+    auto ms = duration_cast<milliseconds>(stop - start);
+    auto secs = duration_cast<seconds>(ms);
+    ms -= duration_cast<milliseconds>(secs);
+    auto mins = duration_cast<minutes>(secs);
+    secs -= duration_cast<seconds>(mins);
+    auto hour = duration_cast<hours>(mins);
+    mins -= duration_cast<minutes>(hour);
+    rootInfo << "runtime: " << hour.count() << " hours, " << mins.count() << " minutes, " << secs.count() << " seconds, " << ms.count() << " milliseconds" << endl;
+    rootInfo.close(); // close file after done writing
+    comInfo.close(); // close COM text file after done writing
+  }
+  else 
+  {
+    cout << "Unable to open file." << endl;
+    return 1;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// one root pinned to the origin, the other one swept over a grid
+///////////////////////////////////////////////////////////////////////
+int sweepPinned(int argc, char** argv)
+{
+  // grid exploration only works for two root polynomials
+  // create and open a text file to store root information alongside output image file names
+  ofstream rootInfo("pinned/root_info.txt");
+
+  // create and open a text file to store COM information alongside output image file names
+  ofstream comInfo("shapes/COM_info.txt");
+
+  int gridSize_x = 8; // default grid size if not specified by user
+  int gridSize_y = 8; // default grid size if not specified by user
+
+  int rootCombinations = 0; // hold number of root combinations tried
+
+  RENDER_SETTINGS settings = sweepDefaults;
+  RENDER_CONTEXT context; // reused for every image in the sweep
+  vector<VEC3F> topRoots;
+
+  // format: ./mandelbrot -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+  if (argc == 6)
+  {
+    // set grid size to be user-specified
+    gridSize_x = atoi(argv[2]); 
+    gridSize_y = atoi(argv[3]);
+
+    if (strcmp(argv[4], "-color") == 0)
+    {
+      settings.colorRed = true; // color roots red
+    }
+    else
+    {
+      settings.colorRed = false; // don't color roots red
+    }
+
+    if (strcmp(argv[5], "-center") == 0)
+    {
+      settings.centerShape = 1; // center the shape
+    }
+    else
+    {
+      settings.centerShape = 0; // don't center the shape
+    }
+  }
+  else // error
+  {
+    cout << "Program usage: " << argv[0] << " -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)" << endl;
+    return 1;
+  }
+
+  if (rootInfo.is_open()) // make sure the text file can be opened
+  {
+    rootInfo << "Root information for: "; // save where the root information came from in the text file
+    for (int i = 0; i < argc; i++)
+    {
+      rootInfo << argv[i] << " ";
+    }
+    rootInfo << endl;
+    
+    // two root case
+    // iterate root 0 from top to bottom/2, so through y=0
+    int image_num = 0; // current output image number
+    vector<vector<VEC3F> > deferred; // predicted hopeless, for after the rest of the grid
+    PENDING_RENDERS pending; // waiting for a full batch, with -batch
+
+    auto renderRoots = [&](const vector<VEC3F>& roots, SHAPE_PREDICTION prediction, double classifySeconds)
+    {
+      char buffer[256]; // hold location to put image file
+      sprintf(buffer, "./pinned/frame.%06i.%s", image_num, settings.imageExtension());
+
+      bool shape = renderPredicted(settings, roots, buffer, prediction, classifySeconds, comInfo, context);
+      rootCombinations += 1; // increment total # of root combinations tried
+    
+      if (shape)
+      { // only save root information if shape exists
+        METRIC_TIMER timer(METRIC_LOG);
+        rootInfo << buffer << ": " << "topRoots0" << roots[0] << ", topRoots1" << roots[1] << endl; // write root info to text file
+        image_num++;
+      }
+    };
+      
+    // root 0 is pinned to (0.0, 0.0); iterate root 1 from left to right
+    for (float root1_x = -2.0; root1_x <= 2.0; root1_x += 4.0/gridSize_x)
+    {
+      for (float root1_y = 2.0; root1_y >= 0; root1_y -= 4.0/gridSize_y)
+      {
+        topRoots.clear(); // clear from last iteration
+        topRoots.push_back(VEC3F(0.0, 0.0, 0.0)); // pin first root to (0.0, 0.0)
+        topRoots.push_back(VEC3F(root1_x, root1_y, 0.0));
+
+        SHAPE_PREDICTION prediction;
+        double classifySeconds;
+        if (worthRendering(settings, topRoots, prediction, classifySeconds))
+          queueRender(settings, pending, context, topRoots, prediction, classifySeconds, renderRoots);
+        else
+          deferred.push_back(topRoots);
+      }
+    }
+    flushPending(settings, pending, context, renderRoots);
+    logDeferred(rootInfo, deferred, renderRoots);
+    rootInfo << "rootCombinations tried: " << rootCombinations << endl;
+    rootInfo.close(); // close file after done writing
+    comInfo.close(); // close COM text file after done writing
+  }
+  else 
+  {
+    cout << "Unable to open file." << endl;
+    return 1;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// full space regular grid exploration with two roots
+///////////////////////////////////////////////////////////////////////
+int sweepFull(int argc, char** argv)
+{
+  // create and open a text file to store root information alongside output image file names
+  ofstream rootInfo("shapes/root_info.txt");
+
+  // create and open a text file to store COM information alongside output image file names
+  ofstream comInfo("shapes/COM_info.txt");
+
+  int gridSize_x = 8; // default grid size if not specified by user
+  int gridSize_y = 8; // default grid size if not specified by user
+
+  int rootCombinations = 0; // hold number of root combinations tried
+
+  RENDER_SETTINGS settings = sweepDefaults;
+  RENDER_CONTEXT context; // reused for every image in the sweep
+  vector<VEC3F> topRoots;
+
+  // format: ./mandelbrot -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+  if (argc == 6)
+  {
+    // set grid size to be user-specified
+    gridSize_x = atoi(argv[2]); 
+    gridSize_y = atoi(argv[3]);
+
+    if (strcmp(argv[4], "-color") == 0)
+    {
+      settings.colorRed = true; // color roots red
+    }
+    else
+    {
+      settings.colorRed = false; // don't color roots red
+    }
+
+    if (strcmp(argv[5], "-center") == 0)
+    {
+      settings.centerShape = 1; // center the shape
+    }
+    else
+    {
+      settings.centerShape = 0; // don't center the shape
+    }
+  }
+  else // error
+  {
+    cout << "Program usage: " << argv[0] << " -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)" << endl;
+    return 1;
+  }
+
+  if (rootInfo.is_open()) // make sure the text file can be opened
+  {
+    rootInfo << "Root information for: "; // save where the root information came from in the text file
+    for (int i = 0; i < argc; i++)
+    {
+      rootInfo << argv[i] << " ";
+    }
+    rootInfo << endl;
+    
+    // two root case
+    // iterate root 0 from top to bottom/2, so through y=0
+    int image_num = 0; // current output image number
+    vector<vector<VEC3F> > deferred; // predicted hopeless, for after the rest of the grid
+    PENDING_RENDERS pending; // waiting for a full batch, with -batch
+
+    auto renderRoots = [&](const vector<VEC3F>& roots, SHAPE_PREDICTION prediction, double classifySeconds)
+    {
+      char buffer[256]; // hold location to put image file
+      sprintf(buffer, "./shapes/frame.%06i.%s", image_num, settings.imageExtension());
+
+      bool shape = renderPredicted(settings, roots, buffer, prediction, classifySeconds, comInfo, context);
+      rootCombinations += 1; // increment total # of root combinations tried
+      if (shape)
+      { // only save root information if shape exists
+        METRIC_TIMER timer(METRIC_LOG);
+        rootInfo << buffer << ": " << "topRoots0" << roots[0] << ", topRoots1" << roots[1] << endl; // write root info to text file
+        image_num++;
+      }
+    };
+
+    for (float root0_y = 2.0; root0_y >= 0; root0_y -= 4.0/gridSize_y)
+    {
+      // iterate root 0 from left to right
+      for (float root0_x = -2.0; root0_x <= 2.0; root0_x += 4.0/gridSize_x)
+      {
+        // iterate root 1 from top to bottom
+        for (float root1_y = root0_y; root1_y >= -2.0; root1_y -= 4.0/gridSize_y)
+        {
+          float root0_x_start = 0;
+          if (root1_y == root0_y)
+          {
+            root0_x_start = root0_x;
+          }
+          else
+          {
+            root0_x_start = -2.0;
+          }
+          // iterate root 1 from left to right
+          for (float root1_x = root0_x_start; root1_x <= 2.0; root1_x += 4.0/gridSize_x)
+          {
+            topRoots.clear(); // clear from last iteration
+            topRoots.push_back(VEC3F(root0_x, root0_y, 0.0));
+            topRoots.push_back(VEC3F(root1_x, root1_y, 0.0));
+
+            SHAPE_PREDICTION prediction;
+            double classifySeconds;
+            if (worthRendering(settings, topRoots, prediction, classifySeconds))
+              queueRender(settings, pending, context, topRoots, prediction, classifySeconds, renderRoots);
+            else
+              deferred.push_back(topRoots);
+          }
+        }
+      }
+    }
+    flushPending(settings, pending, context, renderRoots);
+    logDeferred(rootInfo, deferred, renderRoots);
+    rootInfo << "rootCombinations tried: " << rootCombinations << endl;
+    rootInfo.close(); // close file after done writing
+    comInfo.close(); // close COM text file after done writing
+  }
+  else 
+  {
+    cout << "Unable to open file." << endl;
+    return 1;
+  }
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// map root 1 over X[-2, 2] Y[-2, 2] with root 0 pinned to the origin,
+// without rendering any images
+///////////////////////////////////////////////////////////////////////
+int sweepAtlas(int argc, char** argv)
+{
+  // format: ./mandelbrot -atlas (atlas size x) (atlas size y) (output name) [probe size]
+  if (argc != 5 && argc != 6)
+  {
+    cout << "Program usage: " << argv[0] << " -atlas (atlas size x) (atlas size y) (output name) [probe size]" << endl;
+    return 1;
+  }
+
+  ATLAS_SETTINGS atlas;
+  atlas.xRes = atoi(argv[2]);
+  atlas.yRes = atoi(argv[3]);
+  if (argc == 6)
+    atlas.probeRes = atoi(argv[5]);
+  atlas.maxIterations = sweepDefaults.maxIterations;
+  atlas.escapeRadius = sweepDefaults.escapeRadius;
+
+  auto start = steady_clock::now();
+  FIELD_2D area;
+  FIELD_2D connectivity;
+  buildAtlas(atlas, area, connectivity);
+  const double seconds = duration<double>(steady_clock::now() - start).count();
+
+  int shapes = 0;
+  for (int x = 0; x < area.totalCells(); x++)
+    if (area[x] > 0.0)
+      shapes++;
+  cout << atlas.xRes << " x " << atlas.yRes << " atlas in " << seconds << " seconds, shapes at "
+       << shapes << " of " << area.totalCells() << " root positions" << endl;
+
+  return writeAtlas(argv[4], area, connectivity) ? 0 : 1;
+}
+
+///////////////////////////////////////////////////////////////////////
+// render one root configuration at a resolution too big for
+// renderImage, straight to disk
+///////////////////////////////////////////////////////////////////////
+int sweepGigapixel(int argc, char** argv)
+{
+  // format: ./mandelbrot -gigapixel (resolution) (output name) (# of roots n) (root0_x) (root0_y) ... [band rows] [bands in memory]
+  const int totalRoots = (argc > 4) ? atoi(argv[4]) : 0;
+  const int rootArgs = 5 + 2 * totalRoots;
+  if (totalRoots < 1 || argc < rootArgs || argc > rootArgs + 2)
+  {
+    cout << "Program usage: " << argv[0] << " -gigapixel (resolution) (output name) (# of roots n) (root0_x) (root0_y) ... [band rows] [bands in memory]" << endl;
+    return 1;
+  }
+
+  vector<VEC3F> roots;
+  for (int x = 0; x < totalRoots; x++)
+    roots.push_back(VEC3F(atof(argv[5 + 2 * x]), atof(argv[6 + 2 * x]), 0.0));
+
+  GIGAPIXEL_SETTINGS gigapixel;
+  gigapixel.xRes = gigapixel.yRes = atoi(argv[2]);
+  if (argc > rootArgs)
+    gigapixel.bandRows = atoi(argv[rootArgs]);
+  if (argc > rootArgs + 1)
+    gigapixel.maxBands = atoi(argv[rootArgs + 1]);
+  gigapixel.maxIterations = sweepDefaults.maxIterations;
+  gigapixel.escapeRadius = sweepDefaults.escapeRadius;
+  gigapixel.mixedPrecision = sweepDefaults.mixedPrecision;
+  gigapixel.format = (sweepDefaults.imageFormat == RENDER_SETTINGS::IMAGE_PNG) ? GIGAPIXEL_SETTINGS::GIGAPIXEL_PNG
+                                                                              : GIGAPIXEL_SETTINGS::GIGAPIXEL_FIELD;
+  gigapixel.png = sweepDefaults.png;
+  const string filename = string(argv[3]) + "." + gigapixel.extension();
+
+  auto start = steady_clock::now();
+  GIGAPIXEL_RESULT result;
+  string error;
+  if (!renderGigapixel(gigapixel, roots, filename, result, error))
+  {
+    cout << "Couldn't render " << filename << ": " << error << endl;
+    return 1;
+  }
+  const double seconds = duration<double>(steady_clock::now() - start).count();
+
+  cout << gigapixel.xRes << " x " << gigapixel.yRes << " mask in " << seconds << " seconds, "
+       << result.bytes << " bytes to " << filename << " with at most " << result.peakBands << " bands of "
+       << gigapixel.bandRows << " rows in memory" << endl;
+  cout << "inside pixels: " << result.insidePixels << ", area: " << result.area << ", COM: "
+       << result.centerOfMass << endl;
+  cout << "iterations: " << result.iterations;
+  if (gigapixel.mixedPrecision)
+    cout << ", rechecked in double: " << result.rechecked;
+  cout << endl;
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+int runSweep(int argc, char** argv)
+{
+  // pull out the options every sweep takes, so that the sweeps only
+  // see their own arguments
+  vector<char*> args;
+  string metricsFile;
+  string auditFile;
+  string budgetFile;
+  double metricsInterval = 10.0;
+  for (int x = 0; x < argc; x++)
+  {
+    if (x + 1 < argc && strcmp(argv[x], "-metrics") == 0)
+      metricsFile = argv[++x];
+    else if (x + 1 < argc && strcmp(argv[x], "-metricsInterval") == 0)
+      metricsInterval = atof(argv[++x]);
+    else if (strcmp(argv[x], "-png") == 0)
+      sweepDefaults.imageFormat = RENDER_SETTINGS::IMAGE_PNG;
+    else if (x + 1 < argc && strcmp(argv[x], "-pngLevel") == 0)
+      sweepDefaults.png.level = atoi(argv[++x]);
+    else if (strcmp(argv[x], "-pngFast") == 0)
+      sweepDefaults.png.fast = true;
+    else if (strcmp(argv[x], "-incremental") == 0)
+      sweepDefaults.incremental = true;
+    else if (x + 1 < argc && strcmp(argv[x], "-batch") == 0)
+    {
+      sweepBatch = atoi(argv[++x]);
+      if (sweepBatch != BATCH_LANES && sweepBatch != BATCH_WIDE_LANES)
+      {
+        cout << "Program usage: " << argv[0] << " ... -batch (8 or 16)" << endl;
+        return 1;
+      }
+    }
+    else if (x + 1 < argc && strcmp(argv[x], "-predict") == 0)
+    {
+      x++;
+      if (strcmp(argv[x], "skip") == 0)
+        sweepPredict = PREDICT_SKIP;
+      else if (strcmp(argv[x], "defer") == 0)
+        sweepPredict = PREDICT_DEFER;
+      else
+      {
+        cout << "Program usage: " << argv[0] << " ... -predict (skip or defer)" << endl;
+        return 1;
+      }
+    }
+    else if (x + 1 < argc && strcmp(argv[x], "-audit") == 0)
+      auditFile = argv[++x];
+    else if (x + 1 < argc && strcmp(argv[x], "-maxIterations") == 0)
+      sweepDefaults.maxIterations = atoi(argv[++x]);
+    else if (x + 1 < argc && strcmp(argv[x], "-escapeRadius") == 0)
+      sweepDefaults.escapeRadius = atof(argv[++x]);
+    else if (x + 1 < argc && strcmp(argv[x], "-adaptive") == 0)
+      budgetFile = argv[++x];
+    else if (strcmp(argv[x], "-mixedPrecision") == 0)
+      sweepDefaults.mixedPrecision = true;
+    else
+      args.push_back(argv[x]);
+  }
+  int totalArgs = args.size();
+  args.push_back(NULL);
+
+  SWEEP_METRICS* metrics = NULL;
+  if (!metricsFile.empty())
+  {
+    metrics = new SWEEP_METRICS(metricsFile, metricsInterval);
+    sweepMetrics = metrics;
+  }
+
+  BUDGET_REPORT* budget = NULL;
+  if (!budgetFile.empty())
+  {
+    cout << "-adaptive is lossy: a few shapes can come out with pixels white that the full budget makes black." << endl;
+    budget = new BUDGET_REPORT(budgetFile, sweepDefaults.maxIterations);
+    if (!budget->isOpen())
+      cout << "Couldn't open " << budgetFile << " for the iteration budget report." << endl;
+    sweepBudget = budget;
+  }
+
+  // a batch renders its masks in float at the full budget
+  if (sweepBatch != 0 && (budget || sweepDefaults.mixedPrecision))
+  {
+    cout << "-batch is off with -adaptive and -mixedPrecision." << endl;
+    sweepBatch = 0;
+  }
+
+  PREDICTION_AUDIT* audit = NULL;
+  if (!auditFile.empty())
+  {
+    audit = new PREDICTION_AUDIT(auditFile);
+    if (!audit->isOpen())
+      cout << "Couldn't open " << auditFile << " for the prediction audit." << endl;
+    sweepAudit = audit;
+  }
+
+  int result;
+  if (totalArgs > 1 && strcmp(args[1], "-random") == 0)
+    result = sweepRandom(totalArgs, &args[0]);
+  else if (totalArgs > 1 && strcmp(args[1], "-pinned") == 0)
+    result = sweepPinned(totalArgs, &args[0]);
+  else if (totalArgs > 1 && strcmp(args[1], "-atlas") == 0)
+    result = sweepAtlas(totalArgs, &args[0]);
+  else if (totalArgs > 1 && strcmp(args[1], "-gigapixel") == 0)
+    result = sweepGigapixel(totalArgs, &args[0]);
+  else
+    result = sweepFull(totalArgs, &args[0]);
+
+  if (audit)
+  {
+    sweepAudit = NULL;
+    delete audit;
+  }
+
+  if (budget)
+  {
+    sweepBudget = NULL;
+    delete budget;
+  }
+
+  if (metrics)
+  {
+    metrics->write(true);
+    sweepMetrics = NULL;
+    delete metrics;
+  }
+  return result;
+}
@@ -0,0 +1,77 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+///////////////////////////////////////////////////////////////////////
+// The batch modes: sweep over a family of root sets, render each one
+// with renderImage, and write the ones with a shape to disk along with
+// their root and center of mass info.
+//
+// Each sweep parses its own arguments, in the same format the viewer
+// has always accepted, so argv[1] is the mode flag.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "VEC3F.h"
+
+// append numRoots uniformly random roots from X[-2, 2] Y[-2, 2]
+void generateRoots(int numRoots, std::vector<VEC3F>& randomRoots);
+
+// -random (-any or -pinned) (# of roots) (# of images) (-color or -noColor) (-center or -notCentered)
+int sweepRandom(int argc, char** argv);
+
+// -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+int sweepPinned(int argc, char** argv);
+
+// -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+int sweepFull(int argc, char** argv);
+
+// -atlas (atlas size x) (atlas size y) (output name) [probe size]
+// maps where root 1 makes a shape with root 0 pinned to the origin; see
+// ATLAS.h
+int sweepAtlas(int argc, char** argv);
+
+// -gigapixel (resolution) (output name) (# of roots n) (root0_x) (root0_y) ... [band rows] [bands in memory]
+// renders one configuration's mask at any resolution straight to
+// (output name).fld, or .png with -png, and prints its area and center
+// of mass; see GIGAPIXEL_RENDERER.h
+int sweepGigapixel(int argc, char** argv);
+
+// pick the sweep named by argv[1], defaulting to the full grid;
+// returns the exit code for main. "-metrics (filename)" anywhere on
+// the command line writes a SWEEP_METRICS report there, every
+// "-metricsInterval (seconds)" and when the sweep is done. "-png"
+// writes the shapes as PNGs instead of PPMs, at zlib "-pngLevel (0-9)",
+// and "-pngFast" skips the row filters for speed over size.
+//
+// "-predict skip" classifies each configuration by its critical orbits
+// first (see CRITICAL_ORBIT.h) and never renders the hopeless ones;
+// "-predict defer" renders them after the rest of a grid instead, and
+// is the same as skip for -random, which just draws another one.
+// "-audit (filename)" renders everything and writes how each
+// prediction compared with the render.
+//
+// "-incremental" has each render carry the tiles it can prove over from
+// the one before it (see renderImage), which pays off on the -pinned
+// and -full grids, where one root moves a step at a time.
+//
+// "-batch (8 or 16)" has the -pinned and -full grids render that many
+// configurations of the same degree at once with renderBatch (see
+// BATCH_RENDERER.h), then write them out in the usual order. -random
+// renders one at a time either way.
+//
+// "-maxIterations (n)" and "-escapeRadius (r)" replace the budget and
+// escape radius every render uses. "-adaptive (filename)" is a lossy
+// mode that picks a smaller budget for each configuration from a coarse
+// probe and its critical orbits (see ITERATION_BUDGET.h), never more
+// than the full one, and writes the budgets and how many pixels each is
+// expected to turn white there; it turns -batch off. The expected
+// counts are an estimate, a few configurations come out with more
+// pixels white than that, and those shapes can differ from the full
+// budget's, so it is off by default.
+//
+// "-mixedPrecision" iterates again in double the pixels where float
+// rounding could have made the call (see renderImage); it also turns
+// -batch off.
+int runSweep(int argc, char** argv);
+
+#endif
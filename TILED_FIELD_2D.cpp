@@ -0,0 +1,67 @@
+#include "TILED_FIELD_2D.h"
+#include <cstring>
+#include <algorithm>
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::clear()
+{
+  std::fill(_data.begin(), _data.end(), 0.0f);
+}
+
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::resizeAndWipe(int xRes, int yRes)
+{
+  _xRes = xRes;
+  _yRes = yRes;
+  _totalCells = _xRes * _yRes;
+  _xTiles = (_xRes + TILE_MASK) >> TILE_BITS;
+  const int yTiles = (_yRes + TILE_MASK) >> TILE_BITS;
+  _data.assign((size_t)_xTiles * yTiles * TILE_SIZE * TILE_SIZE, 0.0f);
+}
+
+///////////////////////////////////////////////////////////////////////
+// a tile's width of row y at a time
+///////////////////////////////////////////////////////////////////////
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::getRow(int y, float* row) const
+{
+  for (int x = 0; x < _xRes; x += TILE_SIZE)
+  {
+    const int length = std::min((int)TILE_SIZE, _xRes - x);
+    memcpy(row + x, &_data[index(x, y)], length * sizeof(float));
+  }
+}
+
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::setRow(int y, const float* row)
+{
+  for (int x = 0; x < _xRes; x += TILE_SIZE)
+  {
+    const int length = std::min((int)TILE_SIZE, _xRes - x);
+    memcpy(&_data[index(x, y)], row + x, length * sizeof(float));
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::fromField(const FIELD_2D& field)
+{
+  resizeAndWipe(field.xRes(), field.yRes());
+  for (int y = 0; y < _yRes; y++)
+    setRow(y, field.data() + y * _xRes);
+}
+
+template <int TILE_BITS>
+void TILED_FIELD_2D<TILE_BITS>::toField(FIELD_2D& field) const
+{
+  if (field.xRes() != _xRes || field.yRes() != _yRes)
+    field.resizeAndWipe(_xRes, _yRes);
+  for (int y = 0; y < _yRes; y++)
+    getRow(y, field.data() + y * _xRes);
+}
+
+template class TILED_FIELD_2D<3>;
+template class TILED_FIELD_2D<6>;
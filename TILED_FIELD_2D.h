@@ -0,0 +1,74 @@
+#ifndef TILED_FIELD_2D_H
+#define TILED_FIELD_2D_H
+
+///////////////////////////////////////////////////////////////////////
+// A float field stored as square tiles, 2^TILE_BITS cells on a side,
+// instead of one row after another. Each tile is row-major inside and
+// the tiles themselves are laid out row-major, so a whole 2D
+// neighborhood sits in a few cache lines and pages. Good for stencils,
+// boundary tracing and anything else that walks up and down as much as
+// across.
+//
+// It has the same accessors as FIELD_2D. Streaming a whole row goes
+// through getRow/setRow or rowSpan, which move a tile's width of cells
+// at a time, since stepping x through operator() pays for the index
+// math on every cell.
+//
+//   TILED_FIELD_2D<3>   8 x 8 tiles, a tile per 256 bytes
+//   TILED_FIELD_2D<6>   64 x 64 tiles, a tile per 4k page
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include "FIELD_2D.h"
+
+template <int TILE_BITS>
+class TILED_FIELD_2D {
+public:
+  enum { TILE_SIZE = 1 << TILE_BITS, TILE_MASK = TILE_SIZE - 1 };
+
+  TILED_FIELD_2D() : _xRes(0), _yRes(0), _totalCells(0), _xTiles(0) {};
+  TILED_FIELD_2D(int xRes, int yRes) : _xRes(0), _yRes(0), _totalCells(0), _xTiles(0) { resizeAndWipe(xRes, yRes); };
+
+  // accessors
+  inline float& operator()(int x, int y) { return _data[index(x, y)]; };
+  const float operator()(int x, int y) const { return _data[index(x, y)]; };
+  const int xRes() const { return _xRes; };
+  const int yRes() const { return _yRes; };
+  const int totalCells() const { return _totalCells; };
+
+  // where (x, y) lives in the tiles
+  inline int index(int x, int y) const {
+    return ((((y >> TILE_BITS) * _xTiles + (x >> TILE_BITS)) << TILE_BITS | (y & TILE_MASK)) << TILE_BITS) | (x & TILE_MASK);
+  };
+
+  // the cells of row y from x to the end of x's tile are contiguous;
+  // returns them and sets "length" to how many there are
+  float* rowSpan(int x, int y, int& length) {
+    length = TILE_SIZE - (x & TILE_MASK);
+    length = (x + length > _xRes) ? _xRes - x : length;
+    return &_data[index(x, y)];
+  };
+
+  // copy row y out to / in from xRes floats
+  void getRow(int y, float* row) const;
+  void setRow(int y, const float* row);
+
+  void clear();
+
+  // zero the field at the new size; the tiles along the right and top
+  // edges are padded out to full size
+  void resizeAndWipe(int xRes, int yRes);
+
+  // conversion to and from row-major
+  void fromField(const FIELD_2D& field);
+  void toField(FIELD_2D& field) const;
+
+private:
+  int _xRes;
+  int _yRes;
+  int _totalCells;
+  int _xTiles;
+  std::vector<float> _data;
+};
+
+#endif
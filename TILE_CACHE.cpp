@@ -0,0 +1,137 @@
+#include "TILE_CACHE.h"
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+TILE_CACHE::TILE_CACHE(size_t budgetBytes) :
+  _budgetBytes(budgetBytes), _bytes(0), _hits(0), _misses(0)
+{
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool TILE_CACHE::lookup(const TILE_KEY& key, FIELD_2D& tile)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  std::unordered_map<TILE_KEY, std::list<ENTRY>::iterator, KEY_HASH>::iterator found = _index.find(key);
+  if (found == _index.end())
+  {
+    _misses++;
+    return false;
+  }
+  _hits++;
+
+  // move it to the front of the line
+  _entries.splice(_entries.begin(), _entries, found->second);
+
+  found->second->tile.toField(tile);
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void TILE_CACHE::insert(const TILE_KEY& key, const FIELD_2D& tile)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // someone else may have gotten here first
+  std::unordered_map<TILE_KEY, std::list<ENTRY>::iterator, KEY_HASH>::iterator found = _index.find(key);
+  if (found != _index.end())
+  {
+    _entries.splice(_entries.begin(), _entries, found->second);
+    return;
+  }
+
+  ENTRY entry;
+  entry.key = key;
+  _entries.push_front(entry);
+  _entries.front().tile.fromField(tile);
+  _index[key] = _entries.begin();
+  _bytes += _entries.front().tile.bytes();
+
+  trim();
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void TILE_CACHE::clear()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _entries.clear();
+  _index.clear();
+  _bytes = 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void TILE_CACHE::trim()
+{
+  while (_bytes > _budgetBytes && _entries.size() > 0)
+  {
+    ENTRY& oldest = _entries.back();
+    _bytes -= oldest.tile.bytes();
+    _index.erase(oldest.key);
+    _entries.pop_back();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// FNV-1a over the bits of the root positions
+///////////////////////////////////////////////////////////////////////
+unsigned long long TILE_CACHE::hashRoots(const std::vector<VEC3F>& roots, int totalRoots)
+{
+  unsigned long long hash = 14695981039346656037ULL;
+  for (int x = 0; x < totalRoots && x < (int)roots.size(); x++)
+    for (int y = 0; y < 2; y++)
+    {
+      float value = roots[x][y];
+      unsigned int bits;
+      memcpy(&bits, &value, sizeof(bits));
+      for (int z = 0; z < 4; z++)
+      {
+        hash ^= (bits >> (8 * z)) & 0xff;
+        hash *= 1099511628211ULL;
+      }
+    }
+  hash ^= totalRoots;
+  hash *= 1099511628211ULL;
+  return hash;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+size_t TILE_CACHE::KEY_HASH::operator()(const TILE_KEY& key) const
+{
+  unsigned long long hash = key.rootSet;
+  hash = hash * 31 + (unsigned int)key.level;
+  hash = hash * 1000003 + (unsigned int)key.x;
+  hash = hash * 1000003 + (unsigned int)key.y;
+  return (size_t)(hash ^ (hash >> 32));
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+size_t TILE_CACHE::bytes()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _bytes;
+}
+
+int TILE_CACHE::size()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+int TILE_CACHE::hits()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _hits;
+}
+
+int TILE_CACHE::misses()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _misses;
+}
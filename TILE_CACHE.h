@@ -0,0 +1,87 @@
+#ifndef TILE_CACHE_H
+#define TILE_CACHE_H
+
+///////////////////////////////////////////////////////////////////////
+// A memory-bounded cache of rendered tiles from a world-space
+// quadtree.
+//
+// Level 0 is a single tile covering the whole standard viewing window,
+// and every level splits each tile of the level above into 2x2. Tiles
+// are keyed by the root set they were rendered with, their level and
+// their x, y index within the level. When the cache goes over its
+// memory budget, the least recently used tiles are thrown out.
+//
+// Tiles are masks, so they are kept one bit per pixel: anything above
+// 0.5 comes back out of the cache as 1, everything else as 0.
+//
+// All the functions are safe to call from several threads at once.
+///////////////////////////////////////////////////////////////////////
+
+#include <list>
+#include <vector>
+#include <mutex>
+#include <cstddef>
+#include <unordered_map>
+#include "FIELD_2D.h"
+#include "TYPED_FIELD_2D.h"
+#include "VEC3F.h"
+
+struct TILE_KEY {
+  unsigned long long rootSet;
+  int level;
+  int x;
+  int y;
+
+  bool operator==(const TILE_KEY& key) const {
+    return rootSet == key.rootSet && level == key.level && x == key.x && y == key.y;
+  };
+};
+
+class TILE_CACHE {
+public:
+  TILE_CACHE(size_t budgetBytes);
+
+  // copy a cached tile into "tile" and mark it as recently used,
+  // returns false if the tile isn't in the cache
+  bool lookup(const TILE_KEY& key, FIELD_2D& tile);
+
+  // add a tile, evicting old ones if we run over budget
+  void insert(const TILE_KEY& key, const FIELD_2D& tile);
+
+  // throw everything out
+  void clear();
+
+  // a key for the first "totalRoots" roots, for use as TILE_KEY::rootSet
+  static unsigned long long hashRoots(const std::vector<VEC3F>& roots, int totalRoots);
+
+  size_t bytes();
+  int size();
+  int hits();
+  int misses();
+
+private:
+  struct KEY_HASH {
+    size_t operator()(const TILE_KEY& key) const;
+  };
+
+  struct ENTRY {
+    TILE_KEY key;
+    BIT_FIELD_2D tile;
+  };
+
+  // evict from the back until we're under budget
+  void trim();
+
+  size_t _budgetBytes;
+  size_t _bytes;
+  int _hits;
+  int _misses;
+
+  // most recently used tiles are at the front
+  std::list<ENTRY> _entries;
+  std::unordered_map<TILE_KEY, std::list<ENTRY>::iterator, KEY_HASH> _index;
+
+  std::mutex _mutex;
+};
+
+#endif
@@ -0,0 +1,286 @@
+#include "TYPED_FIELD_2D.h"
+#include <cstdio>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////
+// stream "height" rows of gray cells, "rowBytes" apart, out top row
+// first, straight from the cells
+///////////////////////////////////////////////////////////////////////
+static bool writeGrayPNG(const string& filename, int width, int height, int bitDepth,
+                         const unsigned char* cells, int rowBytes, const PNG_SETTINGS& settings)
+{
+  PNG_WRITER writer;
+  bool success = writer.open(filename, width, height, 1, bitDepth, settings);
+  for (int y = height - 1; success && y >= 0; y--)
+    success = writer.writeRow(cells + (size_t)y * rowBytes);
+  success = success && writer.close();
+
+  if (!success)
+    printf("[write_png_file] %s\n", writer.error().c_str());
+  return success;
+}
+
+///////////////////////////////////////////////////////////////////////
+// the dimensions, then "bytes" of cells
+///////////////////////////////////////////////////////////////////////
+static void writeCells(const string& filename, int xRes, int yRes, const void* cells, size_t bytes)
+{
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL)
+  {
+    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
+    cout << " TYPED_FIELD_2D write failed! " << endl;
+    cout << " Could not open file " << filename.c_str() << endl;
+    exit(0);
+  }
+
+  fwrite((void*)&xRes, sizeof(int), 1, file);
+  fwrite((void*)&yRes, sizeof(int), 1, file);
+  fwrite(cells, 1, bytes, file);
+  fclose(file);
+}
+
+static FILE* openCells(const string& filename, int& xRes, int& yRes)
+{
+  FILE* file = fopen(filename.c_str(), "rb");
+  if (file == NULL)
+  {
+    cout << __FILE__ << " " << __FUNCTION__ << " " << __LINE__ << " : " << endl;
+    cout << " TYPED_FIELD_2D read failed! " << endl;
+    cout << " Could not open file " << filename.c_str() << endl;
+    exit(0);
+  }
+
+  xRes = yRes = 0;
+  fread((void*)&xRes, sizeof(int), 1, file);
+  fread((void*)&yRes, sizeof(int), 1, file);
+  return file;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::clear()
+{
+  std::fill(_data.begin(), _data.end(), 0);
+}
+
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::resizeAndWipe(int xRes, int yRes)
+{
+  _xRes = xRes;
+  _yRes = yRes;
+  _totalCells = _xRes * _yRes;
+  _data.assign(_totalCells, 0);
+}
+
+///////////////////////////////////////////////////////////////////////
+// [0, 1] goes to the whole range of the cell, clamped
+///////////////////////////////////////////////////////////////////////
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::fromField(const FIELD_2D& field)
+{
+  const float scale = std::numeric_limits<CELL>::max();
+  resizeAndWipe(field.xRes(), field.yRes());
+
+  // locals, so the stores can't be mistaken for writes to the members
+  const float* cells = field.data();
+  CELL* data = &_data[0];
+  const int totalCells = _totalCells;
+  for (int x = 0; x < totalCells; x++)
+  {
+    float value = cells[x] * scale + 0.5f;
+    value = (value < 0.0f) ? 0.0f : value;
+    value = (value > scale) ? scale : value;
+    data[x] = (CELL)(int)value;
+  }
+}
+
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::toField(FIELD_2D& field) const
+{
+  const float scale = 1.0 / std::numeric_limits<CELL>::max();
+  if (field.xRes() != _xRes || field.yRes() != _yRes)
+    field.resizeAndWipe(_xRes, _yRes);
+
+  float* cells = field.data();
+  const CELL* data = &_data[0];
+  const int totalCells = _totalCells;
+  for (int x = 0; x < totalCells; x++)
+    cells[x] = data[x] * scale;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::write(string filename) const
+{
+  writeCells(filename, _xRes, _yRes, data(), bytes());
+}
+
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::read(string filename)
+{
+  int xRes, yRes;
+  FILE* file = openCells(filename, xRes, yRes);
+  resizeAndWipe(xRes, yRes);
+  fread((void*)data(), sizeof(CELL), _totalCells, file);
+  fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////
+// same row order as FIELD_2D::writePPM
+///////////////////////////////////////////////////////////////////////
+template <class CELL>
+void TYPED_FIELD_2D<CELL>::writePPM(string filename) const
+{
+  assert(sizeof(CELL) == 1);
+
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL)
+  {
+    printf("Couldn't open %s for writing\n", filename.c_str());
+    return;
+  }
+  fprintf(file, "P5\n%d %d\n255\n", _xRes, _yRes);
+  fwrite(data(), 1, _totalCells, file);
+  fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////
+// same row order as FIELD_2D::writePNG
+///////////////////////////////////////////////////////////////////////
+template <class CELL>
+bool TYPED_FIELD_2D<CELL>::writePNG(string filename, const PNG_SETTINGS& settings) const
+{
+  assert(sizeof(CELL) == 1);
+  return writeGrayPNG(filename, _xRes, _yRes, 8, (const unsigned char*)data(), _xRes, settings);
+}
+
+template class TYPED_FIELD_2D<unsigned char>;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void TYPED_FIELD_2D<bool>::clear()
+{
+  std::fill(_data.begin(), _data.end(), 0);
+}
+
+void TYPED_FIELD_2D<bool>::resizeAndWipe(int xRes, int yRes)
+{
+  _xRes = xRes;
+  _yRes = yRes;
+  _totalCells = _xRes * _yRes;
+  _rowBytes = (_xRes + 7) / 8;
+  _data.assign(_rowBytes * _yRes, 0);
+}
+
+///////////////////////////////////////////////////////////////////////
+// the padding bits at the end of each row are always zero, so they
+// don't need masking off
+///////////////////////////////////////////////////////////////////////
+int TYPED_FIELD_2D<bool>::count() const
+{
+  int total = 0;
+  for (unsigned int x = 0; x < _data.size(); x++)
+  {
+    unsigned char byte = _data[x];
+    for (; byte; total++)
+      byte &= byte - 1;
+  }
+  return total;
+}
+
+///////////////////////////////////////////////////////////////////////
+// pack eight cells at a time, without branching on them, since masks
+// are about as unpredictable as data gets
+///////////////////////////////////////////////////////////////////////
+void TYPED_FIELD_2D<bool>::fromField(const FIELD_2D& field, float threshold)
+{
+  resizeAndWipe(field.xRes(), field.yRes());
+
+  const float* cells = field.data();
+  for (int y = 0; y < _yRes; y++)
+  {
+    const float* row = cells + y * _xRes;
+    unsigned char* packed = &_data[y * _rowBytes];
+
+    int x = 0;
+    for (; x + 8 <= _xRes; x += 8)
+    {
+      unsigned char byte = 0;
+      for (int bit = 0; bit < 8; bit++)
+        byte |= (row[x + bit] > threshold) << (7 - bit);
+      packed[x >> 3] = byte;
+    }
+    for (; x < _xRes; x++)
+      packed[x >> 3] |= (row[x] > threshold) << (7 - (x & 7));
+  }
+}
+
+void TYPED_FIELD_2D<bool>::toField(FIELD_2D& field) const
+{
+  if (field.xRes() != _xRes || field.yRes() != _yRes)
+    field.resizeAndWipe(_xRes, _yRes);
+
+  float* cells = field.data();
+  for (int y = 0; y < _yRes; y++)
+  {
+    float* row = cells + y * _xRes;
+    const unsigned char* packed = &_data[y * _rowBytes];
+    for (int x = 0; x < _xRes; x++)
+      row[x] = (packed[x >> 3] >> (7 - (x & 7))) & 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void TYPED_FIELD_2D<bool>::write(string filename) const
+{
+  writeCells(filename, _xRes, _yRes, data(), bytes());
+}
+
+void TYPED_FIELD_2D<bool>::read(string filename)
+{
+  int xRes, yRes;
+  FILE* file = openCells(filename, xRes, yRes);
+  resizeAndWipe(xRes, yRes);
+  fread((void*)data(), 1, bytes(), file);
+  fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////
+// PBM has 1 as black, so each row gets flipped on the way out; same
+// row order as FIELD_2D::writePPM
+///////////////////////////////////////////////////////////////////////
+void TYPED_FIELD_2D<bool>::writePPM(string filename) const
+{
+  FILE* file = fopen(filename.c_str(), "wb");
+  if (file == NULL)
+  {
+    printf("Couldn't open %s for writing\n", filename.c_str());
+    return;
+  }
+  fprintf(file, "P4\n%d %d\n", _xRes, _yRes);
+
+  vector<unsigned char> row(_rowBytes);
+  for (int y = 0; y < _yRes; y++)
+  {
+    for (int x = 0; x < _rowBytes; x++)
+      row[x] = ~_data[y * _rowBytes + x];
+    fwrite(&row[0], 1, _rowBytes, file);
+  }
+  fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////
+// the packed rows are already in PNG's 1 bit layout; same row order as
+// FIELD_2D::writePNG
+///////////////////////////////////////////////////////////////////////
+bool TYPED_FIELD_2D<bool>::writePNG(string filename, const PNG_SETTINGS& settings) const
+{
+  return writeGrayPNG(filename, _xRes, _yRes, 1, data(), _rowBytes, settings);
+}
@@ -0,0 +1,138 @@
+#ifndef TYPED_FIELD_2D_H
+#define TYPED_FIELD_2D_H
+
+///////////////////////////////////////////////////////////////////////
+// Compact fields, for values that don't need a whole float per cell,
+// like the 0/1 masks the renderers produce:
+//
+//   BYTE_FIELD_2D  one unsigned char per cell
+//   BIT_FIELD_2D   one bit per cell, each row packed into whole bytes,
+//                  leftmost cell in the high bit
+//
+// They have the same accessors as FIELD_2D, convert to and from it, and
+// their writers work straight off the compact cells. A BYTE_FIELD_2D
+// maps [0, 1] in a FIELD_2D to [0, 255]; a BIT_FIELD_2D is set wherever
+// the FIELD_2D is above a threshold.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <string>
+#include "FIELD_2D.h"
+
+template <class CELL>
+class TYPED_FIELD_2D {
+public:
+  TYPED_FIELD_2D() : _xRes(0), _yRes(0), _totalCells(0) {};
+  TYPED_FIELD_2D(int xRes, int yRes) : _xRes(0), _yRes(0), _totalCells(0) { resizeAndWipe(xRes, yRes); };
+
+  // accessors
+  inline CELL& operator()(int x, int y) { return _data[y * _xRes + x]; };
+  const CELL operator()(int x, int y) const { return _data[y * _xRes + x]; };
+  inline CELL& operator[](int x) { return _data[x]; };
+  const CELL operator[](int x) const { return _data[x]; };
+  CELL* data() { return &_data[0]; };
+  const CELL* data() const { return &_data[0]; };
+  const int xRes() const { return _xRes; };
+  const int yRes() const { return _yRes; };
+  const int totalCells() const { return _totalCells; };
+
+  // memory used by the cells
+  size_t bytes() const { return _data.size() * sizeof(CELL); };
+
+  void clear();
+
+  // zero the field at the new size; shrinking keeps the old storage
+  void resizeAndWipe(int xRes, int yRes);
+
+  // conversion to and from full precision
+  void fromField(const FIELD_2D& field);
+  void toField(FIELD_2D& field) const;
+
+  // the dimensions followed by the raw cells
+  void write(string filename) const;
+  void read(string filename);
+
+  // a P5 graymap and an 8 bit gray PNG
+  void writePPM(string filename) const;
+  bool writePNG(string filename, const PNG_SETTINGS& settings = PNG_SETTINGS()) const;
+
+private:
+  int _xRes;
+  int _yRes;
+  int _totalCells;
+  std::vector<CELL> _data;
+};
+
+template <>
+class TYPED_FIELD_2D<bool> {
+public:
+  // what the non-const accessors hand back, so "mask(x, y) = true"
+  // works on a single bit
+  class REFERENCE {
+  public:
+    REFERENCE(unsigned char& byte, unsigned char bit) : _byte(byte), _bit(bit) {};
+
+    operator bool() const { return (_byte & _bit) != 0; };
+    REFERENCE& operator=(bool value) {
+      _byte = value ? (_byte | _bit) : (_byte & ~_bit);
+      return *this;
+    };
+    REFERENCE& operator=(const REFERENCE& value) { return (*this = (bool)value); };
+
+  private:
+    unsigned char& _byte;
+    unsigned char _bit;
+  };
+
+  TYPED_FIELD_2D() : _xRes(0), _yRes(0), _totalCells(0), _rowBytes(0) {};
+  TYPED_FIELD_2D(int xRes, int yRes) : _xRes(0), _yRes(0), _totalCells(0), _rowBytes(0) { resizeAndWipe(xRes, yRes); };
+
+  // accessors
+  inline REFERENCE operator()(int x, int y) { return REFERENCE(_data[y * _rowBytes + (x >> 3)], 0x80 >> (x & 7)); };
+  const bool operator()(int x, int y) const { return (_data[y * _rowBytes + (x >> 3)] & (0x80 >> (x & 7))) != 0; };
+  inline REFERENCE operator[](int x) { return (*this)(x % _xRes, x / _xRes); };
+  const bool operator[](int x) const { return (*this)(x % _xRes, x / _xRes); };
+  unsigned char* data() { return &_data[0]; };
+  const unsigned char* data() const { return &_data[0]; };
+  const int xRes() const { return _xRes; };
+  const int yRes() const { return _yRes; };
+  const int totalCells() const { return _totalCells; };
+
+  // bytes per packed row
+  const int rowBytes() const { return _rowBytes; };
+
+  // memory used by the cells
+  size_t bytes() const { return _data.size(); };
+
+  // how many cells are set
+  int count() const;
+
+  void clear();
+
+  // zero the field at the new size; shrinking keeps the old storage
+  void resizeAndWipe(int xRes, int yRes);
+
+  // conversion to and from full precision; cells above "threshold" are set
+  void fromField(const FIELD_2D& field, float threshold = 0.5);
+  void toField(FIELD_2D& field) const;
+
+  // the dimensions followed by the packed rows
+  void write(string filename) const;
+  void read(string filename);
+
+  // a P4 bitmap and a 1 bit gray PNG, set cells white
+  void writePPM(string filename) const;
+  bool writePNG(string filename, const PNG_SETTINGS& settings = PNG_SETTINGS()) const;
+
+private:
+  int _xRes;
+  int _yRes;
+  int _totalCells;
+  int _rowBytes;
+  std::vector<unsigned char> _data;
+};
+
+typedef TYPED_FIELD_2D<unsigned char> BYTE_FIELD_2D;
+typedef TYPED_FIELD_2D<bool> BIT_FIELD_2D;
+
+#endif
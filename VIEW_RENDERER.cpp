@@ -0,0 +1,344 @@
+#include "VIEW_RENDERER.h"
+#include <algorithm>
+#include <cmath>
+
+// the first pass samples every 8th pixel, the last one every pixel
+static const int totalPasses = 4;
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+VIEW_RENDERER::VIEW_RENDERER(FIELD_FUNCTION function, TILE_CACHE* cache, float rootXMin, float rootYMin, float rootSize,
+                             int tileRes, int totalThreads) :
+  _function(function), _cache(cache),
+  _rootXMin(rootXMin), _rootYMin(rootYMin), _rootSize(rootSize), _tileRes(tileRes),
+  _quit(false), _generation(0),
+  _pass(totalPasses), _nextTile(0), _tilesRemaining(0),
+  _previewDone(false), _previewPublished(true)
+{
+  _window.xMin = _window.yMin = 0;
+  _window.dx = _window.dy = 1;
+
+  if (totalThreads <= 0)
+    totalThreads = std::thread::hardware_concurrency();
+  if (totalThreads <= 0)
+    totalThreads = 1;
+
+  for (int x = 0; x < totalThreads; x++)
+    _threads.push_back(std::thread(&VIEW_RENDERER::work, this));
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+VIEW_RENDERER::~VIEW_RENDERER()
+{
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _quit = true;
+    _generation++;
+  }
+  _workAvailable.notify_all();
+
+  for (unsigned int x = 0; x < _threads.size(); x++)
+    _threads[x].join();
+}
+
+///////////////////////////////////////////////////////////////////////
+// side length of a tile at a given level of the quadtree
+///////////////////////////////////////////////////////////////////////
+float VIEW_RENDERER::tileSize(int level) const
+{
+  return ldexp((double)_rootSize, -level);
+}
+
+///////////////////////////////////////////////////////////////////////
+// start over on a new block of tiles
+///////////////////////////////////////////////////////////////////////
+void VIEW_RENDERER::render(unsigned long long rootSet, int level, int xTile, int yTile, int xTiles, int yTiles)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _generation++;
+
+  const double size = ldexp((double)_rootSize, -level);
+  _window.xMin = _rootXMin + xTile * size;
+  _window.yMin = _rootYMin + yTile * size;
+  _window.dx = size / _tileRes;
+  _window.dy = size / _tileRes;
+
+  _offsetFunction = OFFSET_FUNCTION();
+
+  _tiles.clear();
+  for (int y = 0; y < yTiles; y++)
+    for (int x = 0; x < xTiles; x++)
+    {
+      TILE tile;
+      tile.key.rootSet = rootSet;
+      tile.key.level = level;
+      tile.key.x = xTile + x;
+      tile.key.y = yTile + y;
+      tile.rect.x = x * _tileRes;
+      tile.rect.y = y * _tileRes;
+      tile.rect.width = _tileRes;
+      tile.rect.height = _tileRes;
+      tile.done = false;
+      tile.xOffset = tile.yOffset = 0;
+      tile.dx = size / _tileRes;
+      _tiles.push_back(tile);
+    }
+  start(xTiles, yTiles);
+}
+
+///////////////////////////////////////////////////////////////////////
+// start over on a block of pixels around a point, none of them cached
+///////////////////////////////////////////////////////////////////////
+void VIEW_RENDERER::renderOffsets(const OFFSET_FUNCTION& function, double xCenter, double yCenter, double dx,
+                                  int xTiles, int yTiles)
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  _generation++;
+
+  const double xHalf = 0.5 * xTiles * _tileRes;
+  const double yHalf = 0.5 * yTiles * _tileRes;
+  _window.xMin = xCenter - xHalf * dx;
+  _window.yMin = yCenter - yHalf * dx;
+  _window.dx = dx;
+  _window.dy = dx;
+
+  _offsetFunction = function;
+
+  _tiles.clear();
+  for (int y = 0; y < yTiles; y++)
+    for (int x = 0; x < xTiles; x++)
+    {
+      TILE tile;
+      tile.key.rootSet = 0;
+      tile.key.level = -1;
+      tile.key.x = x;
+      tile.key.y = y;
+      tile.rect.x = x * _tileRes;
+      tile.rect.y = y * _tileRes;
+      tile.rect.width = _tileRes;
+      tile.rect.height = _tileRes;
+      tile.done = false;
+      tile.xOffset = (tile.rect.x - xHalf) * dx;
+      tile.yOffset = (tile.rect.y - yHalf) * dx;
+      tile.dx = dx;
+      _tiles.push_back(tile);
+    }
+  start(xTiles, yTiles);
+}
+
+///////////////////////////////////////////////////////////////////////
+// called with the lock held, once _tiles is filled in
+///////////////////////////////////////////////////////////////////////
+void VIEW_RENDERER::start(int xTiles, int yTiles)
+{
+  // do the middle of the screen first
+  const float xCenter = 0.5 * xTiles * _tileRes;
+  const float yCenter = 0.5 * yTiles * _tileRes;
+  const int half = _tileRes / 2;
+  std::sort(_tiles.begin(), _tiles.end(), [xCenter, yCenter, half](const TILE& a, const TILE& b) {
+    float ax = a.rect.x + half - xCenter;
+    float ay = a.rect.y + half - yCenter;
+    float bx = b.rect.x + half - xCenter;
+    float by = b.rect.y + half - yCenter;
+    return ax * ax + ay * ay < bx * bx + by * by;
+  });
+
+  _buffer.resizeAndWipe(xTiles * _tileRes, yTiles * _tileRes);
+
+  _pass = 0;
+  _nextTile = 0;
+  _tilesRemaining = _tiles.size();
+  _previewDone = false;
+  _previewPublished = false;
+  _dirty.clear();
+
+  _workAvailable.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////
+// hand finished tiles over to the GL thread
+///////////////////////////////////////////////////////////////////////
+bool VIEW_RENDERER::update(FIELD_2D& field, VIEW_WINDOW& window, std::vector<TILE_RECT>& changed)
+{
+  changed.clear();
+
+  std::lock_guard<std::mutex> lock(_mutex);
+
+  // keep showing the old view until the whole preview is ready
+  if (!_previewDone)
+    return false;
+
+  // first time we've seen this request, swap the whole thing in
+  if (!_previewPublished)
+  {
+    field = _buffer;
+    window = _window;
+    _previewPublished = true;
+    _dirty.clear();
+
+    TILE_RECT all = {0, 0, _buffer.xRes(), _buffer.yRes()};
+    changed.push_back(all);
+    return true;
+  }
+
+  if (_dirty.empty())
+    return false;
+
+  for (unsigned int i = 0; i < _dirty.size(); i++)
+  {
+    const TILE_RECT& rect = _tiles[_dirty[i]].rect;
+    for (int y = rect.y; y < rect.y + rect.height; y++)
+      for (int x = rect.x; x < rect.x + rect.width; x++)
+        field(x, y) = _buffer(x, y);
+    changed.push_back(rect);
+  }
+  _dirty.clear();
+
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+bool VIEW_RENDERER::busy()
+{
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _pass < totalPasses && !_tiles.empty();
+}
+
+///////////////////////////////////////////////////////////////////////
+// grab tiles until told to quit
+///////////////////////////////////////////////////////////////////////
+void VIEW_RENDERER::work()
+{
+  FIELD_2D pixels(_tileRes, _tileRes);
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true)
+  {
+    _workAvailable.wait(lock, [this] { return _quit || (_pass < totalPasses && _nextTile < _tiles.size()); });
+    if (_quit)
+      return;
+
+    const int index = _nextTile++;
+    const int pass = _pass;
+    const int generation = _generation;
+    const TILE tile = _tiles[index];
+    const OFFSET_FUNCTION function = _offsetFunction;
+    const bool caching = _cache && !function;
+
+    bool finished = true;
+    bool cached = false;
+    if (!tile.done)
+    {
+      if (pass == 0)
+      {
+        // see if we've been here before
+        lock.unlock();
+        cached = caching && _cache->lookup(tile.key, pixels);
+        lock.lock();
+      }
+      else
+      {
+        // pick up the samples from the previous pass
+        for (int y = 0; y < _tileRes; y++)
+          for (int x = 0; x < _tileRes; x++)
+            pixels(x, y) = _buffer(tile.rect.x + x, tile.rect.y + y);
+      }
+
+      if (!cached)
+      {
+        lock.unlock();
+        finished = renderTile(tile, pass, generation, function, pixels);
+        lock.lock();
+      }
+    }
+
+    // the request changed while we were working
+    if (!finished || generation != _generation)
+      continue;
+
+    if (!tile.done)
+    {
+      for (int y = 0; y < _tileRes; y++)
+        for (int x = 0; x < _tileRes; x++)
+          _buffer(tile.rect.x + x, tile.rect.y + y) = pixels(x, y);
+
+      if (_previewDone)
+        _dirty.push_back(index);
+
+      // this tile is final, so remember it
+      if (cached || pass == totalPasses - 1)
+      {
+        _tiles[index].done = true;
+        if (!cached && caching)
+        {
+          lock.unlock();
+          _cache->insert(tile.key, pixels);
+          lock.lock();
+          if (generation != _generation)
+            continue;
+        }
+      }
+    }
+
+    // was that the last tile of the pass?
+    _tilesRemaining--;
+    if (_tilesRemaining == 0)
+    {
+      if (pass == 0)
+        _previewDone = true;
+
+      _pass++;
+      _nextTile = 0;
+      _tilesRemaining = _tiles.size();
+      _workAvailable.notify_all();
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// compute one sample per block, reusing the samples that the previous
+// pass already computed, and fill the block with it
+///////////////////////////////////////////////////////////////////////
+bool VIEW_RENDERER::renderTile(const TILE& tile, int pass, int generation, const OFFSET_FUNCTION& function,
+                               FIELD_2D& pixels)
+{
+  const int block = 1 << (totalPasses - 1 - pass);
+  const int previousBlock = 2 * block;
+
+  const double size = ldexp((double)_rootSize, -tile.key.level);
+  const float xMin = _rootXMin + tile.key.x * size;
+  const float yMin = _rootYMin + tile.key.y * size;
+  const float dx = size / _tileRes;
+
+  for (int y = 0; y < _tileRes; y += block)
+  {
+    // bail if the request changed
+    if (_generation != generation)
+      return false;
+
+    for (int x = 0; x < _tileRes; x += block)
+    {
+      // this sample is already done
+      if (pass > 0 && x % previousBlock == 0 && y % previousBlock == 0)
+        continue;
+
+      float value;
+      if (function)
+        value = function(tile.xOffset + x * tile.dx, tile.yOffset + y * tile.dx);
+      else
+      {
+        VEC3F position;
+        position[0] = xMin + x * dx;
+        position[1] = yMin + y * dx;
+        value = _function(position);
+      }
+
+      for (int j = y; j < y + block; j++)
+        for (int i = x; i < x + block; i++)
+          pixels(i, j) = value;
+    }
+  }
+  return true;
+}
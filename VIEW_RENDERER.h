@@ -0,0 +1,158 @@
+#ifndef VIEW_RENDERER_H
+#define VIEW_RENDERER_H
+
+///////////////////////////////////////////////////////////////////////
+// Progressively renders a block of quadtree tiles into a FIELD_2D on
+// background threads.
+//
+// The quadtree is the same one TILE_CACHE uses: level 0 is one tile
+// covering the root window passed to the constructor, and each level
+// splits every tile into 2x2. A request is a rectangle of tiles at one
+// level. Tiles already in the cache are copied in right away. Missing
+// ones are first rendered as a coarse preview, one sample per 8x8
+// block, and then refined by halving the block size until every pixel
+// has been computed, at which point they go into the cache.
+//
+// The GL thread picks up finished tiles with "update" without ever
+// waiting on the workers. Asking for a new block of tiles cancels
+// whatever is still in flight for the old one.
+//
+// Past the depth where float positions can tell pixels apart, the
+// tiles come from "renderOffsets" instead: the same progressive passes
+// over a block centered on a point, with a function of each pixel's
+// offset from it, in double, and nothing cached.
+///////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include "FIELD_2D.h"
+#include "VEC3F.h"
+#include "TILE_CACHE.h"
+
+// computes the field value at a point in the plane
+typedef float (*FIELD_FUNCTION)(const VEC3F& position);
+
+// computes the field value at an offset from a point that the function
+// itself knows about, for views too deep for FIELD_FUNCTION
+typedef std::function<float(double xOffset, double yOffset)> OFFSET_FUNCTION;
+
+// the part of the plane covered by a field: pixel (x,y) sits at
+// (xMin + x * dx, yMin + y * dy)
+struct VIEW_WINDOW {
+  double xMin;
+  double yMin;
+  double dx;
+  double dy;
+};
+
+// a rectangle of pixels in the field
+struct TILE_RECT {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+class VIEW_RENDERER {
+public:
+  // every quadtree tile is tileRes x tileRes pixels; level 0 covers the
+  // square with lower left corner (rootXMin, rootYMin) and side
+  // rootSize. totalThreads = 0 uses one thread per core.
+  VIEW_RENDERER(FIELD_FUNCTION function, TILE_CACHE* cache, float rootXMin, float rootYMin, float rootSize,
+                int tileRes = 64, int totalThreads = 0);
+  ~VIEW_RENDERER();
+
+  // start rendering tiles [xTile, xTile + xTiles) x [yTile, yTile + yTiles)
+  // of "level", abandoning the previous request. "rootSet" identifies
+  // the function being rendered in the cache.
+  void render(unsigned long long rootSet, int level, int xTile, int yTile, int xTiles, int yTiles);
+
+  // start rendering xTiles x yTiles tiles of pixels "dx" apart, centered
+  // on (xCenter, yCenter), with "function" getting each pixel's offset
+  // from that center. "function" is kept until the next request.
+  void renderOffsets(const OFFSET_FUNCTION& function, double xCenter, double yCenter, double dx,
+                     int xTiles, int yTiles);
+
+  // copy whatever finished since the last call into "field". Returns
+  // false if nothing changed. "window" is set to the part of the plane
+  // that "field" now covers, and "changed" to the rectangles that need
+  // to be uploaded again.
+  bool update(FIELD_2D& field, VIEW_WINDOW& window, std::vector<TILE_RECT>& changed);
+
+  // is there still work in flight?
+  bool busy();
+
+  // quadtree geometry
+  const int tileRes() const { return _tileRes; };
+  float tileSize(int level) const;
+
+private:
+  // one quadtree tile of the current request
+  struct TILE {
+    TILE_KEY key;
+    TILE_RECT rect;
+    bool done;
+
+    // the offset of the tile's first pixel and the pixel spacing, for
+    // renderOffsets
+    double xOffset;
+    double yOffset;
+    double dx;
+  };
+
+  // sort the new request's tiles and start on its first pass
+  void start(int xTiles, int yTiles);
+
+  // the worker thread loop
+  void work();
+
+  // compute the samples of one pass for "tile", with "function" if it
+  // is set, returns false if the request changed in the meantime
+  bool renderTile(const TILE& tile, int pass, int generation, const OFFSET_FUNCTION& function,
+                  FIELD_2D& pixels);
+
+  FIELD_FUNCTION _function;
+  TILE_CACHE* _cache;
+  float _rootXMin;
+  float _rootYMin;
+  float _rootSize;
+  int _tileRes;
+  std::vector<std::thread> _threads;
+
+  std::mutex _mutex;
+  std::condition_variable _workAvailable;
+  bool _quit;
+
+  // bumped every time a new request comes in
+  std::atomic<int> _generation;
+
+  // the part of the plane being rendered, and its tiles, sorted from
+  // the center of the screen outwards
+  VIEW_WINDOW _window;
+  std::vector<TILE> _tiles;
+
+  // set for a renderOffsets request
+  OFFSET_FUNCTION _offsetFunction;
+
+  // current refinement pass, next tile to hand out in it, and the
+  // number of tiles in it that haven't been finished yet
+  int _pass;
+  unsigned int _nextTile;
+  int _tilesRemaining;
+
+  // finished samples for the current request
+  FIELD_2D _buffer;
+
+  // has the coarse preview been finished, and has it been picked up?
+  bool _previewDone;
+  bool _previewPublished;
+
+  // tiles finished since the last update
+  std::vector<int> _dirty;
+};
+
+#endif
@@ -0,0 +1,1291 @@
+///////////////////////////////////////////////////////////////////////
+// Microbenchmarks for the hot paths of the sweeps and the tools that
+// consume their output:
+//
+//   render/...    renderImage per polynomial degree and resolution
+//   boundary/...  the inverse iteration outline and fill, next to
+//                 renderImage on the same shape at large resolutions
+//   incremental/... a row of the -pinned grid rendered from scratch
+//                 and with each frame starting from the one before
+//   symmetry/...  renderImage on roots whose images are symmetric,
+//                 with and without filling in the reflections
+//   batch/...     16 root sets of a degree with renderImage's loop,
+//                 8 and 16 at a time across vector lanes, and one at a
+//                 time with 8 and 16 pixels across the lanes
+//   mixed/...     float, double and mixed precision renders of a shape
+//   deepZoom/...  a 1e-12 wide view iterated as perturbations of a
+//                 reference orbit, next to iterating it in long double
+//   gigapixel/... a shape streamed to disk a band of rows at a time,
+//                 next to renderImage writing the same PNG
+//   classify/...  the critical orbit prediction per degree
+//   atlas/...     a root-space atlas, on every core
+//   center/...    renderImage with centering turned on
+//   compare/...   the sameShape score per image size
+//   readPPM/...   and writePPM/... per image size
+//   writePNG/...  RGB and 1 bit mask PNGs per image size, at the fast
+//                 and the small settings
+//   movie/...     QUICKTIME_MOVIE::writeMovie, reported per frame
+//   field/...     FIELD_2D arithmetic, reductions and expressions on a
+//                 4k x 4k field, next to the plain scalar loops and
+//                 temporaries they replaced
+//   layout/...    the same 2D access patterns on row-major and tiled
+//                 fields
+//   fieldFile/... FIELD_2D binary writes and reads of a 4k x 4k mask,
+//                 raw, compressed and mapped
+//
+// Root sets come from a fixed seed so runs are comparable across
+// versions. Every case is run a few times untimed to warm up, then
+// timed over a number of repetitions. A summary goes to stdout and the
+// raw numbers go to a JSON file.
+//
+//   ./mandelbrot_benchmark [-reps n] [-warmup n] [-seed n] [-filter substring] [-out filename]
+//                          [-baseline filename] [-slowdown fraction]
+//
+// With a baseline from an earlier run, it exits with an error if any
+// case's median throughput fell by more than "slowdown" (0.2 = 20%).
+//
+// It also checks that optimizations didn't change the output; see
+// GOLDEN.h:
+//
+//   ./mandelbrot_benchmark -verify [golden filename] [-pixelTolerance fraction]
+//   ./mandelbrot_benchmark -record (golden filename)
+//
+// -verify checks against the checked-in golden.txt unless it's given
+// another file.
+//
+// and that the boundary renderer agrees with renderImage on the golden
+// configurations, at any resolution:
+//
+//   ./mandelbrot_benchmark -crossCheck (resolution) [-pixelTolerance fraction]
+//
+// that the vector lane kernels give exactly renderImage's masks:
+//
+//   ./mandelbrot_benchmark -checkBatch [resolution]
+//
+// that filling in symmetric halves by reflection gives exactly the
+// pixels a direct render does:
+//
+//   ./mandelbrot_benchmark -checkSymmetry [resolution]
+//
+// that -predict skip wouldn't throw away any of them, or a few
+// shapes whose critical orbits are captured late:
+//
+//   ./mandelbrot_benchmark -checkPredictions [resolution]
+//
+// and that field files with more cells than an int counts, and the
+// masks renderGigapixel streams out, read back exactly:
+//
+//   ./mandelbrot_benchmark -checkFieldFile [resolution]
+///////////////////////////////////////////////////////////////////////
+
+#define QUICKTIME_MOVIE_NO_GL
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <map>
+#include <functional>
+#include <chrono>
+#include "JULIA_RENDERER.h"
+#include "PPM_FILE.h"
+#include "SHAPE_COMPARE.h"
+#include "CRITICAL_ORBIT.h"
+#include "ATLAS.h"
+#include "BOUNDARY_RENDERER.h"
+#include "BATCH_RENDERER.h"
+#include "PERTURBATION_RENDERER.h"
+#include "GIGAPIXEL_RENDERER.h"
+#include "GOLDEN.h"
+#include "TYPED_FIELD_2D.h"
+#include "TILED_FIELD_2D.h"
+#include "FIELD_2D_FILE.h"
+#include "QUICKTIME_MOVIE.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// the timings of one case
+struct BENCHMARK_RESULT {
+  string name;
+  string unit; // what "items" counts
+  double items; // work done per repetition
+  vector<double> ms; // one per repetition
+  double extra; // a case-specific number, like the centering passes
+  string extraName;
+};
+
+int totalReps = 10;
+int totalWarmup = 2;
+unsigned int seed = 12345;
+string filter;
+vector<BENCHMARK_RESULT> results;
+
+// the checked-in golden images, recorded from the original renderer
+const char* goldenPath = "golden.txt";
+
+// scratch files, removed at exit
+const char* framePath = "benchmark_frame.ppm";
+const char* pngPath = "benchmark_frame.png";
+const char* moviePath = "benchmark_movie.mov";
+const char* fieldPath = "benchmark_field.fld";
+
+///////////////////////////////////////////////////////////////////////
+// time "work" and store the result; "work" is called totalWarmup
+// times untimed first
+///////////////////////////////////////////////////////////////////////
+BENCHMARK_RESULT* runCase(const string& name, const string& unit, double items, const function<void()>& work)
+{
+  if (!filter.empty() && name.find(filter) == string::npos)
+    return NULL;
+
+  for (int x = 0; x < totalWarmup; x++)
+    work();
+
+  BENCHMARK_RESULT result;
+  result.name = name;
+  result.unit = unit;
+  result.items = items;
+  result.extra = 0;
+  for (int x = 0; x < totalReps; x++)
+  {
+    auto start = steady_clock::now();
+    work();
+    auto stop = steady_clock::now();
+    result.ms.push_back(duration<double, milli>(stop - start).count());
+  }
+  results.push_back(result);
+  return &results.back();
+}
+
+///////////////////////////////////////////////////////////////////////
+// min, median, mean, standard deviation and max of the repetitions
+///////////////////////////////////////////////////////////////////////
+void statistics(const vector<double>& samples, double& minimum, double& median, double& mean, double& stddev, double& maximum)
+{
+  vector<double> sorted = samples;
+  sort(sorted.begin(), sorted.end());
+  const int total = sorted.size();
+
+  minimum = sorted[0];
+  maximum = sorted[total - 1];
+  median = (total % 2) ? sorted[total / 2] : 0.5 * (sorted[total / 2 - 1] + sorted[total / 2]);
+
+  mean = 0;
+  for (int x = 0; x < total; x++)
+    mean += sorted[x];
+  mean /= total;
+
+  stddev = 0;
+  for (int x = 0; x < total; x++)
+    stddev += (sorted[x] - mean) * (sorted[x] - mean);
+  stddev = (total > 1) ? sqrt(stddev / (total - 1)) : 0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// "degree" roots uniformly from X[-2, 2] Y[-2, 2]
+///////////////////////////////////////////////////////////////////////
+vector<VEC3F> seededRoots(mt19937& gen, int degree)
+{
+  uniform_real_distribution<float> dist(-2.0, 2.0);
+  vector<VEC3F> roots;
+  for (int x = 0; x < degree; x++)
+  {
+    float rootX = dist(gen);
+    float rootY = dist(gen);
+    roots.push_back(VEC3F(rootX, rootY, 0.0));
+  }
+  return roots;
+}
+
+///////////////////////////////////////////////////////////////////////
+// the first seeded root set of a degree that actually has a shape, so
+// the centering and compare cases have something to work on
+///////////////////////////////////////////////////////////////////////
+vector<VEC3F> seededShape(mt19937& gen, int degree, ofstream& comFile)
+{
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = 64;
+  RENDER_CONTEXT context;
+
+  while (true)
+  {
+    vector<VEC3F> roots = seededRoots(gen, degree);
+    if (renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context))
+      return roots;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void benchmarkRender(ofstream& comFile)
+{
+  const int degrees[] = {2, 3, 4, 6};
+  const int resolutions[] = {256, 512, 800};
+
+  for (int d = 0; d < 4; d++)
+  {
+    mt19937 gen(seed + degrees[d]);
+    vector<VEC3F> roots = seededRoots(gen, degrees[d]);
+
+    for (int r = 0; r < 3; r++)
+    {
+      RENDER_SETTINGS settings;
+      settings.xRes = settings.yRes = resolutions[r];
+      RENDER_CONTEXT context;
+
+      char name[256];
+      sprintf(name, "render/degree%i/%ix%i", degrees[d], resolutions[r], resolutions[r]);
+      runCase(name, "pixels", resolutions[r] * resolutions[r], [&]() {
+        renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      });
+    }
+
+    // what -predict pays per configuration instead of a render
+    RENDER_SETTINGS settings;
+    char name[256];
+    sprintf(name, "classify/degree%i", degrees[d]);
+    runCase(name, "configurations", 1, [&]() {
+      predictShape(roots, settings.maxIterations, settings.escapeRadius);
+    });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void benchmarkAtlas()
+{
+  ATLAS_SETTINGS settings;
+  settings.xRes = settings.yRes = 128;
+  FIELD_2D area;
+  FIELD_2D connectivity;
+
+  runCase("atlas/128x128", "root positions", settings.xRes * settings.yRes, [&]() {
+    buildAtlas(settings, area, connectivity);
+  });
+}
+
+///////////////////////////////////////////////////////////////////////
+// the render/... cases are mostly random roots without a shape, so
+// these use one that has one, which is where the outline pays off
+///////////////////////////////////////////////////////////////////////
+void benchmarkBoundary(ofstream& comFile)
+{
+  const int degrees[] = {2, 3};
+  const int resolutions[] = {800, 2048};
+
+  for (int d = 0; d < 2; d++)
+  {
+    mt19937 gen(seed + degrees[d]);
+    vector<VEC3F> roots = seededShape(gen, degrees[d], comFile);
+
+    for (int r = 0; r < 2; r++)
+    {
+      RENDER_SETTINGS settings;
+      settings.xRes = settings.yRes = resolutions[r];
+      RENDER_CONTEXT context;
+      FIELD_2D boundary;
+      FIELD_2D mask;
+
+      char name[256];
+      sprintf(name, "boundary/degree%i/%ix%i/renderImage", degrees[d], resolutions[r], resolutions[r]);
+      runCase(name, "pixels", resolutions[r] * resolutions[r], [&]() {
+        renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      });
+
+      sprintf(name, "boundary/degree%i/%ix%i", degrees[d], resolutions[r], resolutions[r]);
+      BENCHMARK_RESULT* result = runCase(name, "pixels", resolutions[r] * resolutions[r], [&]() {
+        renderBoundary(settings, roots, VEC3F(0.0, 0.0, 0.0), boundary);
+        fillBoundary(settings, roots, VEC3F(0.0, 0.0, 0.0), boundary, mask);
+      });
+      if (result)
+      {
+        // how far the two came out from each other
+        renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+        int flipped = 0;
+        for (int x = 0; x < mask.totalCells(); x++)
+          if ((mask[x] > 0.5) != (context.mask()[x] > 0.5))
+            flipped++;
+        result->extra = flipped;
+        result->extraName = "mismatched";
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// one row of a 16 x 16 -pinned grid, the way the sweep walks it, so
+// that each frame has the one before it to start from
+///////////////////////////////////////////////////////////////////////
+void benchmarkIncremental(ofstream& comFile)
+{
+  const int gridSize = 16;
+  const int resolutions[] = {256, 800};
+
+  vector<vector<VEC3F> > frames;
+  for (int x = 0; x < gridSize; x++)
+  {
+    vector<VEC3F> roots;
+    roots.push_back(VEC3F(0.0, 0.0, 0.0));
+    roots.push_back(VEC3F(-2.0 + 4.0 * x / (gridSize - 1), -2.0 + 4.0 * 6 / (gridSize - 1), 0.0));
+    frames.push_back(roots);
+  }
+
+  for (int r = 0; r < 2; r++)
+  {
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = resolutions[r];
+    RENDER_CONTEXT context;
+    const int pixels = resolutions[r] * resolutions[r] * gridSize;
+
+    char name[256];
+    sprintf(name, "incremental/pinned%i/%ix%i/full", gridSize, resolutions[r], resolutions[r]);
+    runCase(name, "pixels", pixels, [&]() {
+      for (unsigned int x = 0; x < frames.size(); x++)
+        renderImage(settings, frames[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    });
+
+    RENDER_SETTINGS incremental = settings;
+    incremental.incremental = true;
+    RENDER_CONTEXT incrementalContext;
+    sprintf(name, "incremental/pinned%i/%ix%i", gridSize, resolutions[r], resolutions[r]);
+    BENCHMARK_RESULT* result = runCase(name, "pixels", pixels, [&]() {
+      incrementalContext.forget();
+      for (unsigned int x = 0; x < frames.size(); x++)
+        renderImage(incremental, frames[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, incrementalContext);
+    });
+    if (result)
+    {
+      // should always be none
+      int flipped = 0;
+      incrementalContext.forget();
+      for (unsigned int x = 0; x < frames.size(); x++)
+      {
+        renderImage(settings, frames[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+        renderImage(incremental, frames[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, incrementalContext);
+        for (int y = 0; y < context.mask().totalCells(); y++)
+          if (context.mask()[y] != incrementalContext.mask()[y])
+            flipped++;
+      }
+      result->extra = flipped;
+      result->extraName = "mismatched";
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// a -pinned configuration with a real root, and a conjugate pair; 800
+// only lines some of its rows up with their reflections
+///////////////////////////////////////////////////////////////////////
+void benchmarkSymmetry(ofstream& comFile)
+{
+  const int resolutions[] = {512, 800};
+  const char* names[] = {"pinnedReal", "conjugate"};
+  vector<VEC3F> rootSets[2];
+  rootSets[0].push_back(VEC3F(0.0, 0.0, 0.0));
+  rootSets[0].push_back(VEC3F(-0.75, 0.0, 0.0));
+  rootSets[1].push_back(VEC3F(-0.5, 0.6, 0.0));
+  rootSets[1].push_back(VEC3F(-0.5, -0.6, 0.0));
+
+  for (int x = 0; x < 2; x++)
+    for (int r = 0; r < 2; r++)
+    {
+      RENDER_SETTINGS settings;
+      settings.xRes = settings.yRes = resolutions[r];
+      settings.symmetry = false;
+      RENDER_CONTEXT context;
+
+      char name[256];
+      sprintf(name, "symmetry/%s/%ix%i/full", names[x], resolutions[r], resolutions[r]);
+      runCase(name, "pixels", resolutions[r] * resolutions[r], [&]() {
+        renderImage(settings, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      });
+
+      RENDER_SETTINGS symmetric = settings;
+      symmetric.symmetry = true;
+      RENDER_CONTEXT symmetricContext;
+      sprintf(name, "symmetry/%s/%ix%i", names[x], resolutions[r], resolutions[r]);
+      BENCHMARK_RESULT* result = runCase(name, "pixels", resolutions[r] * resolutions[r], [&]() {
+        renderImage(symmetric, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, symmetricContext);
+      });
+      if (result)
+      {
+        renderImage(settings, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+        renderImage(symmetric, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, symmetricContext);
+        int flipped = 0;
+        for (int y = 0; y < context.mask().totalCells(); y++)
+          if (context.mask()[y] != symmetricContext.mask()[y])
+            flipped++;
+        result->extra = flipped;
+        result->extraName = "mismatched";
+      }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////
+// float, double, and float with the doubtful pixels done again in
+// double; "mismatched" is how far each is from all double
+///////////////////////////////////////////////////////////////////////
+void benchmarkMixedPrecision(ofstream& comFile)
+{
+  const int degrees[] = {2, 3};
+  const int resolution = 800;
+
+  for (int d = 0; d < 2; d++)
+  {
+    mt19937 gen(seed + degrees[d]);
+    vector<VEC3F> roots = seededShape(gen, degrees[d], comFile);
+
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = resolution;
+    RENDER_CONTEXT context;
+
+    // the same pixel centers as renderImage
+    const float dx = 4.0f / resolution;
+    FIELD_2D reference(resolution, resolution);
+    auto renderDouble = [&]() {
+      for (int y = 0; y < resolution; y++)
+        for (int x = 0; x < resolution; x++)
+        {
+          VEC3F center;
+          center[0] = -2.0f + 0.0f + x * dx;
+          center[1] = -2.0f + 0.0f + y * dx;
+          const int totalIterations = iterateRootsDouble(center, roots, settings.maxIterations, settings.escapeRadius);
+          reference(x, y) = (totalIterations == settings.maxIterations) ? 1.0 : 0.0;
+        }
+    };
+    renderDouble();
+    auto mismatched = [&]() {
+      int flipped = 0;
+      for (int x = 0; x < reference.totalCells(); x++)
+        if (context.mask()[x] != reference[x])
+          flipped++;
+      return flipped;
+    };
+
+    char name[256];
+    sprintf(name, "mixed/degree%i/%ix%i/float", degrees[d], resolution, resolution);
+    BENCHMARK_RESULT* result = runCase(name, "pixels", resolution * resolution, [&]() {
+      renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    });
+    if (result)
+    {
+      result->extra = mismatched();
+      result->extraName = "mismatched";
+    }
+
+    sprintf(name, "mixed/degree%i/%ix%i/double", degrees[d], resolution, resolution);
+    runCase(name, "pixels", resolution * resolution, renderDouble);
+
+    RENDER_SETTINGS mixed = settings;
+    mixed.mixedPrecision = true;
+    sprintf(name, "mixed/degree%i/%ix%i", degrees[d], resolution, resolution);
+    result = runCase(name, "pixels", resolution * resolution, [&]() {
+      renderImage(mixed, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    });
+    if (result)
+    {
+      result->extra = mismatched();
+      result->extraName = "mismatched";
+      cout << "  " << context.recheckedPixels() << " pixels rechecked in double" << endl;
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// iterateRoots in long double, for deepZoom to check against
+///////////////////////////////////////////////////////////////////////
+int iterateLongDouble(long double x, long double y, const vector<VEC3F>& roots, int maxIterations, float escapeRadius)
+{
+  long double magnitude = sqrt(x * x + y * y);
+  int totalIterations = 0;
+  while (magnitude < escapeRadius && totalIterations < maxIterations)
+  {
+    long double gX = 1.0;
+    long double gY = 0.0;
+    for (unsigned int k = 0; k < roots.size(); k++)
+    {
+      const long double factorX = x - roots[k][0];
+      const long double factorY = y - roots[k][1];
+      const long double productX = gX * factorX - gY * factorY;
+      const long double productY = gX * factorY + gY * factorX;
+      gX = productX;
+      gY = productY;
+    }
+    x = gX;
+    y = gY;
+    magnitude = sqrt(x * x + y * y);
+    totalIterations++;
+
+    if (magnitude > escapeRadius)
+      break;
+    if (magnitude < 1e-7)
+      break;
+  }
+  return totalIterations;
+}
+
+///////////////////////////////////////////////////////////////////////
+// a view 4e-12 across, next to a repelling fixed point of z (z + 0.75)
+// and of conjugate roots' polynomial, with enough iterations
+// for the pixels to get away from it. Both are counted in iterations;
+// "mismatched" is how many pixels got a different count in long double.
+///////////////////////////////////////////////////////////////////////
+void benchmarkDeepZoom()
+{
+  const int resolution = 256;
+  const double width = 4e-12;
+  const int maxIterations = 500;
+  const char* names[] = {"fixedPoint", "conjugate"};
+  vector<VEC3F> rootSets[2];
+  rootSets[0].push_back(VEC3F(0.0, 0.0, 0.0));
+  rootSets[0].push_back(VEC3F(-0.75, 0.0, 0.0));
+  rootSets[1].push_back(VEC3F(-0.5, 0.6, 0.0));
+  rootSets[1].push_back(VEC3F(-0.5, -0.6, 0.0));
+  const long double xCenters[] = {0.2500000000003L, 0.0000000000001L};
+  const long double yCenters[] = {0.0000000000001L, 0.7810249675907654L};
+  const double dx = width / resolution;
+
+  for (int x = 0; x < 2; x++)
+  {
+    RENDER_SETTINGS settings;
+    vector<int> perturbed(resolution * resolution);
+    vector<int> direct(resolution * resolution);
+    long long iterations = 0;
+
+    auto perturb = [&]() {
+      PERTURBATION_RENDERER reference(rootSets[x], xCenters[x], yCenters[x], maxIterations, settings.escapeRadius);
+      for (int j = 0; j < resolution; j++)
+        for (int i = 0; i < resolution; i++)
+          perturbed[i + j * resolution] = reference.iterate((i - resolution / 2) * dx, (j - resolution / 2) * dx);
+    };
+    perturb();
+    for (int i = 0; i < resolution * resolution; i++)
+      iterations += perturbed[i];
+
+    auto iterateDirect = [&]() {
+      for (int j = 0; j < resolution; j++)
+        for (int i = 0; i < resolution; i++)
+          direct[i + j * resolution] = iterateLongDouble(xCenters[x] + (i - resolution / 2) * dx,
+                                                         yCenters[x] + (j - resolution / 2) * dx,
+                                                         rootSets[x], maxIterations, settings.escapeRadius);
+    };
+    iterateDirect();
+
+    char name[256];
+    sprintf(name, "deepZoom/%s/%ix%i", names[x], resolution, resolution);
+    BENCHMARK_RESULT* result = runCase(name, "iterations", iterations, perturb);
+    if (result)
+    {
+      int differing = 0;
+      for (int i = 0; i < resolution * resolution; i++)
+        if (perturbed[i] != direct[i])
+          differing++;
+      result->extra = differing;
+      result->extraName = "mismatched";
+    }
+
+    sprintf(name, "deepZoom/%s/%ix%i/longDouble", names[x], resolution, resolution);
+    runCase(name, "iterations", iterations, iterateDirect);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// lanes across root sets against lanes across pixels, on the same
+// root sets
+///////////////////////////////////////////////////////////////////////
+void benchmarkBatch(ofstream& comFile)
+{
+  const int degrees[] = {2, 3};
+  const int totalSets = 16;
+  const int resolution = 512;
+
+  for (int d = 0; d < 2; d++)
+  {
+    mt19937 gen(seed + degrees[d]);
+    vector<vector<VEC3F> > rootSets;
+    for (int x = 0; x < totalSets; x++)
+      rootSets.push_back(seededRoots(gen, degrees[d]));
+
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = resolution;
+    RENDER_CONTEXT context;
+    const int pixels = resolution * resolution * totalSets;
+
+    // what the lanes have to match
+    vector<FIELD_2D> expected(totalSets);
+    for (int x = 0; x < totalSets; x++)
+    {
+      renderImage(settings, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      expected[x] = context.mask();
+    }
+    auto mismatched = [&](const vector<FIELD_2D>& masks) {
+      int flipped = 0;
+      for (int x = 0; x < totalSets; x++)
+        for (int y = 0; y < masks[x].totalCells(); y++)
+          if (masks[x][y] != expected[x][y])
+            flipped++;
+      return flipped;
+    };
+
+    char name[256];
+    sprintf(name, "batch/degree%i/%ix%i/renderImage", degrees[d], resolution, resolution);
+    runCase(name, "pixels", pixels, [&]() {
+      for (int x = 0; x < totalSets; x++)
+        renderImage(settings, rootSets[x], "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    });
+
+    const int lanes[] = {BATCH_LANES, BATCH_WIDE_LANES};
+    for (int l = 0; l < 2; l++)
+    {
+      vector<FIELD_2D> masks;
+      sprintf(name, "batch/degree%i/%ix%i/rootLanes%i", degrees[d], resolution, resolution, lanes[l]);
+      BENCHMARK_RESULT* result = runCase(name, "pixels", pixels, [&]() {
+        renderBatch(settings, rootSets, masks, lanes[l]);
+      });
+      if (result)
+      {
+        renderBatch(settings, rootSets, masks, lanes[l]);
+        result->extra = mismatched(masks);
+        result->extraName = "mismatched";
+      }
+
+      masks.resize(totalSets);
+      sprintf(name, "batch/degree%i/%ix%i/pixelLanes%i", degrees[d], resolution, resolution, lanes[l]);
+      result = runCase(name, "pixels", pixels, [&]() {
+        for (int x = 0; x < totalSets; x++)
+          renderPixelLanes(settings, rootSets[x], masks[x], lanes[l]);
+      });
+      if (result)
+      {
+        for (int x = 0; x < totalSets; x++)
+          renderPixelLanes(settings, rootSets[x], masks[x], lanes[l]);
+        result->extra = mismatched(masks);
+        result->extraName = "mismatched";
+      }
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// renderGigapixel streaming a shape to disk in bands, next to
+// renderImage holding all of it; "bands" is the most it had in memory
+///////////////////////////////////////////////////////////////////////
+void benchmarkGigapixel(ofstream& comFile)
+{
+  const int resolution = 2048;
+  mt19937 gen(seed + 2);
+  vector<VEC3F> roots = seededShape(gen, 2, comFile);
+
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = resolution;
+  settings.imageFormat = RENDER_SETTINGS::IMAGE_PNG;
+  settings.png = PNG_SETTINGS::fastest();
+  RENDER_CONTEXT context;
+
+  char name[256];
+  sprintf(name, "gigapixel/degree2/%ix%i/renderImage", resolution, resolution);
+  runCase(name, "pixels", resolution * resolution, [&]() {
+    renderImage(settings, roots, pngPath, VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+  });
+
+  GIGAPIXEL_SETTINGS gigapixel;
+  gigapixel.xRes = gigapixel.yRes = resolution;
+  gigapixel.png = PNG_SETTINGS::fastest();
+  const GIGAPIXEL_SETTINGS::FORMAT formats[] = {GIGAPIXEL_SETTINGS::GIGAPIXEL_FIELD, GIGAPIXEL_SETTINGS::GIGAPIXEL_PNG};
+  const char* formatNames[] = {"field", "png"};
+  for (int f = 0; f < 2; f++)
+  {
+    gigapixel.format = formats[f];
+    const char* path = (formats[f] == GIGAPIXEL_SETTINGS::GIGAPIXEL_PNG) ? pngPath : fieldPath;
+    GIGAPIXEL_RESULT gigapixelResult;
+    string error;
+    sprintf(name, "gigapixel/degree2/%ix%i/%s", resolution, resolution, formatNames[f]);
+    BENCHMARK_RESULT* result = runCase(name, "pixels", resolution * resolution, [&]() {
+      renderGigapixel(gigapixel, roots, path, gigapixelResult, error);
+    });
+    if (result)
+    {
+      result->extra = gigapixelResult.peakBands;
+      result->extraName = "bands";
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void benchmarkCentering(ofstream& comFile)
+{
+  const int resolutions[] = {256, 512};
+
+  mt19937 gen(seed);
+  vector<VEC3F> roots = seededShape(gen, 2, comFile);
+
+  for (int r = 0; r < 2; r++)
+  {
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = resolutions[r];
+    RENDER_CONTEXT context;
+
+    char name[256];
+    sprintf(name, "center/degree2/%ix%i", resolutions[r], resolutions[r]);
+    BENCHMARK_RESULT* result = runCase(name, "frames", 1, [&]() {
+      renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 1, comFile, context);
+    });
+    if (result)
+    {
+      result->extra = context.passes();
+      result->extraName = "passes";
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// render two different shapes at each size and score them against
+// each other
+///////////////////////////////////////////////////////////////////////
+void benchmarkCompare(ofstream& comFile)
+{
+  const int resolutions[] = {256, 512, 800, 1024};
+
+  mt19937 gen(seed + 100);
+  vector<VEC3F> first = seededShape(gen, 2, comFile);
+  vector<VEC3F> second = seededShape(gen, 2, comFile);
+
+  for (int r = 0; r < 4; r++)
+  {
+    const int res = resolutions[r];
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = res;
+
+    RENDER_CONTEXT context;
+    renderImage(settings, first, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    vector<unsigned char> reference(context.rgb(), context.rgb() + 3 * res * res);
+    renderImage(settings, second, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+    vector<unsigned char> image(context.rgb(), context.rgb() + 3 * res * res);
+
+    char name[256];
+    sprintf(name, "compare/%ix%i", res, res);
+    SHAPE_SCORE score;
+    BENCHMARK_RESULT* result = runCase(name, "pixels", res * res, [&]() {
+      scoreShapes(&reference[0], &image[0], res, res, score);
+    });
+    if (result)
+    {
+      result->extra = score.ratio;
+      result->extraName = "ratio";
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void benchmarkPPM(ofstream& comFile)
+{
+  const int resolutions[] = {256, 512, 800, 1024};
+
+  mt19937 gen(seed + 200);
+  vector<VEC3F> roots = seededShape(gen, 2, comFile);
+
+  for (int r = 0; r < 4; r++)
+  {
+    const int res = resolutions[r];
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = res;
+    RENDER_CONTEXT context;
+    renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+
+    char name[256];
+    sprintf(name, "writePPM/%ix%i", res, res);
+    runCase(name, "bytes", 3.0 * res * res, [&]() {
+      writePPM(framePath, res, res, context.rgb());
+    });
+
+    writePPM(framePath, res, res, context.rgb());
+    sprintf(name, "readPPM/%ix%i", res, res);
+    runCase(name, "bytes", 3.0 * res * res, [&]() {
+      unsigned char* pixels = NULL;
+      int width, height;
+      readPPM(framePath, pixels, width, height, false);
+      delete[] pixels;
+    });
+
+    // "bytes" is the raw image in, so fast vs small compares throughput
+    const PNG_SETTINGS pngSettings[] = {PNG_SETTINGS::fastest(), PNG_SETTINGS::smallest()};
+    const char* pngNames[] = {"fast", "small"};
+    for (int p = 0; p < 2; p++)
+    {
+      sprintf(name, "writePNG/rgb/%s/%ix%i", pngNames[p], res, res);
+      runCase(name, "bytes", 3.0 * res * res, [&]() {
+        writePNG(pngPath, res, res, context.rgb(), pngSettings[p]);
+      });
+      sprintf(name, "writePNG/mask/%s/%ix%i", pngNames[p], res, res);
+      runCase(name, "bytes", 3.0 * res * res, [&]() {
+        writeMaskPNG(pngPath, res, res, context.rgb(), pngSettings[p]);
+      });
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// fill a movie with rendered frames and write it out
+///////////////////////////////////////////////////////////////////////
+void benchmarkMovie(ofstream& comFile)
+{
+  const int resolutions[] = {256, 512};
+  const int totalFrames = 30;
+
+  for (int r = 0; r < 2; r++)
+  {
+    const int res = resolutions[r];
+    RENDER_SETTINGS settings;
+    settings.xRes = settings.yRes = res;
+    RENDER_CONTEXT context;
+
+    mt19937 gen(seed + 300);
+    vector<unsigned char> frames;
+    for (int x = 0; x < totalFrames; x++)
+    {
+      vector<VEC3F> roots = seededShape(gen, 2, comFile);
+      renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+      frames.insert(frames.end(), context.rgb(), context.rgb() + 3 * res * res);
+    }
+
+    char name[256];
+    sprintf(name, "movie/%ix%i", res, res);
+    runCase(name, "frames", totalFrames, [&]() {
+      QUICKTIME_MOVIE movie;
+      for (int x = 0; x < totalFrames; x++)
+        movie.addFrame(&frames[3 * res * res * x], res, res);
+      movie.writeMovie(moviePath);
+    });
+  }
+}
+
+///////////////////////////////////////////////////////////////////////
+// each FIELD_2D operation, and a single threaded scalar loop doing the
+// same thing for comparison
+///////////////////////////////////////////////////////////////////////
+void benchmarkField()
+{
+  const int res = 4096;
+  const double cells = (double)res * res;
+
+  mt19937 gen(seed + 400);
+  uniform_real_distribution<float> dist(0.5, 1.5);
+  FIELD_2D first(res, res);
+  FIELD_2D second(res, res);
+  for (int x = 0; x < first.totalCells(); x++)
+  {
+    first[x] = dist(gen);
+    second[x] = dist(gen);
+  }
+
+  // keep the optimizer from throwing the reductions away
+  volatile float sink = 0;
+  float* a = first.data();
+  float* b = second.data();
+  const int total = first.totalCells();
+
+  char name[256];
+  sprintf(name, "field/add/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { first += second; });
+  sprintf(name, "field/add/scalar/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    for (int x = 0; x < total; x++)
+      a[x] += b[x];
+  });
+
+  sprintf(name, "field/scale/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { first *= 0.5f; });
+  sprintf(name, "field/scale/scalar/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    for (int x = 0; x < total; x++)
+      a[x] *= 0.5f;
+  });
+
+  sprintf(name, "field/sum/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { sink = first.sum(); });
+  sprintf(name, "field/sum/scalar/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    float result = 0;
+    for (int x = 0; x < total; x++)
+      result += a[x];
+    sink = result;
+  });
+
+  sprintf(name, "field/max/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { sink = first.max(); });
+  sprintf(name, "field/max/scalar/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    float result = a[0];
+    for (int x = 0; x < total; x++)
+      result = (a[x] > result) ? a[x] : result;
+    sink = result;
+  });
+
+  sprintf(name, "field/normalize/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { first.normalize(); });
+
+  sprintf(name, "field/abs/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { first.abs(); });
+
+  // a whole expression in one pass, against a temporary per operator
+  FIELD_2D result(res, res);
+  sprintf(name, "field/expression/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { result = first * 0.5f + second * 2.0f + 1.0f; });
+  sprintf(name, "field/expression/temporaries/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    FIELD_2D left(first);
+    left *= 0.5f;
+    FIELD_2D right(second);
+    right *= 2.0f;
+    left += right;
+    left += 1.0f;
+    result = left;
+  });
+
+  // returning a field by value hands its cells over instead of copying
+  auto halved = [](const FIELD_2D& field) {
+    FIELD_2D final(field);
+    final *= 0.5f;
+    return final;
+  };
+  sprintf(name, "field/return/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { result = halved(first); });
+
+  // packing into the compact mask forms and back
+  BIT_FIELD_2D bits;
+  sprintf(name, "field/packBits/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { bits.fromField(second, 1.0f); });
+  sprintf(name, "field/unpackBits/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { bits.toField(result); });
+  BYTE_FIELD_2D bytes;
+  sprintf(name, "field/packBytes/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() { bytes.fromField(first); });
+
+  // log of the normalized field would hit zero, so work on a fresh copy
+  sprintf(name, "field/log/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    first = second;
+    first.log();
+  });
+  (void)sink;
+}
+
+///////////////////////////////////////////////////////////////////////
+// cells whose 4-neighborhood isn't all the same, like a boundary tracer
+// or the categorizer's neighborhood scans look at
+///////////////////////////////////////////////////////////////////////
+template <class FIELD>
+int boundaryCells(const FIELD& field)
+{
+  int total = 0;
+  for (int y = 1; y < field.yRes() - 1; y++)
+    for (int x = 1; x < field.xRes() - 1; x++)
+    {
+      const float center = field(x, y);
+      total += (field(x - 1, y) != center) | (field(x + 1, y) != center) |
+               (field(x, y - 1) != center) | (field(x, y + 1) != center);
+    }
+  return total;
+}
+
+///////////////////////////////////////////////////////////////////////
+// sum down the columns, the worst case for row-major
+///////////////////////////////////////////////////////////////////////
+template <class FIELD>
+float columnSum(const FIELD& field)
+{
+  float total = 0;
+  for (int x = 0; x < field.xRes(); x++)
+    for (int y = 0; y < field.yRes(); y++)
+      total += field(x, y);
+  return total;
+}
+
+template <class FIELD>
+void benchmarkLayout(const string& layout, const FIELD& field, const FIELD_2D& mask)
+{
+  const int res = mask.xRes();
+  const double cells = (double)res * res;
+  volatile float sink = 0;
+  char name[256];
+
+  sprintf(name, "layout/%s/boundary/%ix%i", layout.c_str(), res, res);
+  runCase(name, "cells", cells, [&]() { sink = boundaryCells(field); });
+  sprintf(name, "layout/%s/columns/%ix%i", layout.c_str(), res, res);
+  runCase(name, "cells", cells, [&]() { sink = columnSum(field); });
+  (void)sink;
+}
+
+///////////////////////////////////////////////////////////////////////
+// a real mask, scaled up to 4k x 4k, in each layout and through the
+// binary format
+///////////////////////////////////////////////////////////////////////
+void benchmarkLayouts(ofstream& comFile)
+{
+  const int res = 4096;
+  const double cells = (double)res * res;
+
+  mt19937 gen(seed + 500);
+  vector<VEC3F> roots = seededShape(gen, 3, comFile);
+  RENDER_SETTINGS settings;
+  settings.xRes = settings.yRes = 512;
+  RENDER_CONTEXT context;
+  renderImage(settings, roots, "/dev/null", VEC3F(0.0, 0.0, 0.0), 0, comFile, context);
+
+  FIELD_2D mask(res, res);
+  for (int y = 0; y < res; y++)
+    for (int x = 0; x < res; x++)
+      mask(x, y) = context.mask()(x * 512 / res, y * 512 / res);
+
+  TILED_FIELD_2D<3> tiled8;
+  tiled8.fromField(mask);
+  TILED_FIELD_2D<6> tiled64;
+  tiled64.fromField(mask);
+
+  benchmarkLayout("rowMajor", mask, mask);
+  benchmarkLayout("tiled8", tiled8, mask);
+  benchmarkLayout("tiled64", tiled64, mask);
+
+  // streaming whole rows out, the case tiling is supposed not to hurt
+  vector<float> row(res);
+  char name[256];
+  sprintf(name, "layout/rowMajor/rows/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    for (int y = 0; y < res; y++)
+      memcpy(&row[0], mask.data() + y * res, res * sizeof(float));
+  });
+  sprintf(name, "layout/tiled8/rows/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    for (int y = 0; y < res; y++)
+      tiled8.getRow(y, &row[0]);
+  });
+  sprintf(name, "layout/tiled64/rows/%ix%i", res, res);
+  runCase(name, "cells", cells, [&]() {
+    for (int y = 0; y < res; y++)
+      tiled64.getRow(y, &row[0]);
+  });
+
+  // the same mask through the binary format
+  const double bytes = cells * sizeof(float);
+  FIELD_2D loaded;
+  sprintf(name, "fieldFile/write/%ix%i", res, res);
+  runCase(name, "bytes", bytes, [&]() { mask.write(fieldPath); });
+  sprintf(name, "fieldFile/read/%ix%i", res, res);
+  runCase(name, "bytes", bytes, [&]() { loaded.read(fieldPath); });
+  sprintf(name, "fieldFile/map/%ix%i", res, res);
+  runCase(name, "bytes", bytes, [&]() {
+    MAPPED_FIELD_2D mapped;
+    mapped.open(fieldPath);
+  });
+  sprintf(name, "fieldFile/writeCompressed/%ix%i", res, res);
+  runCase(name, "bytes", bytes, [&]() { mask.write(fieldPath, true); });
+  sprintf(name, "fieldFile/readCompressed/%ix%i", res, res);
+  runCase(name, "bytes", bytes, [&]() { loaded.read(fieldPath); });
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+void writeJSON(const string& filename)
+{
+  ofstream out(filename.c_str());
+  if (!out.is_open())
+  {
+    cout << "Couldn't open " << filename << " for writing." << endl;
+    return;
+  }
+
+  out << "{" << endl;
+  out << "  \"seed\": " << seed << "," << endl;
+  out << "  \"warmup\": " << totalWarmup << "," << endl;
+  out << "  \"reps\": " << totalReps << "," << endl;
+  out << "  \"results\": [" << endl;
+  for (unsigned int x = 0; x < results.size(); x++)
+  {
+    const BENCHMARK_RESULT& result = results[x];
+    double minimum, median, mean, stddev, maximum;
+    statistics(result.ms, minimum, median, mean, stddev, maximum);
+
+    out << "    {\"name\": \"" << result.name << "\", \"unit\": \"" << result.unit << "\", \"items\": " << result.items
+        << ", \"minMs\": " << minimum << ", \"medianMs\": " << median << ", \"meanMs\": " << mean
+        << ", \"stddevMs\": " << stddev << ", \"maxMs\": " << maximum
+        << ", \"itemsPerSecond\": " << result.items / (median * 0.001);
+    if (!result.extraName.empty())
+      out << ", \"" << result.extraName << "\": " << result.extra;
+    out << ", \"samplesMs\": [";
+    for (unsigned int y = 0; y < result.ms.size(); y++)
+      out << ((y > 0) ? ", " : "") << result.ms[y];
+    out << "]}" << ((x + 1 < results.size()) ? "," : "") << endl;
+  }
+  out << "  ]" << endl;
+  out << "}" << endl;
+}
+
+///////////////////////////////////////////////////////////////////////
+// compare the throughput of every case against an earlier run; returns
+// false if anything got slower than allowed
+///////////////////////////////////////////////////////////////////////
+bool checkBaseline(const string& filename, double slowdown)
+{
+  ifstream in(filename.c_str());
+  if (!in.is_open())
+  {
+    cout << "Couldn't open baseline " << filename << "." << endl;
+    return false;
+  }
+
+  // every result is on its own line, as writeJSON writes them
+  map<string, double> baseline;
+  string line;
+  const string nameKey("\"name\": \"");
+  const string rateKey("\"itemsPerSecond\": ");
+  while (getline(in, line))
+  {
+    size_t name = line.find(nameKey);
+    size_t rate = line.find(rateKey);
+    if (name == string::npos || rate == string::npos)
+      continue;
+    name += nameKey.size();
+    baseline[line.substr(name, line.find('"', name) - name)] = atof(line.c_str() + rate + rateKey.size());
+  }
+
+  bool passed = true;
+  cout << endl;
+  for (unsigned int x = 0; x < results.size(); x++)
+  {
+    map<string, double>::iterator found = baseline.find(results[x].name);
+    if (found == baseline.end())
+      continue;
+
+    double minimum, median, mean, stddev, maximum;
+    statistics(results[x].ms, minimum, median, mean, stddev, maximum);
+    const double rate = results[x].items / (median * 0.001);
+    const double ratio = rate / found->second;
+    if (ratio < 1.0 - slowdown)
+    {
+      printf("SLOWER  %-28s %6.1f%% of baseline\n", results[x].name.c_str(), 100.0 * ratio);
+      passed = false;
+    }
+  }
+  cout << (passed ? "Throughput is within " : "Throughput dropped by more than ") << 100.0 * slowdown << "% of " << filename << endl;
+  return passed;
+}
+
+///////////////////////////////////////////////////////////////////////
+///////////////////////////////////////////////////////////////////////
+int main(int argc, char** argv)
+{
+  string outFile("benchmark.json");
+  string baselineFile;
+  double slowdown = 0.2;
+  GOLDEN_TOLERANCE tolerance;
+
+  // golden image modes
+  if (argc >= 3 && strcmp(argv[1], "-record") == 0)
+    return recordGolden(argv[2]) ? 0 : 1;
+  if (argc >= 2 && strcmp(argv[1], "-verify") == 0)
+  {
+    string golden = goldenPath;
+    int x = 2;
+    if (x < argc && argv[x][0] != '-')
+      golden = argv[x++];
+    if (x + 1 < argc && strcmp(argv[x], "-pixelTolerance") == 0)
+      tolerance.pixelFraction = atof(argv[x + 1]);
+    return verifyGolden(golden, tolerance) ? 0 : 1;
+  }
+  if (argc >= 3 && strcmp(argv[1], "-crossCheck") == 0)
+  {
+    if (argc >= 5 && strcmp(argv[3], "-pixelTolerance") == 0)
+      tolerance.pixelFraction = atof(argv[4]);
+    return crossCheckBoundary(atoi(argv[2]), tolerance) ? 0 : 1;
+  }
+  if (argc >= 2 && strcmp(argv[1], "-checkBatch") == 0)
+    return checkBatch((argc >= 3) ? atoi(argv[2]) : 256) ? 0 : 1;
+  if (argc >= 2 && strcmp(argv[1], "-checkSymmetry") == 0)
+    return checkSymmetry((argc >= 3) ? atoi(argv[2]) : 512) ? 0 : 1;
+  if (argc >= 2 && strcmp(argv[1], "-checkPredictions") == 0)
+    return checkPredictions((argc >= 3) ? atoi(argv[2]) : 400) ? 0 : 1;
+  if (argc >= 2 && strcmp(argv[1], "-checkFieldFile") == 0)
+    return checkFieldFile(fieldPath, (argc >= 3) ? atoi(argv[2]) : 512) ? 0 : 1;
+
+  for (int x = 1; x < argc; x++)
+  {
+    if (x + 1 < argc && strcmp(argv[x], "-reps") == 0)
+      totalReps = atoi(argv[++x]);
+    else if (x + 1 < argc && strcmp(argv[x], "-warmup") == 0)
+      totalWarmup = atoi(argv[++x]);
+    else if (x + 1 < argc && strcmp(argv[x], "-seed") == 0)
+      seed = strtoul(argv[++x], NULL, 10);
+    else if (x + 1 < argc && strcmp(argv[x], "-filter") == 0)
+      filter = argv[++x];
+    else if (x + 1 < argc && strcmp(argv[x], "-out") == 0)
+      outFile = argv[++x];
+    else if (x + 1 < argc && strcmp(argv[x], "-baseline") == 0)
+      baselineFile = argv[++x];
+    else if (x + 1 < argc && strcmp(argv[x], "-slowdown") == 0)
+      slowdown = atof(argv[++x]);
+    else
+    {
+      cout << "Program usage: " << argv[0] << " [-reps n] [-warmup n] [-seed n] [-filter substring] [-out filename] [-baseline filename] [-slowdown fraction]" << endl;
+      cout << "               " << argv[0] << " -verify [golden filename] [-pixelTolerance fraction]" << endl;
+      cout << "               " << argv[0] << " -record (golden filename)" << endl;
+      cout << "               " << argv[0] << " -crossCheck (resolution) [-pixelTolerance fraction]" << endl;
+      cout << "               " << argv[0] << " -checkBatch [resolution]" << endl;
+      cout << "               " << argv[0] << " -checkSymmetry [resolution]" << endl;
+      cout << "               " << argv[0] << " -checkPredictions [resolution]" << endl;
+      cout << "               " << argv[0] << " -checkFieldFile [resolution]" << endl;
+      return 1;
+    }
+  }
+  if (totalReps < 1)
+    totalReps = 1;
+
+  // the COM log isn't what we're measuring
+  ofstream comFile("/dev/null");
+
+  benchmarkRender(comFile);
+  benchmarkAtlas();
+  benchmarkBoundary(comFile);
+  benchmarkIncremental(comFile);
+  benchmarkSymmetry(comFile);
+  benchmarkBatch(comFile);
+  benchmarkMixedPrecision(comFile);
+  benchmarkDeepZoom();
+  benchmarkGigapixel(comFile);
+  benchmarkCentering(comFile);
+  benchmarkCompare(comFile);
+  benchmarkPPM(comFile);
+  benchmarkMovie(comFile);
+  benchmarkField();
+  benchmarkLayouts(comFile);
+
+  remove(framePath);
+  remove(pngPath);
+  remove(moviePath);
+  remove(fieldPath);
+
+  cout << endl;
+  printf("%-28s %12s %12s %12s %14s\n", "case", "median ms", "min ms", "stddev ms", "items/s");
+  for (unsigned int x = 0; x < results.size(); x++)
+  {
+    double minimum, median, mean, stddev, maximum;
+    statistics(results[x].ms, minimum, median, mean, stddev, maximum);
+    printf("%-28s %12.3f %12.3f %12.3f %14.4g\n", results[x].name.c_str(), median, minimum, stddev,
+           results[x].items / (median * 0.001));
+  }
+
+  writeJSON(outFile);
+  cout << endl << "Wrote " << outFile << endl;
+
+  if (!baselineFile.empty() && !checkBaseline(baselineFile, slowdown))
+    return 1;
+  return 0;
+}
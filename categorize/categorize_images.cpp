@@ -1,6 +1,9 @@
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include "../VEC3F.h"
+#include "../PPM_FILE.h"
+#include "../SHAPE_COMPARE.h"
 #include <random>
 
 #include <iostream>
@@ -19,80 +22,6 @@ bool createCategory(int frameNum, int numShapeCategories, ofstream& shapeMatches
 // forward declare the categorize all images function here so that we can put it at the bottom of the file
 bool categorizeAll(int totalFrames, ofstream& imageCategories, float cutoffScore);
 
-//////////////////////////////////////////////////////////////////////////////////
-// Read in a raw PPM file of the "P6" style.
-//
-// Input: "filename" is the name of the file you want to read in
-// Output: "pixels" will point to an array of pixel values
-//         "width" will be the width of the image
-//         "height" will be the height of the image
-//
-// The PPM file format is:
-//
-//   P6
-//   <image width> <image height>
-//   255
-//   <raw, 8-bit binary stream of RGB values>
-//
-// Open one in a text editor to see for yourself.
-//
-//////////////////////////////////////////////////////////////////////////////////
-bool readPPM(const char* filename, unsigned char*& pixels, int& width, int& height)
-{
-  // try to open the file
-  FILE* file;
-  file = fopen(filename, "rb");
-  if (file == NULL)
-  {
-    cout << " Couldn't open file " << filename << "! " << endl;
-    return false; 
-  }
-
-  // get the dimensions
-  unsigned char newline;
-  fscanf(file, "P6\n%d %d\n255%c", &width, &height, &newline);
-  if (newline != '\n') {
-    cout << " The header of " << filename << " may be improperly formatted." << endl;
-    cout << " The program will continue, but you may want to check your input. " << endl;
-  }
-  int totalPixels = width * height;
-
-  // allocate three times as many pixels since there are R,G, and B channels
-  pixels = new unsigned char[3 * totalPixels];
-  fread(pixels, 1, 3 * totalPixels, file);
-  fclose(file);
-  
-  // output some success information
-  cout << " Successfully read in " << filename << " with dimensions: " 
-       << width << " " << height << endl;
-  return true;
-}
-
-//////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////
-void writePPM(const string &filename, int &xRes, int &yRes, unsigned char *values)
-{
-  int totalCells = xRes * yRes;
-  unsigned char *pixels = new unsigned char[3 * totalCells];
-  for (int i = 0; i < 3 * totalCells; i++)
-    pixels[i] = values[i];
-
-  FILE *fp;
-  fp = fopen(filename.c_str(), "wb");
-  if (fp == NULL)
-  {
-    cout << " Could not open file \"" << filename.c_str() << "\" for writing." << endl;
-    cout << " Make sure you're not trying to write from a weird location or with a " << endl;
-    cout << " strange filename. Bailing ... " << endl;
-    exit(0);
-  }
-
-  fprintf(fp, "P6\n%d %d\n255\n", xRes, yRes);
-  fwrite(pixels, 1, totalCells * 3, fp);
-  fclose(fp);
-  delete[] pixels;
-}
-
 ///////////////////////////////////////////////////////////////////////////////////////////
 // Program usage: ./categorize (-all, -specific, or -group) [specific flag parameters]
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -306,146 +235,18 @@ bool sameShape(int refFrameNum, int uncategorizedFrameNum, int categoryNum, floa
     }
 
 
-    int refWhitePixels = 0; // total number of white pixels in the reference image
-    int imgWhitePixels = 0; // total number of white pixels in the uncategorized image
-    int refBlackPixels = 0; // total number of black pixels in the reference image
-    int imgBlackPixels = 0; // total number of black pixels in the uncategorized image
-
-    int pixelWhiteMatches = 0; // hold number of white pixel matches between the reference image and the image to categorize
-    int reflectedPixelWhiteMatches = 0; // hold number of white pixel matches between the reference image and the image to categorize reflected across the y axis
-    int possibleWhiteMatches = 0; // hold number of possible white pixel matches, either refWhitePixels or imgWhitePixels depending on which is larger; for categorization based on number of white pixel matches
-
-    int pixelBlackMatches = 0; // hold number of black pixel matches between the reference image and the image to categorize
-    int reflectedPixelBlackMatches = 0; // hold number of black pixel matches between the reference image and the image to categorize reflected across the y axis
-    int possibleBlackMatches = 0; // hold number of possible black pixel matches, either refBlackPixels or imgBlackPixels depending on which is larger; for categorization based on number of black pixel matches
-    
     if (refReadSuccess && imgReadSuccess) // successfully read reference image and uncategorized image
     {
-        // iterate through every pixel in the image and see if the pixels in the reference image and the uncategorized image match up
-        for (int x = 0; x < width; x++)
-        {
-            for (int y = 0; y < height; y++)
-            {
-                int pixelIndex = x + (height - y) * width; // calculate pixel index for pixel values array that represents the final output image
-
-                int reflectedPixelIndex = (width - x) + (height - y) * width; // calculate pixel index for pixel value that represents the image reflected across the y axis
-
-                // bool borderBlackPixel = false; // only care about shape bordering black pixels when calculating ratio of black pixel matches; initialize to false
-
-                if (float(reference_pixels[3 * pixelIndex]) == 255.0)
-                {
-                    // white pixel in reference image
-                    refWhitePixels += 1;
-                }
-
-                if (float(img_pixels[3 * pixelIndex]) == 255.0)
-                {
-                    // white pixel in uncategorized image
-                    imgWhitePixels += 1;
-                }
-
-                if (float(reference_pixels[3 * pixelIndex]) == 0.0)
-                {
-                    // black pixel in reference image
-                    refBlackPixels += 1;
-
-                    // iterate through neighboring pixels and see if a neighboring pixel (at least 1 of the 8 surrounding the pixel in consideration) is white, only care about these shape border black pixels
-                    // for (int x_neighbor = (x - 1); x_neighbor < (x + 2); x_neighbor++)
-                    // {
-                    //     for (int y_neighbor = (y - 1); y_neighbor < (y + 2); y_neighbor++)
-                    //     {
-                    //         int neighborPixelIndex = x_neighbor + (height - y_neighbor) * width; // calculate pixel index for the neighboring pixel in the pixel values array that represents the final output image
-                    //         if (float(reference_pixels[3 * neighborPixelIndex]) == 255.0)
-                    //         {
-                    //             // neighboring pixel is white
-
-                    //             // black pixel in reference image
-                    //             refBlackPixels += 1;
-                    //             borderBlackPixel = true; // this black pixel borders the shape
-
-                    //             continue; // found a white neighboring pixel so don't need to look for more
-                    //         }
-                    //     }
-                    // }
-                }
-
-                if (float(img_pixels[3 * pixelIndex]) == 0.0)
-                {
-                    // black pixel in uncategorized image
-                    imgBlackPixels += 1;
-                }
-
-                if ((float(reference_pixels[3 * pixelIndex]) == float(img_pixels[3 * pixelIndex])) && (float(reference_pixels[3 * pixelIndex + 1]) == float(img_pixels[3 * pixelIndex + 1])) && (float(reference_pixels[3 * pixelIndex + 2]) == float(img_pixels[3 * pixelIndex + 2])))
-                {
-                    // the red, green, and blue values of the pixel are the same, so the two images have the same value at that pixel
-                    if ((reference_pixels[3 * pixelIndex] == 255.0) && (reference_pixels[3 * pixelIndex + 1] == 255.0) && (reference_pixels[3 * pixelIndex + 2] == 255.0))
-                    {
-                        pixelWhiteMatches += 1; // white pixel, for categorization based on number of white pixel matches
-                    }
-
-                    if ((reference_pixels[3 * pixelIndex] == 0.0) && (reference_pixels[3 * pixelIndex + 1] == 0.0) && (reference_pixels[3 * pixelIndex + 2] == 0.0))
-                    {
-                        pixelBlackMatches += 1; // black pixel, for categorization based on number of black pixel matches
-                    }
-
-                    // if (borderBlackPixel)
-                    // { 
-                    //     // the red, green, and blue values of the pixel are the same, so the two images have the same value at that pixel
-                    //     if ((reference_pixels[3 * pixelIndex] == 0.0) && (reference_pixels[3 * pixelIndex + 1] == 0.0) && (reference_pixels[3 * pixelIndex + 2] == 0.0))
-                    //     {
-                    //         pixelBlackMatches += 1; // black pixel, for categorization based on number of black pixel matches
-                    //     }
-                    // }
-                }
-
-                if ((float(reference_pixels[3 * pixelIndex]) == float(img_pixels[3 * reflectedPixelIndex])) && (float(reference_pixels[3 * pixelIndex + 1]) == float(img_pixels[3 * reflectedPixelIndex + 1])) && (float(reference_pixels[3 * pixelIndex + 2]) == float(img_pixels[3 * reflectedPixelIndex + 2])))
-                {
-                    // the red, green, and blue values of the reference image pixel and the reflected uncategorized image pixel are the same, same value at those corresponding pixels
-                    if ((reference_pixels[3 * pixelIndex] == 255.0) && (reference_pixels[3 * pixelIndex + 1] == 255.0) && (reference_pixels[3 * pixelIndex + 2] == 255.0))
-                    {
-                        reflectedPixelWhiteMatches += 1; // white pixel, for categorization based on number of white pixel matches
-                    }
-
-                    // the red, green, and blue values of the reference image pixel and the reflected uncategorized image pixel are the same, same value at those corresponding pixels
-                    if ((reference_pixels[3 * pixelIndex] == 0.0) && (reference_pixels[3 * pixelIndex + 1] == 0.0) && (reference_pixels[3 * pixelIndex + 2] == 0.0))
-                    {
-                        reflectedPixelBlackMatches += 1; // black pixel, for categorization based on number of black pixel matches
-                    }
-
-                    // if (borderBlackPixel)
-                    // {
-                    //     // the red, green, and blue values of the reference image pixel and the reflected uncategorized image pixel are the same, same value at those corresponding pixels
-                    //     if ((reference_pixels[3 * pixelIndex] == 0.0) && (reference_pixels[3 * pixelIndex + 1] == 0.0) && (reference_pixels[3 * pixelIndex + 2] == 0.0))
-                    //     {
-                    //         reflectedPixelBlackMatches += 1; // black pixel, for categorization based on number of black pixel matches
-                    //     }
-                    // }
-                }
-            }
-        }
-        
-        // determine categorization based on 0.5 * (number of white pixel matches / total possible white pixel matches) + 0.5 * (number of black pixel matches / total possible black pixel matches)
-        possibleWhiteMatches = refWhitePixels;
-        if (imgWhitePixels > refWhitePixels)
-        {
-            possibleWhiteMatches = imgWhitePixels; // get the largest number of white pixels, either the amount from the reference image or the uncategorized image
-        }
-
-        possibleBlackMatches = refBlackPixels; // using number of bordering black pixels in reference image
-        if (imgBlackPixels > refBlackPixels)
-        {
-            possibleBlackMatches = imgBlackPixels; // get the largest number of black pixels, either the amount from the reference image or the uncategorized image
-        }
-
-        float whiteRatio = float(pixelWhiteMatches) / float(possibleWhiteMatches); // get the ratio of how many pixels matched up between the two images compared to the total number of pixels; only white pixel matches
-        float blackRatio = float(pixelBlackMatches) / float(possibleBlackMatches); // get the ratio of how many pixels matched up between the two images compared to the total number of pixels; only black pixel matches
-        float ratio = (0.5 * whiteRatio) + (0.5 * blackRatio); // calculate overall ratio of matches by evenly weighting the ratio of white pixel matches and the ratio of black pixel matches
-        // float ratio = whiteRatio; // white pixel matches only
+        // see if the pixels in the reference image and the uncategorized image match up
+        SHAPE_SCORE score;
+        scoreShapes(reference_pixels, img_pixels, width, height, score);
 
-        float whiteReflectedRatio = float(reflectedPixelWhiteMatches) / float(possibleWhiteMatches); // get the ratio of how many pixels matched up between the reference image and the reflected uncategorized image compared to the total number of pixels; only white pixel matches
-        float blackReflectedRatio = float(reflectedPixelBlackMatches) / float(possibleBlackMatches); // get the ratio of how many pixels matched up between the reference image and the reflected uncategorized image compared to the total number of pixels; only black pixel matches
-        float reflectedRatio = (0.5 * whiteReflectedRatio) + (0.5 * blackReflectedRatio); // calculate overall ratio of matches by evenly weighting the ratio of reflected white pixel matches and the ratio of reflected black pixel matches
-        // float reflectedRatio = whiteReflectedRatio; // white pixel matches only
+        float ratio = score.ratio;
+        float whiteRatio = score.whiteRatio;
+        float blackRatio = score.blackRatio;
+        float reflectedRatio = score.reflectedRatio;
+        float whiteReflectedRatio = score.whiteReflectedRatio;
+        float blackReflectedRatio = score.blackReflectedRatio;
 
         if (ratio > cutoffScore || reflectedRatio > cutoffScore) // will need to adjust ratio
         {
@@ -538,7 +339,7 @@ bool consideredShape(int frameNum)
     {
         for (int l = 0; l < height; l++)
         {
-            int pixelIndex = k + (height - l) * width; // calculate pixel index in image
+            int pixelIndex = k + (height - 1 - l) * width; // calculate pixel index in image
             if ((float(reference_pixels[3 * pixelIndex]) == 255.0) && (float(reference_pixels[3 * pixelIndex + 1]) == 255.0) && (float(reference_pixels[3 * pixelIndex + 2]) == 255.0)) 
             {
                 // white pixel in image
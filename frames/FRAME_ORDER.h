@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////
+// Plans the playback order of the frames of an N-dimensional sweep.
+//
+// The sweep is described by the number of steps along each axis,
+// where axis 0 varies fastest in the frame numbering, i.e.
+//
+//   frame = a0 + dims[0] * (a1 + dims[1] * (a2 + ...))
+//
+// and by an axis permutation listing the axes from the outermost loop
+// to the innermost one. The plan is a list of "runs", one per sweep
+// along the innermost axis, so that callers can skip the rest of a run
+// when one of its frames is missing.
+//
+// The old hard-coded 11x11x11x11 vertical scan is
+//
+//   FRAME_ORDER order(dims = {11, 11, 11, 11}, axes = {2, 3, 0, 1});
+///////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_ORDER_H
+#define FRAME_ORDER_H
+
+#include <vector>
+
+class FRAME_ORDER {
+
+public:
+  FRAME_ORDER(const std::vector<int>& dims, const std::vector<int>& axes) :
+    _dims(dims), _axes(axes)
+  {
+    _valid = checkAxes();
+    if (_valid)
+      buildRuns();
+  };
+
+  // was a legal grid and axis permutation passed in?
+  bool valid() const { return _valid; };
+
+  // frame numbers along the innermost axis, in playback order
+  const std::vector<std::vector<int> >& runs() const { return _runs; };
+
+  // total number of frames in the plan
+  int totalFrames() const {
+    int total = 0;
+    for (unsigned int x = 0; x < _runs.size(); x++)
+      total += _runs[x].size();
+    return total;
+  };
+
+private:
+  ////////////////////////////////////////////////////////////////////////
+  // make sure every axis shows up exactly once and has a size
+  ////////////////////////////////////////////////////////////////////////
+  bool checkAxes() const
+  {
+    if (_dims.size() == 0 || _dims.size() != _axes.size())
+      return false;
+
+    std::vector<bool> seen(_dims.size(), false);
+    for (unsigned int x = 0; x < _axes.size(); x++)
+    {
+      int axis = _axes[x];
+      if (axis < 0 || axis >= (int)_dims.size() || seen[axis])
+        return false;
+      seen[axis] = true;
+
+      if (_dims[axis] <= 0)
+        return false;
+    }
+    return true;
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  // walk the grid like a set of nested loops, outermost axis first
+  ////////////////////////////////////////////////////////////////////////
+  void buildRuns()
+  {
+    const int totalAxes = _dims.size();
+
+    // stride of each axis in the frame numbering
+    std::vector<int> strides(totalAxes);
+    int stride = 1;
+    for (int x = 0; x < totalAxes; x++)
+    {
+      strides[x] = stride;
+      stride *= _dims[x];
+    }
+
+    const int inner = _axes[totalAxes - 1];
+
+    // loop counters for every axis except the innermost one
+    std::vector<int> counters(totalAxes, 0);
+    while (true)
+    {
+      int base = 0;
+      for (int x = 0; x < totalAxes; x++)
+        base += counters[x] * strides[x];
+
+      std::vector<int> run(_dims[inner]);
+      for (int x = 0; x < _dims[inner]; x++)
+        run[x] = base + x * strides[inner];
+      _runs.push_back(run);
+
+      // advance the odometer, innermost of the outer loops first
+      int digit = totalAxes - 2;
+      for (; digit >= 0; digit--)
+      {
+        int axis = _axes[digit];
+        counters[axis]++;
+        if (counters[axis] < _dims[axis])
+          break;
+        counters[axis] = 0;
+      }
+      if (digit < 0)
+        break;
+    }
+  };
+
+  std::vector<int> _dims;
+  std::vector<int> _axes;
+  std::vector<std::vector<int> > _runs;
+  bool _valid;
+};
+
+#endif
@@ -0,0 +1,131 @@
+///////////////////////////////////////////////////////////////////////
+// Reads the frames of a FRAME_ORDER plan on a background thread so
+// that the movie encoder never waits on the disk.
+//
+// At most "window" frames are held in memory at once. Call "next"
+// repeatedly to get the frames in playback order; it returns false
+// once the plan is exhausted. If a frame is missing, the rest of its
+// run is skipped, which is what the old vertical scan did.
+///////////////////////////////////////////////////////////////////////
+
+#ifndef FRAME_PREFETCHER_H
+#define FRAME_PREFETCHER_H
+
+#include <cstdio>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "FRAME_ORDER.h"
+
+// same signature as readPPM
+typedef bool (*FRAME_READER)(const char* filename, unsigned char*& pixels, int& width, int& height);
+
+class FRAME_PREFETCHER {
+
+public:
+  FRAME_PREFETCHER(const FRAME_ORDER& order, FRAME_READER reader, int window = 8) :
+    _order(order), _reader(reader), _window(window < 1 ? 1 : window),
+    _finished(false), _cancelled(false)
+  {
+    _thread = std::thread(&FRAME_PREFETCHER::readAll, this);
+  };
+
+  ~FRAME_PREFETCHER() {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _cancelled = true;
+    }
+    _spaceAvailable.notify_all();
+    _thread.join();
+
+    for (unsigned int x = 0; x < _frames.size(); x++)
+      delete[] _frames[x].pixels;
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  // get the next frame in the plan; the caller owns "pixels" afterwards
+  ////////////////////////////////////////////////////////////////////////
+  bool next(unsigned char*& pixels, int& width, int& height)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _frameAvailable.wait(lock, [this] { return !_frames.empty() || _finished; });
+    if (_frames.empty())
+      return false;
+
+    FRAME frame = _frames.front();
+    _frames.pop_front();
+    lock.unlock();
+    _spaceAvailable.notify_one();
+
+    pixels = frame.pixels;
+    width = frame.width;
+    height = frame.height;
+    return true;
+  };
+
+private:
+  struct FRAME {
+    unsigned char* pixels;
+    int width;
+    int height;
+  };
+
+  ////////////////////////////////////////////////////////////////////////
+  // the background thread: walk the plan and fill up the window
+  ////////////////////////////////////////////////////////////////////////
+  void readAll()
+  {
+    const std::vector<std::vector<int> >& runs = _order.runs();
+    for (unsigned int x = 0; x < runs.size(); x++)
+      for (unsigned int y = 0; y < runs[x].size(); y++)
+      {
+        // wait for the encoder to make some room
+        {
+          std::unique_lock<std::mutex> lock(_mutex);
+          _spaceAvailable.wait(lock, [this] { return (int)_frames.size() < _window || _cancelled; });
+          if (_cancelled)
+            return;
+        }
+
+        char buffer[256];
+        sprintf(buffer, "frame.%06i.ppm", runs[x][y]);
+
+        FRAME frame;
+        frame.pixels = NULL;
+        if (!_reader(buffer, frame.pixels, frame.width, frame.height))
+        {
+          // missing frame, move on to the next run
+          if (frame.pixels) delete[] frame.pixels;
+          break;
+        }
+
+        {
+          std::lock_guard<std::mutex> lock(_mutex);
+          _frames.push_back(frame);
+        }
+        _frameAvailable.notify_one();
+      }
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _finished = true;
+    }
+    _frameAvailable.notify_all();
+  };
+
+  const FRAME_ORDER& _order;
+  FRAME_READER _reader;
+  int _window;
+
+  std::deque<FRAME> _frames;
+  bool _finished;
+  bool _cancelled;
+
+  std::mutex _mutex;
+  std::condition_variable _frameAvailable;
+  std::condition_variable _spaceAvailable;
+  std::thread _thread;
+};
+
+#endif
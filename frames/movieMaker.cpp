@@ -2,7 +2,11 @@
 #include <cstdlib>
 #include <cmath>
 #include <iostream>
+#include <cstring>
+#include <vector>
 #include "../QUICKTIME_MOVIE.h"
+#include "FRAME_ORDER.h"
+#include "FRAME_PREFETCHER.h"
 
 using namespace std;
 
@@ -55,22 +59,69 @@ bool readPPM(const char* filename, unsigned char*& pixels, int& width, int& heig
   return true;
 }
 
+//////////////////////////////////////////////////////////////////////////////////
+// Add every frame of a sweep to the movie in the order given by "order",
+// reading ahead by up to "window" frames
+//////////////////////////////////////////////////////////////////////////////////
+void addSweep(QUICKTIME_MOVIE& movie, const FRAME_ORDER& order, int window)
+{
+  FRAME_PREFETCHER prefetcher(order, &readPPM, window);
+
+  int width, height;
+  unsigned char* pixels = NULL;
+  while (prefetcher.next(pixels, width, height))
+  {
+    movie.addFrame(pixels, width, height);
+    delete[] pixels;
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////
 int main(int argc, char** argv)
 {
   QUICKTIME_MOVIE movie;
 
-  int orientation = 0; // 0 for horizontal scan, 1 for vertical scan; default horizontal scan
+  int orientation = 0; // 0 for horizontal scan, 1 for vertical scan, 2 for a user-specified grid; default horizontal scan
+  int prefetchWindow = 8; // number of frames to read ahead of the encoder
+  vector<int> dims; // number of steps along each sweep axis, axis 0 varies fastest in the frame numbers
+  vector<int> axes; // sweep axes, from the outermost loop to the innermost one
+
   // format: ./movieMaker [orientation: either -h or -v]
-  if (argc == 2)
+  //         ./movieMaker -grid (# of axes n) (size of axis 0) ... (size of axis n-1) (outermost axis) ... (innermost axis) [prefetch window]
+  if (argc >= 2)
   {
     if (strcmp(argv[1], "-v") == 0)
     {
       orientation = 1;
+
+      // root0 sweeping vertical, root1 sweeping vertical
+      int legacyDims[] = {11, 11, 11, 11};
+      int legacyAxes[] = {2, 3, 0, 1};
+      dims.assign(legacyDims, legacyDims + 4);
+      axes.assign(legacyAxes, legacyAxes + 4);
+
+      // root0 sweeping horizontal, root1 sweeping vertical: output 09-23-2021_10x10_hv.mov
+      // is the same as: ./movieMaker -grid 4 11 11 11 11 3 2 0 1
     }
-  }
+    else if (strcmp(argv[1], "-grid") == 0 && argc > 2)
+    {
+      orientation = 2;
+      int totalAxes = atoi(argv[2]);
+      if (totalAxes <= 0 || (argc != 3 + 2 * totalAxes && argc != 4 + 2 * totalAxes))
+      {
+        cout << "Program usage: ./movieMaker -grid (# of axes n) (size of axis 0) ... (size of axis n-1) (outermost axis) ... (innermost axis) [prefetch window]" << endl;
+        return 1;
+      }
 
+      for (int i = 0; i < totalAxes; i++)
+        dims.push_back(atoi(argv[3 + i]));
+      for (int i = 0; i < totalAxes; i++)
+        axes.push_back(atoi(argv[3 + totalAxes + i]));
+      if (argc == 4 + 2 * totalAxes)
+        prefetchWindow = atoi(argv[3 + 2 * totalAxes]);
+    }
+  }
 
   bool readSuccess = true;
   int frameNumber = 0;
@@ -96,72 +147,18 @@ int main(int argc, char** argv)
       frameNumber++;
     }
   }
-  else // vertical scan
+  else // vertical scan or user-specified grid
   {
-    // root0 sweeping vertical, root1 sweeping vertical
-    int column = 0;
-    for (int y = 0; y < 11; y++)
+    FRAME_ORDER order(dims, axes);
+    if (!order.valid())
     {
-      for (int z = 0; z < 11; z++)
-      {
-        for (int i = 0; i < 11; i++)
-        {
-          frameNumber = i + 1331 * z + 121 * y;
-          for (int j = 0; j < 11; j++)
-          {
-            // build the next frame's filename
-            char buffer[256];
-            sprintf(buffer, "frame.%06i.ppm", frameNumber);
-          
-            // try reading the next sequential frame
-            int width, height;
-            unsigned char* pixels = NULL;
-            readSuccess = readPPM(buffer, pixels, width, height); 
-
-            // if it exists, add it
-            if (readSuccess)
-              // cout << "here" << endl;
-              movie.addFrame(pixels, width, height);
-            else break;
-
-            if (pixels) delete[] pixels;
-            frameNumber += 11;
-          }
-        }
-      }
+      cout << "Invalid sweep grid: every axis needs a positive size and must appear exactly once in the axis order" << endl;
+      return 1;
     }
-    
-    // // root0 sweeping horizontal, root1 sweeping vertical: output 09-23-2021_10x10_hv.mov
-    // int column = 0;
-    // for (int z = 0; z < 121; z++)
-    // {
-    //   for (int i = 0; i < 11; i++)
-    //   {
-    //     frameNumber = i + 121 * z;
-    //     for (int j = 0; j < 11; j++)
-    //     {
-    //       // build the next frame's filename
-    //       char buffer[256];
-    //       sprintf(buffer, "frame.%06i.ppm", frameNumber);
-        
-    //       // try reading the next sequential frame
-    //       int width, height;
-    //       unsigned char* pixels = NULL;
-    //       readSuccess = readPPM(buffer, pixels, width, height); 
-
-    //       // if it exists, add it
-    //       if (readSuccess)
-    //         // cout << "here" << endl;
-    //         movie.addFrame(pixels, width, height);
-    //       else break;
-
-    //       if (pixels) delete[] pixels;
-    //       frameNumber += 11;
-    //     }
-    //   }
-    // }  
+    cout << " Planned " << order.runs().size() << " runs of up to " << order.totalFrames() << " frames" << endl;
+
+    addSweep(movie, order, prefetchWindow);
   }
-  
 
   // write out the compiled movie
   movie.writeMovie("movie.mov");
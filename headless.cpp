@@ -0,0 +1,16 @@
+///////////////////////////////////////////////////////////////////////
+// Command line front end for the batch sweeps that doesn't need GL, so
+// it can run on machines with no display. Takes the same arguments as
+// the batch modes of the viewer:
+//
+//   ./mandelbrot_headless -random (-any or -pinned) (# of roots) (# of images) (-color or -noColor) (-center or -notCentered)
+//   ./mandelbrot_headless -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+//   ./mandelbrot_headless -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
+///////////////////////////////////////////////////////////////////////
+
+#include "SWEEP.h"
+
+int main(int argc, char** argv)
+{
+  return runSweep(argc, argv);
+}
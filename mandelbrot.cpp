@@ -2,7 +2,12 @@
 #include <cstdio>
 #include "FIELD_2D.h"
 #include "VEC3F.h"
-#include <random>
+#include "VIEW_RENDERER.h"
+#include "TILE_CACHE.h"
+#include "JULIA_RENDERER.h"
+#include "SWEEP.h"
+#include "PERTURBATION_RENDERER.h"
+#include <cstring>
 
 #ifndef GL_SILENCE_DEPRECATION
 #define GL_SILENCE_DEPRECATION
@@ -12,15 +17,15 @@
 #include <gl/glut.h>
 #elif __APPLE__
 #include <GLUT/glut.h>
+#else
+#include <GL/glut.h>
 #endif
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include "QUICKTIME_MOVIE.h"
 
-#include <chrono>
-using namespace std::chrono;
-
 using namespace std;
 
 const int totalTop = 15; // total top roots
@@ -36,6 +41,12 @@ int currentBottom = 0; // actual number of bottom roots
 int xRes = 800;
 int yRes = 800;
 
+// what juliaValue iterates with; -maxIterations, -escapeRadius and
+// -mixedPrecision after the roots change them
+int viewMaxIterations = 100;
+float viewEscapeRadius = 200.0; // to match the js version
+bool viewMixedPrecision = false;
+
 // the field being drawn and manipulated
 FIELD_2D field(xRes, yRes);
 
@@ -69,15 +80,54 @@ bool drawingValues = false;
 // currently capturing frames for a movie?
 bool captureMovie = false;
 
-// the current viewer eye position
-VEC3F eyeCenter(0.5, 0.5, 1);
+// the current viewer eye position, in double so that deep zooms can
+// still pan
+double eyeCenter[2] = {0.5, 0.5};
 
 // current zoom level into the field
-float zoom = 1.0;
+double zoom = 1.0;
 
 // Quicktime movie to capture to
 QUICKTIME_MOVIE movie;
 
+// re-renders the field on background threads whenever the view moves
+VIEW_RENDERER* viewRenderer = NULL;
+
+// tiles that have already been rendered, so panning back and forth
+// doesn't recompute them
+TILE_CACHE tileCache(256 * 1024 * 1024);
+
+// deepest quadtree level the viewer will go to; past it, views are
+// iterated as offsets from a reference orbit of the eye instead. A
+// 64 x 64 tile there has pixels 2^-23 apart, one float ulp at 1 to 2,
+// so the float iterations can still place and tell apart the pixels
+// anywhere in X[-2, 2] Y[-2, 2]; a level deeper they can't past 1.
+const int maxTileLevel = 19;
+
+// the smallest zoom. The eye and the view window are doubles in world
+// coordinates, where an ulp near 0.5 is about 1e-16, so at 1e-13 across
+// 800 pixels the pixels are about one ulp apart and the eye can't be
+// placed any finer. The reference orbit's long double doesn't help past
+// that, and on ARM64 it is only a double anyway.
+const double minZoom = 1e-13;
+
+// the viewer picks tiles fine enough to put at least this many pixels
+// across the screen
+const int viewRes = 800;
+
+// the part of the plane that the texture currently covers
+VIEW_WINDOW textureWindow = {-2.0, -2.0, 4.0f / 800, 4.0f / 800};
+
+// the view that was last handed to viewRenderer
+double renderedEye[2] = {-1, -1};
+double renderedZoom = -1.0;
+
+// does the whole texture need to be uploaded again?
+bool textureDirty = true;
+
+// showing an image read in with 'r' instead of the fractal?
+bool showingImage = false;
+
 // forward declare the caching function here so that we can
 // put it at the bottom of the file
 void runOnce();
@@ -87,10 +137,63 @@ void runOnce();
 void runEverytime();
 
 vector<VEC3F> topRoots; // hold top roots
-vector<VEC3F> randomRoots; // hold roots generated with random numbers
 
-bool colorRed = false; // default coloring roots red to be false
-int centerShape = 0; // default don't center shape
+///////////////////////////////////////////////////////////////////////
+// Where the texture sits in world coordinates, and how big it is. The
+// standard X[-2, 2] Y[-2, 2] viewing window is [0, 1] x [0, 1] in
+// world coordinates.
+///////////////////////////////////////////////////////////////////////
+void textureBounds(double& xMin, double& yMin, double& xSize, double& ySize)
+{
+  xMin = (textureWindow.xMin + 2.0) / 4.0;
+  yMin = (textureWindow.yMin + 2.0) / 4.0;
+  xSize = textureWindow.dx * field.xRes() / 4.0;
+  ySize = textureWindow.dy * field.yRes() / 4.0;
+}
+
+///////////////////////////////////////////////////////////////////////
+// Hand the part of the plane currently in view to viewRenderer
+///////////////////////////////////////////////////////////////////////
+void requestView()
+{
+  double halfZoom = 0.5 * zoom;
+
+  // pick the quadtree level whose tiles are at least as fine as the
+  // screen needs
+  int level = (int)ceil(log2(viewRes / (viewRenderer->tileRes() * (double)zoom)));
+  level = (level < 0) ? 0 : level;
+  if (level > maxTileLevel)
+  {
+    // float can't place the pixels this deep, so iterate them as double
+    // offsets from a long double orbit of the eye
+    const long double xCenter = -2.0L + 4.0L * eyeCenter[0];
+    const long double yCenter = -2.0L + 4.0L * eyeCenter[1];
+    shared_ptr<const PERTURBATION_RENDERER> reference(
+      new PERTURBATION_RENDERER(topRoots, xCenter, yCenter, viewMaxIterations, viewEscapeRadius));
+    OFFSET_FUNCTION offsetValue = [reference](double xOffset, double yOffset) {
+      return (reference->iterate(xOffset, yOffset) == reference->maxIterations()) ? 1.0f : 0.0f;
+    };
+
+    int tiles = (viewRes + viewRenderer->tileRes() - 1) / viewRenderer->tileRes();
+    viewRenderer->renderOffsets(offsetValue, (double)xCenter, (double)yCenter, 4.0 * zoom / viewRes, tiles, tiles);
+  }
+  else
+  {
+    // the tiles that overlap the screen, in world coordinates
+    double tiles = ldexp(1.0, level);
+    int xFirst = (int)floor((eyeCenter[0] - halfZoom) * tiles);
+    int xLast  = (int)floor((eyeCenter[0] + halfZoom) * tiles);
+    int yFirst = (int)floor((eyeCenter[1] - halfZoom) * tiles);
+    int yLast  = (int)floor((eyeCenter[1] + halfZoom) * tiles);
+
+    unsigned long long rootSet = TILE_CACHE::hashRoots(topRoots, currentTop);
+    viewRenderer->render(rootSet, level, xFirst, yFirst, xLast - xFirst + 1, yLast - yFirst + 1);
+  }
+
+  renderedEye[0] = eyeCenter[0];
+  renderedEye[1] = eyeCenter[1];
+  renderedZoom = zoom;
+}
 
 ///////////////////////////////////////////////////////////////////////
 // Figure out which field element is being pointed at, set xField and
@@ -104,34 +207,25 @@ void refreshMouseFieldIndex(int x, int y)
   float xNorm = (float)x / xScreenRes;
   float yNorm = (float)y / yScreenRes;
 
-  float halfZoom = 0.5 * zoom;
-  float xWorldMin = eyeCenter[0] - halfZoom;
-  float xWorldMax = eyeCenter[0] + halfZoom;
+  double halfZoom = 0.5 * zoom;
+  double xWorldMin = eyeCenter[0] - halfZoom;
 
   // get the bounds of the field in screen coordinates
-  //
-  // if non-square textures are ever supported, change the 0.0 and 1.0 below
-  float xMin = (0.0 - xWorldMin) / (xWorldMax - xWorldMin);
-  float xMax = (1.0 - xWorldMin) / (xWorldMax - xWorldMin);
+  double xTexture, yTexture, xSize, ySize;
+  textureBounds(xTexture, yTexture, xSize, ySize);
 
-  float yWorldMin = eyeCenter[1] - halfZoom;
-  float yWorldMax = eyeCenter[1] + halfZoom;
+  double xMin = (xTexture - xWorldMin) / zoom;
+  double xMax = (xTexture + xSize - xWorldMin) / zoom;
 
-  float yMin = (0.0 - yWorldMin) / (yWorldMax - yWorldMin);
-  float yMax = (1.0 - yWorldMin) / (yWorldMax - yWorldMin);
+  double yWorldMin = eyeCenter[1] - halfZoom;
 
-  float xScale = 1.0;
-  float yScale = 1.0;
-
-  if (xRes < yRes)
-    xScale = (float)yRes / xRes;
-  if (xRes > yRes)
-    yScale = (float)xRes / yRes;
+  double yMin = (yTexture - yWorldMin) / zoom;
+  double yMax = (yTexture + ySize - yWorldMin) / zoom;
 
   // index into the field after normalizing according to screen
   // coordinates
-  xField = xScale * xRes * ((xNorm - xMin) / (xMax - xMin));
-  yField = yScale * yRes * ((yNorm - yMin) / (yMax - yMin));
+  xField = xRes * ((xNorm - xMin) / (xMax - xMin));
+  yField = yRes * ((yNorm - yMin) / (yMax - yMin));
 
   // clamp to something inside the field
   xField = (xField < 0) ? 0 : xField;
@@ -170,6 +264,25 @@ void updateTexture(FIELD_2D& texture)
   glEnable(GL_TEXTURE_2D);
 }
 
+///////////////////////////////////////////////////////////////////////
+// dump just one rectangle of the field into the existing GL texture
+///////////////////////////////////////////////////////////////////////
+void updateTextureTile(FIELD_2D& texture, const TILE_RECT& rect)
+{
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, texture.xRes());
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, rect.x);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, rect.y);
+  glTexSubImage2D(GL_TEXTURE_2D, 0,
+      rect.x, rect.y,
+      rect.width, rect.height,
+      GL_LUMINANCE, GL_FLOAT,
+      texture.data());
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+  glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+  glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+}
+
 ///////////////////////////////////////////////////////////////////////
 // draw a grid over everything
 ///////////////////////////////////////////////////////////////////////
@@ -177,24 +290,25 @@ void drawGrid()
 {
   glColor4f(0.1, 0.1, 0.1, 1.0);
 
-  float dx = 1.0 / xRes;
-  float dy = 1.0 / yRes;
+  // relative to the eye, like the texture
+  double xTextureWorld, yTextureWorld, xSize, ySize;
+  textureBounds(xTextureWorld, yTextureWorld, xSize, ySize);
+  float xTexture = xTextureWorld - eyeCenter[0];
+  float yTexture = yTextureWorld - eyeCenter[1];
 
-  if (xRes < yRes)
-    dx *= (float)xRes / yRes;
-  if (xRes > yRes)
-    dy *= (float)yRes / xRes;
+  float dx = xSize / xRes;
+  float dy = ySize / yRes;
 
   glBegin(GL_LINES);
   for (int x = 0; x < field.xRes() + 1; x++)
   {
-    glVertex3f(x * dx, 0, 1);
-    glVertex3f(x * dx, 1, 1);
+    glVertex3f(xTexture + x * dx, yTexture, 1);
+    glVertex3f(xTexture + x * dx, yTexture + ySize, 1);
   }
   for (int y = 0; y < field.yRes() + 1; y++)
   {
-    glVertex3f(0, y * dy, 1);
-    glVertex3f(1, y * dy, 1);
+    glVertex3f(xTexture, yTexture + y * dy, 1);
+    glVertex3f(xTexture + xSize, yTexture + y * dy, 1);
   }
   glEnd();
 }
@@ -209,35 +323,36 @@ void glutDisplay()
 
   // set the projection matrix to an orthographic view
   glLoadIdentity();
-  float halfZoom = zoom * 0.5;
+  double halfZoom = zoom * 0.5;
 
   glOrtho(-halfZoom, halfZoom, -halfZoom, halfZoom, -10, 10);
 
   // set the matrix mode back to modelview
   glMatrixMode(GL_MODELVIEW);
 
-  // set the lookat transform
+  // set the lookat transform; everything is drawn relative to the eye,
+  // since GL's float can't place anything at deep zooms otherwise
   glLoadIdentity();
-  gluLookAt(eyeCenter[0], eyeCenter[1], 1,  // eye
-            eyeCenter[0], eyeCenter[1], 0,  // center 
+  gluLookAt(0, 0, 1,  // eye
+            0, 0, 0,  // center
             0, 1, 0);   // up
 
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  float xLength = 1.0;
-  float yLength = 1.0;
+  // the texture only covers the window it was last rendered for
+  double xTextureWorld, yTextureWorld, xSize, ySize;
+  textureBounds(xTextureWorld, yTextureWorld, xSize, ySize);
+  float xTexture = xTextureWorld - eyeCenter[0];
+  float yTexture = yTextureWorld - eyeCenter[1];
+  float xLength = xSize;
+  float yLength = ySize;
 
-  if (xRes < yRes)
-    xLength = (float)xRes / yRes;
-  if (yRes < xRes)
-    yLength = (float)yRes / xRes;
-
-  glEnable(GL_TEXTURE_2D); 
+  glEnable(GL_TEXTURE_2D);
   glBegin(GL_QUADS);
-    glTexCoord2f(0.0, 0.0); glVertex3f(0.0, 0.0, 0.0);
-    glTexCoord2f(0.0, 1.0); glVertex3f(0.0, yLength, 0.0);
-    glTexCoord2f(1.0, 1.0); glVertex3f(xLength, yLength, 0.0);
-    glTexCoord2f(1.0, 0.0); glVertex3f(xLength, 0.0, 0.0);
+    glTexCoord2f(0.0, 0.0); glVertex3f(xTexture, yTexture, 0.0);
+    glTexCoord2f(0.0, 1.0); glVertex3f(xTexture, yTexture + yLength, 0.0);
+    glTexCoord2f(1.0, 1.0); glVertex3f(xTexture + xLength, yTexture + yLength, 0.0);
+    glTexCoord2f(1.0, 0.0); glVertex3f(xTexture + xLength, yTexture, 0.0);
   glEnd();
   glDisable(GL_TEXTURE_2D); 
 
@@ -360,6 +475,14 @@ void glutKeyboard(unsigned char key, int x, int y)
       field.readPNG("bunny.png");
       xRes = field.xRes();
       yRes = field.yRes();
+
+      // show the image over the standard window until the view moves
+      textureWindow.xMin = -2.0;
+      textureWindow.yMin = -2.0;
+      textureWindow.dx = 4.0 / ((xRes > yRes) ? xRes : yRes);
+      textureWindow.dy = textureWindow.dx;
+      textureDirty = true;
+      showingImage = true;
       break;
     case 'w':
       field.writePNG("output.png");
@@ -389,6 +512,7 @@ void glutMouseClick(int button, int state, int x, int y)
     
     // set the cell
     field(xField, yField) = 1;
+    textureDirty = true;
     
     // make sure nothing else is called
     return;
@@ -412,6 +536,7 @@ void glutMouseMotion(int x, int y)
     
     // set the cell
     field(xField, yField) = 1;
+    textureDirty = true;
     
     // make sure nothing else is called
     return;
@@ -423,11 +548,16 @@ void glutMouseMotion(int x, int y)
   
   if (mouseButton == GLUT_LEFT_BUTTON) 
   {
-    eyeCenter[0] -= xDiff * speed;
-    eyeCenter[1] += yDiff * speed;
+    // the same distance on screen at any zoom
+    eyeCenter[0] -= xDiff * speed * zoom;
+    eyeCenter[1] += yDiff * speed * zoom;
   }
   if (mouseButton == GLUT_RIGHT_BUTTON)
-    zoom -= yDiff * speed;
+  {
+    // by a factor, so that deep zooms don't take forever
+    zoom *= exp(-yDiff * speed);
+    zoom = (zoom < minZoom) ? minZoom : zoom;
+  }
 
   xMouse = x;
   yMouse = y;
@@ -450,7 +580,34 @@ void glutIdle()
   {
     runEverytime();
   }
-  updateTexture(field);
+
+  // start re-rendering if the view moved
+  if (viewRenderer && (zoom != renderedZoom || eyeCenter[0] != renderedEye[0] || eyeCenter[1] != renderedEye[1]))
+  {
+    requestView();
+    showingImage = false;
+  }
+
+  // pick up whatever the renderer finished, without waiting on it
+  vector<TILE_RECT> changed;
+  if (viewRenderer && !showingImage && viewRenderer->update(field, textureWindow, changed))
+  {
+    xRes = field.xRes();
+    yRes = field.yRes();
+    for (unsigned int x = 0; x < changed.size(); x++)
+    {
+      if (changed[x].width == field.xRes() && changed[x].height == field.yRes())
+        textureDirty = true;
+      else if (!textureDirty)
+        updateTextureTile(field, changed[x]);
+    }
+  }
+
+  if (textureDirty)
+  {
+    updateTexture(field);
+    textureDirty = false;
+  }
   glutPostRedisplay();
 }
 
@@ -487,663 +644,60 @@ int glvuWindow()
 }
 
 ///////////////////////////////////////////////////////////////////////
-// Do a complex multiply
+// Field value at a point for the viewer: white if the point did not
+// escape, black if it did
 ///////////////////////////////////////////////////////////////////////
-VEC3F complexMultiply(VEC3F left, VEC3F right)
-{
-  float a = left[0];
-  float b = left[1];
-  float c = right[0];
-  float d = right[1];
-  return VEC3F(a * c - b * d, a * d + b * c, 0.0);
-}
-
-///////////////////////////////////////////////////////////////////////////////////////////////
-// Generate random root locations: X[-2.0, 2.0], Y[-2.0, 2.0] and store in randomRoots
-///////////////////////////////////////////////////////////////////////////////////////////////
-void generateRoots(int numRoots)
+float juliaValue(const VEC3F& position)
 {
-  random_device rd;
-  mt19937 gen(rd()); // initialize generator
-  uniform_real_distribution<float> dist(-2.0, 2.0); // set range for random number
-
-  for (int i = 0; i < numRoots; i++)
-  {
-    VEC3F randomRoot = VEC3F(0.0, 0.0, 0.0);
-    for (int j = 0; j < 2; j++) // each root requires two random numbers, one for x and one for y
-    {
-      float randomNum = dist(gen);
-      randomRoot[j] = randomNum; // update root position to random generated
-    }
-    randomRoots.push_back(VEC3F(randomRoot[0], randomRoot[1], 0.0f));
-  }
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////
-void writePPM(const string &filename, int &xRes, int &yRes, const float *values)
-{
-  int totalCells = xRes * yRes;
-  unsigned char *pixels = new unsigned char[3 * totalCells];
-  for (int i = 0; i < 3 * totalCells; i++)
-    pixels[i] = values[i];
-
-  FILE *fp;
-  fp = fopen(filename.c_str(), "wb");
-  if (fp == NULL)
-  {
-    cout << " Could not open file \"" << filename.c_str() << "\" for writing." << endl;
-    cout << " Make sure you're not trying to write from a weird location or with a " << endl;
-    cout << " strange filename. Bailing ... " << endl;
-    exit(0);
-  }
-
-  fprintf(fp, "P6\n%d %d\n255\n", xRes, yRes);
-  fwrite(pixels, 1, totalCells * 3, fp);
-  fclose(fp);
-  delete[] pixels;
-}
-
-//////////////////////////////////////////////////////////////////////////////////
-// Returns true if there is a shape in the image; if numCentered = 0, don't translate shape to center
-//////////////////////////////////////////////////////////////////////////////////
-bool renderImage(int &xRes, int &yRes, const string &filename, int frame_num, VEC3F centerOfMass, int numCentered, ofstream& comFile)
-{
-  if(!comFile.is_open())
-  {
-    // erro opening center of mass info text file
-    cout << "Couldn't open file: " << comFile << endl;
-  }
-
-  // allocate the final image
-  const int totalCells = xRes * yRes;
-  float *ppmOut = new float[3 * totalCells];
-
-  float xLength = 4.0; // get standard X[-2, 2] Y[-2, 2] viewing window
-  float yLength = 4.0;
-
-  int maxIterations = 100;
-  float escapeRadius = 200.0; // to match the js version
-
-  float dx = xLength / xRes;
-  float dy = yLength / yRes;
-  float xHalf = xLength * 0.5;
-  float yHalf = yLength * 0.5;
-
-  VEC3F origin = centerOfMass; // origin is center of mass; first time compute, center of mass is at the standard origin of (0.0, 0.0)
-
-  // get the pixel values of the roots, changing from x[-2 x 2], y[-2 x 2] to [xRes x yRes]
-  float root1x_pixel = (topRoots[0][0] + xHalf - origin[0]) * (1.0 / dx);
-  float root1y_pixel = (topRoots[0][1] + yHalf - origin[1]) * (1.0 / dy);
-  float root2x_pixel = (topRoots[1][0] + xHalf - origin[0]) * (1.0 / dx);
-  float root2y_pixel = (topRoots[1][1] + yHalf - origin[1]) * (1.0 / dy);
-
-  bool shape = false; // hold whether there is a shape (whether there are white pixels)
-
-  // to calculate shape's center of mass
-  float xPosSum = 0.0; // sum of x values of white pixels
-  float yPosSum = 0.0; // sum of y values of white pixels
-  int numWhitePixels = 0; // number of white pixels
-
-  for (int y = 0; y < yRes; y++)
-  {
-    for (int x = 0; x < xRes; x++)
-    {
-      // getting the center coordinate here is a little sticky
-      VEC3F center;
-      center[0] = -xHalf + origin[0] + x * dx;
-      center[1] = -yHalf + origin[1] + y * dy;
-
-      VEC3F iterate = center; // iterate is q
-      VEC3F p; // hold calculated polynomial
-
-      float magnitude = iterate.magnitude();
-      int totalIterations = 0;
-      while (magnitude < escapeRadius && totalIterations < maxIterations)
-      {
-        VEC3F g = VEC3F(1.0, 0.0, 0.0); // holds current polynomial on top
-        VEC3F diff;
-
-        // compute the top: iterate through top roots
-        for (int x = 0; x < totalTop; x++)
-        {
-          if (x == currentTop) 
-          {
-            break;
-          }
-          // add (q-root) onto g, the polynomial on the top
-          diff = (iterate - topRoots[x]);
-          g = complexMultiply(g, diff);
-        }
-
-        // compute the polynomial
-        p = g;
-        iterate = p;
-
-        magnitude = iterate.magnitude();
-        totalIterations++;
-
-        // exit conditions
-        if (magnitude > escapeRadius)
-          break;
-        if (magnitude < 1e-7)
-          break;
-      }
-
-      int pixelIndex = x + (yRes - y) * xRes; // calculate pixel index for pixel values array that represents the final output image
-
-      // color accordingly
-      if (totalIterations == maxIterations)
-      {
-        field(x, y) = 1.0; // did not escape, color white
-        if (numCentered != 0)
-        {
-          // store info to calculate center of mass
-          numWhitePixels += 1; // increment total number of white pixels
-          xPosSum += center[0]; // increment sum of x positions of white pixels
-          yPosSum += center[1]; // increment sum of y positions of white pixels
-        }
-        
-        // set, in final image
-        ppmOut[3 * pixelIndex] = 255.0f;
-        ppmOut[3 * pixelIndex + 1] = 255.0f;
-        ppmOut[3 * pixelIndex + 2] = 255.0f;
-        shape = true; // there is a fractal shape
-      }
-      else
-      {
-        field(x, y) = 0.0; // escaped, color black
-        // set, in final image
-        ppmOut[3 * pixelIndex] = 0.0f;
-        ppmOut[3 * pixelIndex + 1] = 0.0f;
-        ppmOut[3 * pixelIndex + 2] = 0.0f;
-      }
-
-      if (colorRed)
-      {
-        // red square around roots to be able to see root positions
-        if (((x > (root1x_pixel - 10.0f)) && (x < (root1x_pixel + 10.0f)) && (y > (root1y_pixel - 10.0f)) && (y < (root1y_pixel + 10.0f))) || ((x > (root2x_pixel - 10.0f)) && (x < (root2x_pixel + 10.0f)) && (y > (root2y_pixel - 10.0f)) && (y < (root2y_pixel + 10.0f))))
-        {
-          // cout << "near root" << endl;
-          ppmOut[3 * pixelIndex] = 255.0f;
-          ppmOut[3 * pixelIndex + 1] = 0.0f;
-          ppmOut[3 * pixelIndex + 2] = 0.0f;
-        }
-      }
-    }
-  }
-
-  if (shape)
-  { 
-    comFile << filename << " COM for iteration " << numCentered << ": " << centerOfMass << endl;
-    // fractal shape exists
-    if (numCentered != 0 && numCentered < 11) // check if more than 10 recursive calls or if not even centering the shape to start with
-    {
-      VEC3F newCenterOfMass = VEC3F((xPosSum / float(numWhitePixels)), yPosSum / float(numWhitePixels), 0.0); // calculate new center of mass
-      
-      if ((abs(centerOfMass[0] - newCenterOfMass[0])) > 0.001 || abs(centerOfMass[1] - newCenterOfMass[1]) > 0.001) // check how much center of mass is changing by
-      {
-        // center of mass is still changing, so repeat rigid translation to center shape
-        delete[] ppmOut;
-        return renderImage(xRes, yRes, filename, frame_num, newCenterOfMass, numCentered + 1, comFile); // recompute julia with shape's center of mass as new origin
-      }
-      else
-      {
-        // center of mass is not changing, so shape is already centered
-        comFile << filename << " centered." << endl;
-        comFile << endl; // spacer in COM text file to indicate end of this image's centering
-        writePPM(filename, xRes, yRes, ppmOut); // output fractal shape
-        delete[] ppmOut;
-        return true;
-      }
-    }
-    else
-    {
-      if (numCentered == 11)
-      {
-        comFile << filename << " could not be centered." << endl;
-        comFile << endl; // spacer in COM text file to indicate end of this image's centering
-      }
-      writePPM(filename, xRes, yRes, ppmOut); // output fractal shape
-      delete[] ppmOut;
-      return true;
-    }   
-  }
-  else
-  { // no fractal shape
-    delete[] ppmOut;
-    return false;
-  }
+  if (!viewMixedPrecision)
+    return (iterateRoots(position, topRoots, viewMaxIterations, viewEscapeRadius) == viewMaxIterations) ? 1.0 : 0.0;
+
+  // float, unless rounding could have decided it
+  bool nearThreshold;
+  int totalIterations = iterateRootsFlagged(position, topRoots, viewMaxIterations, viewEscapeRadius, nearThreshold);
+  if (nearThreshold)
+    totalIterations = iterateRootsDouble(position, topRoots, viewMaxIterations, viewEscapeRadius);
+  return (totalIterations == viewMaxIterations) ? 1.0 : 0.0;
 }
 
 ///////////////////////////////////////////////////////////////////////
 ///////////////////////////////////////////////////////////////////////
 int main(int argc, char** argv)
 {
-  auto start = high_resolution_clock::now(); // record program start time
-
   // every root on screen is between x[-2.0, 2.0], y[-2.0, 2.0]
   // top right is (2.0, 2.0), bottom right is (2.0, -2.0), bottom left is (-2.0, 2.0), top left is (-2.0, 2.0)
 
-  // detect mode
-  int mode = 0; // 0 for full space exploration, 1 for single exploration, 2 for random roots exploration; 3 for one root pinned exploration; default full space exploration
-  if (argc > 1)
+  // the batch modes (-random, -pinned, and full space exploration by
+  // default) don't need a window, so hand them to the sweep library
+  if (argc < 2 || strcmp(argv[1], "-single") != 0)
+    return runSweep(argc, argv);
+
+  // single exploration
+  // format: ./mandelbrot -single (# of top roots n) (root0_x) (root0_y) ... (rootn-1_x) (rootn-1_y)
+  //                      [-maxIterations n] [-escapeRadius r] [-mixedPrecision]
+  int num_top_roots = atoi(argv[2]);
+  currentTop = num_top_roots; // number of roots
+  for (int i = 0; i < num_top_roots; i++)
   {
-    if (strcmp(argv[1], "-single") == 0)
-    {
-      mode = 1; // set to single exploration mode
-    }
-    else if (strcmp(argv[1], "-random") == 0)
-    {
-      mode = 2; // set to random roots exploration mode
-    }
-    else if (strcmp(argv[1], "-pinned") == 0) 
-    {
-      mode = 3; // set to one root pinned and other root changing exploration mode
-    }
+    topRoots.push_back(VEC3F(atof(argv[2 * i + 3]), atof(argv[2 * i + 4]), 0.0));
   }
-  
-  if (mode == 1) // single exploration
+  for (int x = 2 * num_top_roots + 3; x < argc; x++)
   {
-    // format: ./mandelbrot -single (# of top roots n) (root0_x) (root0_y) ... (rootn-1_x) (rootn-1_y)
-    int num_top_roots = atoi(argv[2]);
-    currentTop = num_top_roots; // number of roots
-    for (int i = 0; i < num_top_roots; i++)
-    {
-      topRoots.push_back(VEC3F(atof(argv[2 * i + 3]), atof(argv[2 * i + 4]), 0.0));
-    }
-    // compute fractal
-    runOnce();
-
-    // initialize GLUT and GL
-    glutInit(&argc, argv);
-
-    // open the GL window
-    glvuWindow();
+    if (x + 1 < argc && strcmp(argv[x], "-maxIterations") == 0)
+      viewMaxIterations = atoi(argv[++x]);
+    else if (x + 1 < argc && strcmp(argv[x], "-escapeRadius") == 0)
+      viewEscapeRadius = atof(argv[++x]);
+    else if (strcmp(argv[x], "-mixedPrecision") == 0)
+      viewMixedPrecision = true;
   }
-  else if (mode == 2) // random exploration
-  {
-    // create and open a text file to store root information alongside output image file names
-    ofstream rootInfo("random/root_info.txt");
+  // compute fractal
+  runOnce();
 
-    // create and open a text file to store COM information alongside output image file names
-    ofstream comInfo("shapes/COM_info.txt");
+  // initialize GLUT and GL
+  glutInit(&argc, argv);
 
-    int numRootsToExplore = 2; // default # roots if not specified by user
-    int numCombinations = 8; // default # of random combinations if not specified by user
-
-    int rootCombinations = 0; // hold number of root combinations tried
-
-    // format: ./mandelbrot -random (-any or -pinned) (# of roots) (# of with-shape images to generate) (-color or -noColor) (-center or -notCentered)
-    if (argc == 7)
-    {
-      numRootsToExplore = atoi(argv[3]); // set # of roots to be user-specified
-      numCombinations = atoi(argv[4]); // set # of random combinations to be user-specified
-
-      if (strcmp(argv[5], "-color") == 0)
-      {
-        colorRed = true; // color roots red
-      }
-      else
-      {
-        colorRed = false; // don't color roots red
-      }
-
-      if (strcmp(argv[6], "-center") == 0)
-      {
-        centerShape = 1; // center the shape
-      }
-      else
-      {
-        centerShape = 0; // don't center the shape
-      }
-
-      
-    }
-    else // error
-    {
-      cout << "Program usage: ./mandelbrot -random (-any or -pinned) (# of roots) (# of images to generate) (-color or -noColor) (-center or -notCentered)" << endl;
-      return 1;
-    }
-
-    cout << "numCombinations: " << numCombinations << endl; // numCombinations holds # of images to generate (each image requires a pair of roots)
-    bool pinned = false; // hold whether one root is pinned to the origin, as set by the -pinned flag
-
-    int numRoots = 0; // number of root locations to generate
-    if (strcmp(argv[2], "-pinned") == 0)
-    {
-      numRoots = numRootsToExplore - 1; // one root is pinned to the origin, the other root can move
-      pinned = true;
-    }
-    else
-    {
-      numRoots = numRootsToExplore; // numRoots holds # of random root locations to generate, all roots can have random locations
-    }
-
-    // In case the field is rectangular, make sure to center the eye
-    if (xRes < yRes)
-    {
-      float xLength = (float)xRes / yRes;
-      eyeCenter[0] = xLength * 0.5;
-    }
-    if (yRes < xRes)
-    {
-      float yLength = (float)yRes / xRes;
-      eyeCenter[1] = yLength * 0.5;
-    }
-
-    if (rootInfo.is_open()) // make sure the text file can be opened
-    {
-      rootInfo << "Root information for: "; // save where the root information came from in the text file
-      for (int i = 0; i < argc; i++)
-      {
-        rootInfo << argv[i] << " ";
-      }
-      rootInfo << endl;
-      
-
-      // generate fractal shapes
-      int image_num = 0; // current output image number
-      currentTop = numRootsToExplore; // # of roots in a single image
-      for (int i = 0; i < numCombinations; i++) // go through root combinations
-      {
-        randomRoots.clear(); // clear roots from last iteration
-        generateRoots(numRoots); // generate random roots
-    
-        if (numRoots!= randomRoots.size()) // make sure number of random roots generated is correct
-        {
-          cout << "generateRoots failed" << endl;
-          return 1;
-        }
-
-        for (int j = 0; j < numRoots; j++)
-        {
-          cout << "randomRoot[" << j << "]: " << randomRoots[j] << endl;
-        }
-
-        char buffer[256]; // hold location to put image file
-        sprintf(buffer, "./random/frame.%06i.ppm", image_num);
-
-        topRoots.clear(); // clear from last iteration
-        if (pinned)
-        {
-          topRoots.push_back(VEC3F(0.0, 0.0, 0.0)); // first root is pinned to the origin
-          for (int j = 0; j < (numRootsToExplore - 1); j++)
-          {
-            topRoots.push_back(randomRoots[j]); // root is in a random position
-          }
-        }
-        else
-        {
-          for (int j = 0; j < numRootsToExplore; j++)
-          {
-            topRoots.push_back(randomRoots[j]); // root is in a random position
-          }
-        }
-
-        bool shape = renderImage(xRes, yRes, buffer, image_num, VEC3F(0.0, 0.0, 0.0), centerShape, comInfo); // compute shape, if any
-        rootCombinations += 1; // increment total # of root combinations tried
-
-        if (shape)
-        { // only save root information if shape exists
-          rootInfo << buffer << ": ";
-          for (int j = 0; j < numRootsToExplore; j++)
-          {
-            rootInfo << "topRoots" << j << topRoots[j];
-            if (j != (numRootsToExplore - 1))
-            {
-              rootInfo << ", ";
-            }
-          }
-          rootInfo << "; rootCombinations tried: " << rootCombinations << endl; // write root info to text file and remember the number of root combinations tried
-          image_num++;
-        }
-        else
-        {
-          i -= 1;
-        }
-      }
-      rootInfo << "total rootCombinations tried: " << rootCombinations << endl;
-      auto stop = high_resolution_clock::now(); 
-      auto ms = duration_cast<milliseconds>(stop - start);
-      auto secs = duration_cast<seconds>(ms);
-      ms -= duration_cast<milliseconds>(secs);
-      auto mins = duration_cast<minutes>(secs);
-      secs -= duration_cast<seconds>(mins);
-      auto hour = duration_cast<hours>(mins);
-      mins -= duration_cast<minutes>(hour);
-      rootInfo << "runtime: " << hour.count() << " hours, " << mins.count() << " minutes, " << secs.count() << " seconds, " << ms.count() << " milliseconds" << endl;
-      rootInfo.close(); // close file after done writing
-      comInfo.close(); // close COM text file after done writing
-    }
-    else 
-    {
-      cout << "Unable to open file." << endl;
-      return 1;
-    }
-  }
-  else if (mode == 3)
-  {
-    // grid exploration only works for two root polynomials
-    // create and open a text file to store root information alongside output image file names
-    ofstream rootInfo("pinned/root_info.txt");
-
-    // create and open a text file to store COM information alongside output image file names
-    ofstream comInfo("shapes/COM_info.txt");
-
-    int gridSize_x = 8; // default grid size if not specified by user
-    int gridSize_y = 8; // default grid size if not specified by user
-
-    int rootCombinations = 0; // hold number of root combinations tried
-
-    // format: ./mandelbrot -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
-    if (argc == 6)
-    {
-      // set grid size to be user-specified
-      gridSize_x = atoi(argv[2]); 
-      gridSize_y = atoi(argv[3]);
-
-      if (strcmp(argv[4], "-color") == 0)
-      {
-        colorRed = true; // color roots red
-      }
-      else
-      {
-        colorRed = false; // don't color roots red
-      }
-
-      if (strcmp(argv[5], "-center") == 0)
-      {
-        centerShape = 1; // center the shape
-      }
-      else
-      {
-        centerShape = 0; // don't center the shape
-      }
-    }
-    else // error
-    {
-      cout << "Program usage: ./mandelbrot -pinned (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)" << endl;
-      return 1;
-    }
-
-    // In case the field is rectangular, make sure to center the eye
-    if (xRes < yRes)
-    {
-      float xLength = (float)xRes / yRes;
-      eyeCenter[0] = xLength * 0.5;
-    }
-    if (yRes < xRes)
-    {
-      float yLength = (float)yRes / xRes;
-      eyeCenter[1] = yLength * 0.5;
-    }
-
-    if (rootInfo.is_open()) // make sure the text file can be opened
-    {
-      rootInfo << "Root information for: "; // save where the root information came from in the text file
-      for (int i = 0; i < argc; i++)
-      {
-        rootInfo << argv[i] << " ";
-      }
-      rootInfo << endl;
-      
-      // two root case
-      // iterate root 0 from top to bottom/2, so through y=0
-      int image_num = 0; // current output image number
-      currentTop = 2; // # of roots
-        
-      // root 0 is pinned to (0.0, 0.0); iterate root 1 from left to right
-      for (float root1_x = -2.0; root1_x <= 2.0; root1_x += 4.0/gridSize_x)
-      {
-        for (float root1_y = 2.0; root1_y >= 0; root1_y -= 4.0/gridSize_y)
-        {
-          char buffer[256]; // hold location to put image file
-          sprintf(buffer, "./pinned/frame.%06i.ppm", image_num);
-
-          topRoots.clear(); // clear from last iteration
-          topRoots.push_back(VEC3F(0.0, 0.0, 0.0)); // pin first root to (0.0, 0.0)
-          topRoots.push_back(VEC3F(root1_x, root1_y, 0.0));
-
-          bool shape = renderImage(xRes, yRes, buffer, image_num, VEC3F(0.0, 0.0, 0.0), centerShape, comInfo); // compute shape, if any
-          rootCombinations += 1; // increment total # of root combinations tried
-        
-          if (shape)
-          { // only save root information if shape exists
-            rootInfo << buffer << ": " << "topRoots0" << topRoots[0] << ", topRoots1" << topRoots[1] << endl; // write root info to text file
-            image_num++;
-          }
-        }
-      }
-      rootInfo << "rootCombinations tried: " << rootCombinations << endl;
-      rootInfo.close(); // close file after done writing
-      comInfo.close(); // close COM text file after done writing
-    }
-    else 
-    {
-      cout << "Unable to open file." << endl;
-      return 1;
-    }
-
-  }
-  else // full space regular grid exploration with two roots
-  {
-    // create and open a text file to store root information alongside output image file names
-    ofstream rootInfo("shapes/root_info.txt");
-
-    // create and open a text file to store COM information alongside output image file names
-    ofstream comInfo("shapes/COM_info.txt");
-
-    int gridSize_x = 8; // default grid size if not specified by user
-    int gridSize_y = 8; // default grid size if not specified by user
-
-    int rootCombinations = 0; // hold number of root combinations tried
-
-    // format: ./mandelbrot -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)
-    if (argc == 6)
-    {
-      // set grid size to be user-specified
-      gridSize_x = atoi(argv[2]); 
-      gridSize_y = atoi(argv[3]);
-
-      if (strcmp(argv[4], "-color") == 0)
-      {
-        colorRed = true; // color roots red
-      }
-      else
-      {
-        colorRed = false; // don't color roots red
-      }
-
-      if (strcmp(argv[5], "-center") == 0)
-      {
-        centerShape = 1; // center the shape
-      }
-      else
-      {
-        centerShape = 0; // don't center the shape
-      }
-    }
-    else // error
-    {
-      cout << "Program usage: ./mandelbrot -full (grid size x) (grid size y) (-color or -noColor) (-center or -notCentered)" << endl;
-      return 1;
-    }
-
-    // In case the field is rectangular, make sure to center the eye
-    if (xRes < yRes)
-    {
-      float xLength = (float)xRes / yRes;
-      eyeCenter[0] = xLength * 0.5;
-    }
-    if (yRes < xRes)
-    {
-      float yLength = (float)yRes / xRes;
-      eyeCenter[1] = yLength * 0.5;
-    }
-
-    if (rootInfo.is_open()) // make sure the text file can be opened
-    {
-      rootInfo << "Root information for: "; // save where the root information came from in the text file
-      for (int i = 0; i < argc; i++)
-      {
-        rootInfo << argv[i] << " ";
-      }
-      rootInfo << endl;
-      
-      // two root case
-      // iterate root 0 from top to bottom/2, so through y=0
-      int image_num = 0; // current output image number
-      currentTop = 2; // # of roots
-      for (float root0_y = 2.0; root0_y >= 0; root0_y -= 4.0/gridSize_y)
-      {
-        // iterate root 0 from left to right
-        for (float root0_x = -2.0; root0_x <= 2.0; root0_x += 4.0/gridSize_x)
-        {
-          // iterate root 1 from top to bottom
-          for (float root1_y = root0_y; root1_y >= -2.0; root1_y -= 4.0/gridSize_y)
-          {
-            float root0_x_start = 0;
-            if (root1_y == root0_y)
-            {
-              root0_x_start = root0_x;
-            }
-            else
-            {
-              root0_x_start = -2.0;
-            }
-            // iterate root 1 from left to right
-            for (float root1_x = root0_x_start; root1_x <= 2.0; root1_x += 4.0/gridSize_x)
-            {
-              char buffer[256]; // hold location to put image file
-              sprintf(buffer, "./shapes/frame.%06i.ppm", image_num);
-
-              topRoots.clear(); // clear from last iteration
-              topRoots.push_back(VEC3F(root0_x, root0_y, 0.0));
-              topRoots.push_back(VEC3F(root1_x, root1_y, 0.0));
-
-              bool shape = renderImage(xRes, yRes, buffer, image_num, VEC3F(0.0, 0.0, 0.0), centerShape, comInfo); // compute shape, if any
-              rootCombinations += 1; // increment total # of root combinations tried
-              if (shape)
-              { // only save root information if shape exists
-                rootInfo << buffer << ": " << "topRoots0" << topRoots[0] << ", topRoots1" << topRoots[1] << endl; // write root info to text file
-                image_num++;
-              }
-            }
-          }
-        }
-      }
-      rootInfo << "rootCombinations tried: " << rootCombinations << endl;
-      rootInfo.close(); // close file after done writing
-      comInfo.close(); // close COM text file after done writing
-    }
-    else 
-    {
-      cout << "Unable to open file." << endl;
-      return 1;
-    }
-  }
+  // open the GL window
+  glvuWindow();
 
   return 0;
 }
@@ -1162,73 +716,8 @@ void runEverytime()
 ///////////////////////////////////////////////////////////////////////
 void runOnce()
 {
-  float xLength = 4.0; // get standard X[-2, 2] Y[-2, 2] viewing window
-  float yLength = 4.0;
-
-  int maxIterations = 100;
-  float escapeRadius = 200.0; // to match the js version
-
-  float dx = xLength / xRes;
-  float dy = yLength / yRes;
-  float xHalf = xLength * 0.5;
-  float yHalf = yLength * 0.5;
-
-  cout << " Row: "; flush(cout);
-  for (int y = 0; y < yRes; y++)
-  {
-    cout << y << " "; flush(cout);
-    for (int x = 0; x < xRes; x++)
-    {
-      // getting the center coordinate here is a little sticky
-      VEC3F center;
-      center[0] = -xHalf + x * dx;
-      center[1] = -yHalf + y * dy;
-
-      VEC3F iterate = center; // iterate is q
-      VEC3F p; // hold calculated polynomial
-
-      float magnitude = iterate.magnitude();
-      int totalIterations = 0;
-      while (magnitude < escapeRadius && totalIterations < maxIterations)
-      {
-        VEC3F g = VEC3F(1.0, 0.0, 0.0); // holds current polynomial on top
-        VEC3F diff;
-
-        // compute the top: iterate through top roots
-        for (int x = 0; x < totalTop; x++)
-        {
-          if (x == currentTop) 
-          {
-            break;
-          }
-          // add (q-root) onto g, the polynomial on the top
-          diff = (iterate - topRoots[x]);
-          g = complexMultiply(g, diff);
-        }
-
-        // compute the polynomial
-        p = g;
-        iterate = p;
-
-        magnitude = iterate.magnitude();
-        totalIterations++;
-
-        // exit conditions
-        if (magnitude > escapeRadius)
-          break;
-        if (magnitude < 1e-7)
-          break;
-      }
-
-      // color accordingly
-      if (totalIterations == maxIterations)
-      {
-        field(x, y) = 1.0; // did not escape, color white
-      }
-      else
-      {
-        field(x, y) = 0.0; // escaped, color black
-      }
-    }
-  }
+  // render the standard X[-2, 2] Y[-2, 2] viewing window in the
+  // background; glutIdle picks up the tiles as they finish
+  viewRenderer = new VIEW_RENDERER(&juliaValue, &tileCache, -2.0, -2.0, 4.0);
+  requestView();
 }